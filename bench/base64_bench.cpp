@@ -0,0 +1,91 @@
+/**
+ * @file base64_bench.cpp
+ * @brief Benchmark of the vectorized base64 codec against common/base64.hpp
+ *
+ * Measures raw encode/decode throughput and the full binary resource to SSE
+ * frame path for several payload sizes.
+ */
+
+#include "mcp_base64.h"
+#include "mcp_resource.h"
+#include "base64.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+template<typename F>
+double measure_mbps(std::size_t bytes, F&& f) {
+    // Repeat until at least 256 MB went through (and at least 3 rounds)
+    const std::size_t rounds = std::max<std::size_t>(3, (256u << 20) / std::max<std::size_t>(bytes, 1));
+
+    f(); // warmup
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < rounds; ++i) {
+        f();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return static_cast<double>(bytes) * rounds / elapsed.count() / (1024.0 * 1024.0);
+}
+
+volatile std::size_t sink = 0;
+
+} // namespace
+
+int main() {
+    std::printf("base64 implementation: %s\n\n", mcp::base64_codec::implementation());
+    std::printf("%10s %14s %14s %14s %14s %14s %14s\n", "size",
+        "enc legacy", "enc simd", "dec legacy", "dec simd", "frame legacy", "frame new");
+
+    std::mt19937 rng(42);
+    const std::size_t sizes[] = {1u << 10, 64u << 10, 1u << 20, 8u << 20};
+
+    for (std::size_t size : sizes) {
+        std::vector<uint8_t> data(size);
+        for (auto& b : data) {
+            b = static_cast<uint8_t>(rng());
+        }
+        const std::string encoded = mcp::base64_codec::encode(data.data(), data.size());
+
+        double enc_legacy = measure_mbps(size, [&]() {
+            sink += ::base64::encode(reinterpret_cast<const char*>(data.data()), data.size()).size();
+        });
+        double enc_simd = measure_mbps(size, [&]() {
+            sink += mcp::base64_codec::encode(data.data(), data.size()).size();
+        });
+        double dec_legacy = measure_mbps(size, [&]() {
+            sink += ::base64::decode(encoded).size();
+        });
+        double dec_simd = measure_mbps(size, [&]() {
+            sink += mcp::base64_codec::decode(encoded).size();
+        });
+
+        // Previous resource path: encode to a temporary, copy into JSON, dump, copy into the frame
+        double frame_legacy = measure_mbps(size, [&]() {
+            std::string blob = ::base64::encode(reinterpret_cast<const char*>(data.data()), data.size());
+            mcp::json content = {{"uri", "bench://blob"}, {"mimeType", "application/octet-stream"}, {"blob", blob}};
+            std::string frame = "event: message\r\ndata: " + content.dump() + "\r\n\r\n";
+            sink += frame.size();
+        });
+
+        mcp::binary_resource resource("bench://blob", "blob", "application/octet-stream");
+        resource.set_data(data.data(), data.size());
+        double frame_new = measure_mbps(size, [&]() {
+            std::string frame = "event: message\r\ndata: ";
+            resource.write_content(frame);
+            frame += "\r\n\r\n";
+            sink += frame.size();
+        });
+
+        std::printf("%9zuK %11.1fMB/s %11.1fMB/s %11.1fMB/s %11.1fMB/s %11.1fMB/s %11.1fMB/s\n", size >> 10,
+            enc_legacy, enc_simd, dec_legacy, dec_simd, frame_legacy, frame_new);
+    }
+
+    return 0;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file resource_manager_bench.cpp
+ * @brief Contention benchmark of resource_manager lookups
+ *
+ * Many reader threads look up random resources while one writer thread keeps
+ * registering and unregistering resources. The sharded registry is compared
+ * with a single shard and with the previous std::map guarded by one mutex.
+ */
+
+#include "mcp_resource.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int resource_count = 1000;
+constexpr auto run_time = std::chrono::milliseconds(500);
+
+// The registry as it was before sharding: one map behind one global mutex
+class legacy_registry {
+public:
+    void register_resource(std::shared_ptr<mcp::resource> res) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        resources_[res->get_uri()] = std::move(res);
+    }
+
+    bool unregister_resource(const std::string& uri) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return resources_.erase(uri) > 0;
+    }
+
+    std::shared_ptr<mcp::resource> get_resource(const std::string& uri) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = resources_.find(uri);
+        return it == resources_.end() ? nullptr : it->second;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<mcp::resource>> resources_;
+};
+
+std::string make_uri(int i) {
+    return "bench://resource/" + std::to_string(i);
+}
+
+// Returns the total number of lookups per second over all reader threads
+template<typename Registry>
+double run(Registry& registry, int reader_count) {
+    for (int i = 0; i < resource_count; ++i) {
+        registry.register_resource(std::make_shared<mcp::text_resource>(make_uri(i), "r", "text/plain"));
+    }
+
+    std::vector<std::string> uris;
+    for (int i = 0; i < resource_count; ++i) {
+        uris.push_back(make_uri(i));
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<long> lookups{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < reader_count; ++t) {
+        threads.emplace_back([&, t]() {
+            std::mt19937 rng(t);
+            long count = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (registry.get_resource(uris[rng() % resource_count])) {
+                    ++count;
+                }
+            }
+            lookups += count;
+        });
+    }
+
+    // Writer churning a separate set of URIs
+    threads.emplace_back([&]() {
+        int i = resource_count;
+        while (!stop.load(std::memory_order_relaxed)) {
+            std::string uri = make_uri(i++ % (2 * resource_count) + resource_count);
+            registry.register_resource(std::make_shared<mcp::text_resource>(uri, "w", "text/plain"));
+            registry.unregister_resource(uri);
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(run_time);
+    stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return lookups.load() / elapsed.count();
+}
+
+} // namespace
+
+int main() {
+    std::printf("hardware threads: %u\n\n", std::thread::hardware_concurrency());
+    std::printf("%8s %18s %18s %18s\n", "readers", "legacy mutex", "1 shard", "16 shards");
+
+    for (int readers : {1, 2, 4, 8, 16, 32}) {
+        legacy_registry legacy;
+        mcp::resource_manager single(1);
+        mcp::resource_manager sharded(16);
+
+        double legacy_rate = run(legacy, readers);
+        double single_rate = run(single, readers);
+        double sharded_rate = run(sharded, readers);
+
+        std::printf("%8d %13.2f M/s %13.2f M/s %13.2f M/s\n", readers,
+            legacy_rate / 1e6, single_rate / 1e6, sharded_rate / 1e6);
+    }
+
+    return 0;
+}
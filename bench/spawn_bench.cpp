@@ -0,0 +1,121 @@
+/**
+ * @file spawn_bench.cpp
+ * @brief Process spawn latency against the size of the parent process
+ *
+ * Starts /bin/true repeatedly with fork() + execvp() (the previous stdio_client
+ * launch path) and with posix_spawnp() (the current one) while the parent holds
+ * a growing amount of touched heap memory. fork() copies the page tables of the
+ * parent, so its cost grows with the resident size; posix_spawnp() does not.
+ *
+ * Usage: spawn_bench [heap size in MB]...
+ */
+
+#if defined(_WIN32)
+
+#include <cstdio>
+
+int main() {
+    std::printf("spawn_bench is only available on POSIX platforms\n");
+    return 0;
+}
+
+#else
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace {
+
+constexpr int iterations = 50;
+
+char program[] = "/bin/true";
+char* const arguments[] = {program, nullptr};
+
+using clock_type = std::chrono::steady_clock;
+
+struct result {
+    double spawn_us = 0; // Until the spawn call returned in the parent
+    double total_us = 0; // Until the child exited
+};
+
+pid_t spawn_fork() {
+    pid_t pid = fork();
+    if (pid == 0) {
+        execvp(program, arguments);
+        _exit(127);
+    }
+    return pid;
+}
+
+pid_t spawn_posix() {
+    pid_t pid = -1;
+    if (posix_spawnp(&pid, program, nullptr, nullptr, arguments, environ) != 0) {
+        return -1;
+    }
+    return pid;
+}
+
+result measure(pid_t (*spawn)()) {
+    result r;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = clock_type::now();
+        pid_t pid = spawn();
+        auto spawned = clock_type::now();
+        if (pid == -1) {
+            std::perror("spawn");
+            std::exit(1);
+        }
+        int status;
+        waitpid(pid, &status, 0);
+        auto exited = clock_type::now();
+
+        r.spawn_us += std::chrono::duration<double, std::micro>(spawned - start).count();
+        r.total_us += std::chrono::duration<double, std::micro>(exited - start).count();
+    }
+    r.spawn_us /= iterations;
+    r.total_us /= iterations;
+    return r;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes_mb;
+    for (int i = 1; i < argc; ++i) {
+        sizes_mb.push_back(std::strtoul(argv[i], nullptr, 10));
+    }
+    if (sizes_mb.empty()) {
+        sizes_mb = {0, 256, 1024, 2048};
+    }
+
+    std::printf("%10s %18s %18s %18s %18s\n", "heap MB", "fork spawn us", "fork total us", "posix spawn us", "posix total us");
+
+    for (size_t size_mb : sizes_mb) {
+        // Touch every page so that it is resident and mapped in the page tables
+        size_t size = size_mb << 20;
+        std::unique_ptr<char[]> heap(size ? new char[size] : nullptr);
+        if (size) {
+            std::memset(heap.get(), 1, size);
+        }
+
+        result forked = measure(spawn_fork);
+        result spawned = measure(spawn_posix);
+
+        std::printf("%10zu %18.1f %18.1f %18.1f %18.1f\n", size_mb,
+                    forked.spawn_us, forked.total_us, spawned.spawn_us, spawned.total_us);
+    }
+
+    return 0;
+}
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * @file unix_socket_bench.cpp
+ * @brief Small tool call latency over a Unix domain socket against HTTP + SSE
+ *
+ * Serves one server over HTTP/SSE on localhost and over a Unix domain socket,
+ * then calls a tool with a small argument from sse_client and unix_client, one
+ * call at a time. Every SSE call pays an HTTP POST with its headers and a
+ * response delivered as an SSE event; over the socket a call is one line each
+ * way.
+ *
+ * Usage: unix_socket_bench [calls]
+ */
+
+#if defined(_WIN32)
+
+#include <cstdio>
+
+int main() {
+    std::printf("unix_socket_bench is only available on POSIX platforms\n");
+    return 0;
+}
+
+#else
+
+#include "mcp_server.h"
+#include "mcp_sse_client.h"
+#include "mcp_unix_client.h"
+#include "mcp_unix_server.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr int http_port = 18765;
+
+// Average microseconds per call
+double measure(mcp::client& client, int calls) {
+    const mcp::json args = {{"text", "hello"}};
+
+    auto start = clock_type::now();
+    for (int i = 0; i < calls; ++i) {
+        client.call_tool("echo", args);
+    }
+    auto elapsed = clock_type::now() - start;
+
+    return std::chrono::duration<double, std::micro>(elapsed).count() / calls;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int calls = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+    mcp::set_log_level(mcp::log_level::error);
+
+    mcp::server::configuration conf;
+    conf.port = http_port;
+    conf.threadpool_size = 4;
+    auto srv = std::make_shared<mcp::server>(conf);
+    srv->set_capabilities({{"tools", mcp::json::object()}});
+    srv->register_tool(mcp::tool_builder("echo").with_string_param("text", "Text").build(),
+        [](const mcp::json& args, const std::string&) -> mcp::json {
+            return mcp::json::array({{{"type", "text"}, {"text", args["text"]}}});
+        });
+    srv->start(false);
+
+    std::string path = "/tmp/mcp_unix_socket_bench." + std::to_string(getpid()) + ".sock";
+    mcp::unix_server socket_server(srv, {path});
+    if (!socket_server.start(false)) {
+        std::fprintf(stderr, "Failed to listen on %s\n", path.c_str());
+        return 1;
+    }
+
+    mcp::sse_client sse("http://localhost:" + std::to_string(http_port));
+    mcp::unix_client unix_socket(path);
+    if (!sse.initialize("bench", "1.0.0") || !unix_socket.initialize("bench", "1.0.0")) {
+        std::fprintf(stderr, "Failed to initialize clients\n");
+        return 1;
+    }
+
+    // Warm up both paths
+    measure(sse, 200);
+    measure(unix_socket, 200);
+
+    double sse_us = measure(sse, calls);
+    double unix_us = measure(unix_socket, calls);
+
+    std::printf("%-12s %14s %14s\n", "transport", "us per call", "calls per s");
+    std::printf("%-12s %14.1f %14.0f\n", "http+sse", sse_us, 1e6 / sse_us);
+    std::printf("%-12s %14.1f %14.0f\n", "unix socket", unix_us, 1e6 / unix_us);
+
+    socket_server.stop();
+    srv->stop();
+    return 0;
+}
+
+#endif
@@ -17,6 +17,7 @@
 #include <mutex>
 #include <queue>
 #include <memory>
+#include <future>
 #include <random>
 #include <sstream>
 #include <chrono>
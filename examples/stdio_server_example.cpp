@@ -0,0 +1,69 @@
+/**
+ * @file stdio_server_example.cpp
+ * @brief Example of an MCP server served over standard input/output
+ *
+ * This example demonstrates how to serve an MCP server over stdio, so that a
+ * client can start it as a subprocess instead of connecting to a port.
+ *
+ * Usage:
+ *   ./stdio_client_example ./stdio_server_example
+ */
+
+#include "mcp_server.h"
+#include "mcp_stdio_server.h"
+#include "mcp_tool.h"
+#include "mcp_logger.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace mcp;
+
+int main() {
+    // Logs go to stderr, stdout carries the protocol
+    set_log_level(log_level::warning);
+
+    server::configuration server_config;
+    server_config.name = "Stdio MCP Server";
+    server_config.version = "1.0.0";
+
+    auto mcp_server = std::make_shared<server>(server_config);
+    mcp_server->set_capabilities({
+        {"tools", json::object()}
+    });
+
+    tool echo_tool = tool_builder("echo")
+        .with_description("Echo the input text")
+        .with_string_param("text", "Text to echo")
+        .build();
+
+    mcp_server->register_tool(echo_tool, [](const json& args, const std::string& /* session_id */) -> json {
+        return json::array({
+            {
+                {"type", "text"},
+                {"text", args.value("text", "")}
+            }
+        });
+    });
+
+    tool sleep_tool = tool_builder("sleep")
+        .with_description("Wait before answering, other requests are served meanwhile")
+        .with_number_param("ms", "Milliseconds to wait")
+        .build();
+
+    mcp_server->register_tool(sleep_tool, [](const json& args, const std::string& /* session_id */) -> json {
+        int ms = args.value("ms", 100);
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        return json::array({
+            {
+                {"type", "text"},
+                {"text", "Slept " + std::to_string(ms) + " ms"}
+            }
+        });
+    });
+
+    // Serve until the client closes stdin
+    stdio_server transport(mcp_server);
+    return transport.start(true) ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file mcp_base64.h
+ * @brief Vectorized base64 codec for MCP
+ *
+ * This file defines a base64 encoder/decoder that uses SSSE3 or AVX2 when the
+ * CPU supports them and falls back to a table-driven scalar implementation otherwise.
+ * The encoder can write straight into an existing output buffer in chunks, so that
+ * large binary payloads do not need an intermediate string.
+ */
+
+#ifndef MCP_BASE64_H
+#define MCP_BASE64_H
+
+#include "mcp_message.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mcp {
+
+/**
+ * @class base64_codec
+ * @brief Standard alphabet (RFC 4648) base64 encoder and decoder
+ *
+ * The implementation is selected once at runtime based on the CPU features.
+ */
+class base64_codec {
+public:
+    /**
+     * @brief Get the encoded size for a given input size (including padding)
+     * @param size The size of the binary input
+     * @return The size of the base64 output
+     */
+    static std::size_t encoded_size(std::size_t size) noexcept {
+        return (size + 2) / 3 * 4;
+    }
+
+    /**
+     * @brief Get the maximum decoded size for a given input size
+     * @param size The size of the base64 input
+     * @return Upper bound of the binary output size
+     */
+    static std::size_t max_decoded_size(std::size_t size) noexcept {
+        return (size + 3) / 4 * 3;
+    }
+
+    /**
+     * @brief Encode binary data
+     * @param data Pointer to the binary data
+     * @param size Size of the binary data
+     * @param out Destination, must hold at least encoded_size(size) characters
+     * @return Number of characters written
+     */
+    static std::size_t encode(const uint8_t* data, std::size_t size, char* out);
+
+    /**
+     * @brief Encode binary data and append it to a string
+     * @param data Pointer to the binary data
+     * @param size Size of the binary data
+     * @param out The string to append to
+     */
+    static void encode_append(const uint8_t* data, std::size_t size, std::string& out);
+
+    /**
+     * @brief Encode binary data into a new string
+     * @param data Pointer to the binary data
+     * @param size Size of the binary data
+     * @return The base64 string
+     */
+    static std::string encode(const uint8_t* data, std::size_t size);
+
+    /**
+     * @brief Decode base64 data
+     * @param data Pointer to the base64 characters
+     * @param size Number of base64 characters
+     * @param out Destination, must hold at least max_decoded_size(size) bytes
+     * @return Number of bytes written
+     * @throws mcp_exception if the input is not valid base64
+     */
+    static std::size_t decode(const char* data, std::size_t size, uint8_t* out);
+
+    /**
+     * @brief Decode a base64 string
+     * @param str The base64 string
+     * @return The decoded bytes
+     * @throws mcp_exception if the input is not valid base64
+     */
+    static std::vector<uint8_t> decode(const std::string& str);
+
+    /**
+     * @brief Get the name of the selected implementation
+     * @return "avx2", "ssse3" or "scalar"
+     */
+    static const char* implementation();
+};
+
+} // namespace mcp
+
+#endif // MCP_BASE64_H
@@ -0,0 +1,165 @@
+/**
+ * @file mcp_cancellation.h
+ * @brief Cancellation of requests being processed
+ *
+ * This file defines the token a server associates with each request it
+ * receives. The token is cancelled when the client sends
+ * notifications/cancelled for the request, the session closes or the
+ * request's deadline passes, and long-running handlers can poll it to stop
+ * early.
+ */
+
+#ifndef MCP_CANCELLATION_H
+#define MCP_CANCELLATION_H
+
+#include "mcp_message.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+
+namespace mcp {
+
+/**
+ * @class cancellation_token
+ * @brief Shared flag telling whether a request was cancelled
+ *
+ * Copies share the flag. A token may carry a deadline, after which it counts
+ * as cancelled. While the server runs a handler, the token of the request is
+ * available to it on the same thread through current().
+ */
+class cancellation_token {
+public:
+    /**
+     * @brief Constructor, creates a token that is not cancelled
+     */
+    cancellation_token()
+        : state_(std::make_shared<state>()) {
+    }
+
+    /**
+     * @brief Constructor, creates a token that is cancelled once the deadline passes
+     * @param deadline The deadline
+     */
+    explicit cancellation_token(std::chrono::steady_clock::time_point deadline)
+        : state_(std::make_shared<state>()) {
+        state_->deadline = deadline;
+    }
+
+    /**
+     * @brief Cancel the request (all copies see it)
+     */
+    void cancel() {
+        state_->cancelled.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Check whether the request was cancelled or its deadline passed
+     * @return True if cancelled
+     */
+    bool is_cancelled() const {
+        return state_->cancelled.load(std::memory_order_acquire) || is_expired();
+    }
+
+    /**
+     * @brief Check whether cancel() was called, whatever the deadline
+     * @return True if cancelled
+     */
+    bool is_cancel_requested() const {
+        return state_->cancelled.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Check whether the deadline passed
+     * @return True if the token has a deadline and it passed
+     */
+    bool is_expired() const {
+        return state_->deadline && std::chrono::steady_clock::now() >= *state_->deadline;
+    }
+
+    /**
+     * @brief Get the deadline
+     * @return The deadline, nullopt if there is none
+     */
+    std::optional<std::chrono::steady_clock::time_point> deadline() const {
+        return state_->deadline;
+    }
+
+    /**
+     * @brief Get the time left until the deadline
+     * @return The remaining time (zero once passed), nullopt if there is no deadline
+     */
+    std::optional<std::chrono::milliseconds> remaining() const {
+        if (!state_->deadline) {
+            return std::nullopt;
+        }
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(*state_->deadline - std::chrono::steady_clock::now());
+        return std::max(left, std::chrono::milliseconds(0));
+    }
+
+    /**
+     * @brief Stop a handler of a cancelled request
+     * @throws mcp_exception if the request was cancelled
+     */
+    void throw_if_cancelled() const {
+        if (state_->cancelled.load(std::memory_order_acquire)) {
+            throw mcp_exception(error_code::internal_error, "Request cancelled");
+        }
+        if (is_expired()) {
+            throw mcp_exception(error_code::request_timeout, "Request deadline exceeded");
+        }
+    }
+
+    /**
+     * @brief Get the token of the request processed on this thread
+     * @return The token (one that is never cancelled outside a request)
+     */
+    static const cancellation_token& current() {
+        static const cancellation_token none;
+        const cancellation_token* token = current_slot();
+        return token ? *token : none;
+    }
+
+    /**
+     * @class scope
+     * @brief Makes a token the current one of this thread for its lifetime
+     */
+    class scope {
+    public:
+        explicit scope(const cancellation_token& token)
+            : previous_(current_slot()) {
+            current_slot() = &token;
+        }
+
+        ~scope() {
+            current_slot() = previous_;
+        }
+
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+
+    private:
+        const cancellation_token* previous_;
+    };
+
+private:
+    // Token of the request processed on this thread
+    static const cancellation_token*& current_slot() {
+        thread_local const cancellation_token* token = nullptr;
+        return token;
+    }
+
+    struct state {
+        std::atomic<bool> cancelled{false};
+        std::optional<std::chrono::steady_clock::time_point> deadline;
+    };
+
+    // State shared by the copies
+    std::shared_ptr<state> state_;
+};
+
+} // namespace mcp
+
+#endif // MCP_CANCELLATION_H
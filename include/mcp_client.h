@@ -10,15 +10,36 @@
 #define MCP_CLIENT_H
 
 #include "mcp_message.h"
+#include "mcp_dispatcher.h"
 #include "mcp_tool.h"
+#include "mcp_tool_cache.h"
 #include "mcp_logger.h"
 
 #include <string>
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include <optional>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
 
 namespace mcp {
 
+/**
+ * @struct tool_call_listener
+ * @brief Receives what a streaming tool reports before its result
+ */
+struct tool_call_listener {
+    /** Called with the params of each notifications/progress of the call (progress, total, message) */
+    std::function<void(const json&)> on_progress;
+
+    /** Called with the content items of each partial result of the call */
+    std::function<void(const json&)> on_content;
+};
+
 /**
  * @class client
  * @brief Abstract interface for MCP clients
@@ -62,6 +83,25 @@ public:
      */
     virtual response send_request(const std::string& method, const json& params = json::object()) = 0;
     
+    /**
+     * @brief Send a request built by the caller and wait for a response
+     * @param req The request (e.g. from request::create()); its ID lets another thread cancel it with cancel_request()
+     * @return The response
+     * @throws mcp_exception on error, if another request with the same ID is waiting, or if the request was cancelled
+     */
+    virtual response send_prepared_request(const request& req);
+    
+    /**
+     * @brief Cancel a request that is waiting for its response
+     * @param id The ID of the request
+     * @param reason Optional reason passed to the server
+     * @return False if no request with this ID is waiting
+     *
+     * The waiting call throws an mcp_exception, and the server is sent
+     * notifications/cancelled so that it stops working on the request.
+     */
+    virtual bool cancel_request(const json& id, const std::string& reason = "");
+    
     /**
      * @brief Send a notification (no response expected)
      * @param method The method to call
@@ -112,6 +152,17 @@ public:
      * @return The resource content
      */
     virtual json read_resource(const std::string& resource_uri) = 0;
+    
+    /**
+     * @brief Read part of a resource
+     * @param resource_uri The URI of the resource
+     * @param offset Start of the range in bytes (negative: relative to the end)
+     * @param length Number of bytes to read (nullopt: up to the end)
+     * @return The resource content, with a "range" field describing the returned slice
+     *
+     * The default implementation sends resources/read through send_request().
+     */
+    virtual json read_resource_range(const std::string& resource_uri, int64_t offset, std::optional<uint64_t> length = std::nullopt);
 
     /**
      * @brief Subscribe to resource changes
@@ -126,11 +177,106 @@ public:
      */
     virtual json list_resource_templates() = 0;
 
+    /**
+     * @brief Register a handler for requests sent by the server (e.g. "sampling/createMessage")
+     * @param method The method name
+     * @param handler The handler, run on the client's executor (nullptr removes it)
+     * @throws mcp_exception if the client does not receive server-initiated messages (the default)
+     */
+    virtual void register_request_handler(const std::string& method, client_request_handler handler);
+
+    /**
+     * @brief Register a handler for notifications sent by the server (e.g. "notifications/progress")
+     * @param method The method name
+     * @param handler The handler, run on the client's executor (nullptr removes it)
+     * @throws mcp_exception if the client does not receive server-initiated messages (the default)
+     */
+    virtual void register_notification_handler(const std::string& method, client_notification_handler handler);
+
     /**
      * @brief Check if the client is running
      * @return True if the client is running
      */
     virtual bool is_running() const = 0;
+
+    /**
+     * @brief Answer calls of cacheable tools from a result cache
+     * @param cache The cache (nullptr disables caching)
+     * @param scope Identifies the server; clients of the same server may share entries by passing the same scope
+     *
+     * Tools are cacheable if the cache has a policy for them or if get_tools()
+     * reported them as read-only or idempotent.
+     */
+    void set_tool_cache(std::shared_ptr<tool_result_cache> cache, const std::string& scope) {
+        tool_cache_ = std::move(cache);
+        tool_cache_scope_ = scope;
+    }
+
+    /**
+     * @brief Call a tool, receiving its progress and partial content while it runs
+     * @param tool_name The name of the tool to call
+     * @param arguments The arguments to pass to the tool
+     * @param listener The callbacks, run on the client's executor in the order the server sent them, all before the call returns
+     * @return The result of the tool call (content passed to on_content is not repeated in it)
+     * @note Calling this from a handler on a single-threaded executor deadlocks, the listener would wait behind the caller
+     * @throws mcp_exception on error
+     */
+    json call_tool_streaming(const std::string& tool_name, const json& arguments, const tool_call_listener& listener);
+
+    /**
+     * @brief Call a tool with a deadline
+     * @param tool_name The name of the tool to call
+     * @param arguments The arguments to pass to the tool
+     * @param timeout Time the call may take, sent in "_meta"; the server skips or stops the call once it has passed
+     * @return The result of the tool call
+     * @throws mcp_exception on error, or if no response arrived in time
+     */
+    json call_tool_with_timeout(const std::string& tool_name, const json& arguments, std::chrono::milliseconds timeout);
+
+protected:
+    // Run a tool call through the result cache, if one is set
+    json cached_tool_call(const std::string& tool_name, const json& arguments, const std::function<json()>& call) {
+        if (!tool_cache_) {
+            return call();
+        }
+        return tool_cache_->call(tool_cache_scope_, tool_name, arguments, call);
+    }
+
+    // Pass the tools listed by the server to the result cache, if one is set
+    void remember_tools(const std::vector<tool>& tools) {
+        if (tool_cache_) {
+            tool_cache_->set_tools(tool_cache_scope_, tools);
+        }
+    }
+
+    // Queue a progress or partial content notification for the listener of its call on the dispatcher,
+    // false if it belongs to none
+    bool deliver_tool_stream(const json& message, message_dispatcher& dispatcher);
+
+    // Tool result cache (optional)
+    std::shared_ptr<tool_result_cache> tool_cache_;
+
+    // Scope of this client's entries in the cache
+    std::string tool_cache_scope_;
+
+    // A streaming call in progress
+    struct tool_stream {
+        // The caller's callbacks
+        tool_call_listener listener;
+
+        // Listener calls queued on the dispatcher that have not run yet
+        size_t queued = 0;
+    };
+
+    // Streaming calls in progress (progress token -> call)
+    std::map<int64_t, std::shared_ptr<tool_stream>> tool_streams_;
+
+    // Progress token of the next streaming call
+    int64_t next_tool_stream_ = 1;
+
+    // Mutex for the streaming calls, and notified when a call's queued listener calls have all run
+    std::mutex tool_streams_mutex_;
+    std::condition_variable tool_streams_cv_;
 };
 
 } // namespace mcp
@@ -0,0 +1,139 @@
+/**
+ * @file mcp_dispatcher.h
+ * @brief Dispatching of server-initiated messages on the client side
+ *
+ * This file defines the dispatcher that clients use to handle requests and
+ * notifications sent by the server (progress, resource updates, sampling, ...).
+ * Handlers run on an executor, so the transport reader is never blocked.
+ */
+
+#ifndef MCP_DISPATCHER_H
+#define MCP_DISPATCHER_H
+
+#include "mcp_message.h"
+#include "mcp_thread_pool.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace mcp {
+
+/**
+ * @brief Handler for a request sent by the server
+ *
+ * Receives the request parameters and returns the result. Throwing an
+ * mcp_exception sends an error response with its code.
+ */
+using client_request_handler = std::function<json(const json& params)>;
+
+/**
+ * @brief Handler for a notification sent by the server
+ */
+using client_notification_handler = std::function<void(const json& params)>;
+
+/**
+ * @class message_dispatcher
+ * @brief Routes incoming requests and notifications to registered handlers
+ *
+ * Requests run as independent tasks on the executor and are answered through
+ * the reply function given to dispatch(); requests without a handler are
+ * answered with method_not_found. Notifications of one dispatcher run one at a
+ * time in the order they were received, even on a multi-threaded executor.
+ * "ping" is answered by default.
+ */
+class message_dispatcher {
+public:
+    /**
+     * @brief Function sending a response message back to the server
+     */
+    using reply_function = std::function<void(const json& response)>;
+
+    /**
+     * @brief Constructor
+     * @param executor Executor for the handlers (nullptr: a single thread created on first use)
+     */
+    explicit message_dispatcher(std::shared_ptr<thread_pool> executor = nullptr);
+
+    /**
+     * @brief Destructor, drops queued notifications and waits for running handlers
+     */
+    ~message_dispatcher();
+
+    message_dispatcher(const message_dispatcher&) = delete;
+    message_dispatcher& operator=(const message_dispatcher&) = delete;
+
+    /**
+     * @brief Set the executor for handlers dispatched from now on
+     * @param executor The executor (may be shared between clients)
+     */
+    void set_executor(std::shared_ptr<thread_pool> executor);
+
+    /**
+     * @brief Register a request handler
+     * @param method The method name
+     * @param handler The handler (nullptr removes the handler)
+     */
+    void register_request_handler(const std::string& method, client_request_handler handler);
+
+    /**
+     * @brief Register a notification handler
+     * @param method The method name
+     * @param handler The handler (nullptr removes the handler)
+     */
+    void register_notification_handler(const std::string& method, client_notification_handler handler);
+
+    /**
+     * @brief Dispatch a message received from the server
+     * @param message The message; taken over if it is a request or notification
+     * @param reply Function sending the response to a request
+     * @return True if the message was a request or notification, false if it is a response
+     */
+    bool dispatch(json& message, reply_function reply);
+
+    /**
+     * @brief Run a handler in order with the notifications dispatched before and after it
+     * @param handler The handler
+     * @param params The parameters passed to the handler
+     * @return False if the handler was not scheduled
+     */
+    bool post_notification(client_notification_handler handler, json params);
+
+private:
+    // Run a task on the executor, accounting for it in in_flight_, returns false if it was not scheduled
+    bool post(std::function<void()> task);
+
+    // Handle a request and send the response
+    void handle_request(const json& id, const std::string& method, const json& params, const reply_function& reply);
+
+    // Run queued notifications in order until the queue is empty
+    void drain_notifications();
+
+    // Guards the fields below
+    std::mutex mutex_;
+    std::condition_variable idle_cv_;
+
+    // Handlers by method name
+    std::map<std::string, client_request_handler> request_handlers_;
+    std::map<std::string, client_notification_handler> notification_handlers_;
+
+    // Executor running the handlers
+    std::shared_ptr<thread_pool> executor_;
+
+    // Notifications waiting to run, and whether a task is draining them
+    std::deque<std::pair<client_notification_handler, json>> notifications_;
+    bool draining_ = false;
+
+    // Tasks posted to the executor that have not finished yet
+    size_t in_flight_ = 0;
+    bool stopping_ = false;
+};
+
+} // namespace mcp
+
+#endif // MCP_DISPATCHER_H
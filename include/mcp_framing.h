@@ -0,0 +1,407 @@
+/**
+ * @file mcp_framing.h
+ * @brief Newline-delimited message framing
+ *
+ * This file defines the receive buffer used to split a byte stream into
+ * newline-delimited JSON-RPC messages without copying or rescanning data, and
+ * the incremental parser for Server-Sent Events streams.
+ */
+
+#ifndef MCP_FRAMING_H
+#define MCP_FRAMING_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace mcp {
+
+/**
+ * @class line_buffer
+ * @brief Growable receive buffer that yields complete lines in place
+ *
+ * Data is read directly into the buffer (prepare() / commit()). Lines are
+ * returned as views into the buffer, and the scan for the next newline resumes
+ * where the previous one stopped, so a large message arriving in many reads is
+ * scanned once. Consumed data is discarded by moving the read position; the
+ * remainder is only moved to the front when space is needed. The suggested read
+ * size doubles while reads fill it completely.
+ */
+class line_buffer {
+public:
+    /**
+     * @brief Constructor
+     * @param min_read_size Initial (and minimum) read size
+     * @param max_read_size Maximum read size
+     */
+    explicit line_buffer(size_t min_read_size = 16 * 1024, size_t max_read_size = 1024 * 1024)
+        : min_read_size_(min_read_size), max_read_size_(std::max(min_read_size, max_read_size)), read_size_(min_read_size) {
+    }
+
+    /**
+     * @brief Get space to read into
+     * @return Pointer to the free space and its size (the current read size)
+     */
+    std::pair<char*, size_t> prepare() {
+        if (data_.size() - end_ < read_size_) {
+            // Reclaim consumed space first, grow only if that is not enough
+            if (begin_ > 0) {
+                std::memmove(data_.data(), data_.data() + begin_, end_ - begin_);
+                end_ -= begin_;
+                scan_ -= begin_;
+                begin_ = 0;
+            }
+            if (data_.size() - end_ < read_size_) {
+                data_.resize(std::max(end_ + read_size_, data_.size() * 2));
+            }
+        }
+        return {data_.data() + end_, read_size_};
+    }
+
+    /**
+     * @brief Mark bytes written to the space returned by prepare() as received
+     * @param size Number of bytes received
+     */
+    void commit(size_t size) {
+        end_ += size;
+        if (size == read_size_) {
+            read_size_ = std::min(read_size_ * 2, max_read_size_);
+        }
+    }
+
+    /**
+     * @brief Append received bytes
+     * @param data Pointer to the data
+     * @param size Size of the data
+     */
+    void append(const char* data, size_t size) {
+        while (size > 0) {
+            auto [space, capacity] = prepare();
+            size_t chunk = std::min(size, capacity);
+            std::memcpy(space, data, chunk);
+            end_ += chunk;
+            data += chunk;
+            size -= chunk;
+        }
+    }
+
+    /**
+     * @brief Get the next complete line
+     * @param line Receives the line without the terminating newline (and carriage return)
+     * @return True if a complete line was available
+     * @note The view is invalidated by the next call to prepare() or append()
+     */
+    bool next_line(std::string_view& line) {
+        const char* base = data_.data();
+        const void* newline = scan_ < end_ ? std::memchr(base + scan_, '\n', end_ - scan_) : nullptr;
+        if (newline == nullptr) {
+            scan_ = end_;
+            release();
+            return false;
+        }
+
+        size_t pos = static_cast<const char*>(newline) - base;
+        size_t length = pos - begin_;
+        if (length > 0 && base[pos - 1] == '\r') {
+            --length;
+        }
+        line = std::string_view(base + begin_, length);
+
+        begin_ = scan_ = pos + 1;
+        return true;
+    }
+
+    /**
+     * @brief Get the number of buffered bytes that are not part of a returned line
+     * @return The number of bytes
+     */
+    size_t size() const {
+        return end_ - begin_;
+    }
+
+    /**
+     * @brief Get the current read size
+     * @return The read size
+     */
+    size_t read_size() const {
+        return read_size_;
+    }
+
+    /**
+     * @brief Discard all buffered data
+     */
+    void clear() {
+        begin_ = end_ = scan_ = 0;
+        release();
+    }
+
+private:
+    // Reset positions when everything was consumed and drop oversized storage
+    void release() {
+        if (begin_ != end_) {
+            return;
+        }
+        begin_ = end_ = scan_ = 0;
+        if (data_.size() > 2 * max_read_size_) {
+            std::vector<char>().swap(data_);
+        }
+        read_size_ = min_read_size_;
+    }
+
+    std::vector<char> data_;
+
+    // Start of unconsumed data, end of received data, position where the newline scan resumes
+    size_t begin_ = 0;
+    size_t end_ = 0;
+    size_t scan_ = 0;
+
+    size_t min_read_size_;
+    size_t max_read_size_;
+    size_t read_size_;
+};
+
+/**
+ * @struct sse_event
+ * @brief A Server-Sent Event, valid for the duration of the handler call
+ */
+struct sse_event {
+    /** Event type ("message" when the event has no event field) */
+    std::string_view type;
+
+    /** Data lines joined with newlines */
+    std::string_view data;
+
+    /** ID of the event, or of the last event before it that had one */
+    std::string_view id;
+};
+
+/**
+ * @class sse_parser
+ * @brief Incremental Server-Sent Events parser
+ *
+ * Chunks are scanned once as they arrive; lines may end with CR, LF or CRLF,
+ * also when the terminator is split between chunks. Lines that are complete
+ * within a chunk are processed in place; only a line spanning chunks and the
+ * data of the current event are buffered, and these buffers are reused for
+ * the following events.
+ */
+class sse_parser {
+public:
+    /**
+     * @brief Event handler
+     * @return False to stop parsing
+     */
+    using event_handler = std::function<bool(const sse_event& event)>;
+
+    /**
+     * @brief Constructor
+     * @param handler Handler called for every complete event with data
+     */
+    explicit sse_parser(event_handler handler)
+        : handler_(std::move(handler)) {
+    }
+
+    /**
+     * @brief Parse a chunk of the stream
+     * @param data Pointer to the data
+     * @param size Size of the data
+     * @return False if the handler stopped parsing
+     */
+    bool feed(const char* data, size_t size) {
+        std::string_view input(data, size);
+        size_t pos = 0;
+
+        // A CR ending the previous chunk may be the first half of a CRLF
+        if (skip_lf_ && pos < input.size()) {
+            skip_lf_ = false;
+            if (input[pos] == '\n') {
+                ++pos;
+            }
+        }
+
+        while (pos < input.size()) {
+            size_t end = find_line_end(input, pos);
+            if (end == std::string_view::npos) {
+                line_.append(input.data() + pos, input.size() - pos);
+                break;
+            }
+
+            std::string_view line = input.substr(pos, end - pos);
+            if (!line_.empty()) {
+                line_.append(line.data(), line.size());
+                line = line_;
+            }
+
+            pos = end + 1;
+            if (input[end] == '\r') {
+                if (pos == input.size()) {
+                    skip_lf_ = true;
+                } else if (input[pos] == '\n') {
+                    ++pos;
+                }
+            }
+
+            bool keep_going = process_line(line);
+            line_.clear();
+            if (!keep_going) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Discard a partially received event (e.g. when reconnecting)
+     * @note The last event ID and the retry time are kept
+     */
+    void reset() {
+        line_.clear();
+        data_.clear();
+        type_.clear();
+        id_ = last_event_id_;
+        skip_lf_ = false;
+    }
+
+    /**
+     * @brief Get the ID of the last complete event (to resume the stream after it)
+     * @return The event ID (empty if none)
+     */
+    const std::string& last_event_id() const {
+        return last_event_id_;
+    }
+
+    /**
+     * @brief Get the reconnection time requested by the server
+     * @return The time in milliseconds, or -1 if the server did not send one
+     */
+    int64_t retry_ms() const {
+        return retry_ms_;
+    }
+
+private:
+    // Find the first CR or LF at or after pos in a single pass, eight bytes at a time
+    static size_t find_line_end(std::string_view input, size_t pos) {
+        constexpr uint64_t ones = 0x0101010101010101ULL;
+        constexpr uint64_t highs = 0x8080808080808080ULL;
+        const char* data = input.data();
+        const size_t size = input.size();
+
+        while (pos + sizeof(uint64_t) <= size) {
+            uint64_t word;
+            std::memcpy(&word, data + pos, sizeof(word));
+            // Bytes equal to CR or LF become zero, the classic zero-byte test flags them
+            uint64_t cr = word ^ (ones * '\r');
+            uint64_t lf = word ^ (ones * '\n');
+            uint64_t found = ((cr - ones) & ~cr & highs) | ((lf - ones) & ~lf & highs);
+            if (found != 0) {
+                break; // Located below by the byte loop
+            }
+            pos += sizeof(uint64_t);
+        }
+
+        for (; pos < size; ++pos) {
+            if (data[pos] == '\n' || data[pos] == '\r') {
+                return pos;
+            }
+        }
+        return std::string_view::npos;
+    }
+
+    // Process one line without its terminator, returns false if the handler stopped parsing
+    bool process_line(std::string_view line) {
+        if (line.empty()) {
+            return dispatch();
+        }
+        if (line[0] == ':') {
+            // Comment
+            return true;
+        }
+
+        size_t colon = line.find(':');
+        std::string_view field = line.substr(0, colon);
+        std::string_view value;
+        if (colon != std::string_view::npos) {
+            value = line.substr(colon + 1);
+            if (!value.empty() && value[0] == ' ') {
+                value.remove_prefix(1);
+            }
+        }
+
+        if (field == "data") {
+            data_.append(value.data(), value.size());
+            data_.push_back('\n');
+        } else if (field == "event") {
+            type_.assign(value.data(), value.size());
+        } else if (field == "id") {
+            if (value.find('\0') == std::string_view::npos) {
+                id_.assign(value.data(), value.size());
+            }
+        } else if (field == "retry") {
+            if (!value.empty() && value.size() < 19 &&
+                value.find_first_not_of("0123456789") == std::string_view::npos) {
+                int64_t retry = 0;
+                for (char c : value) {
+                    retry = retry * 10 + (c - '0');
+                }
+                retry_ms_ = retry;
+            }
+        }
+
+        return true;
+    }
+
+    // Hand the buffered event to the handler, returns false if the handler stopped parsing
+    bool dispatch() {
+        // The ID only counts as received once its event is complete
+        if (last_event_id_ != id_) {
+            last_event_id_ = id_;
+        }
+        if (data_.empty()) {
+            type_.clear();
+            return true;
+        }
+
+        // Drop the newline appended after the last data line
+        sse_event event;
+        event.type = type_.empty() ? std::string_view("message") : std::string_view(type_);
+        event.data = std::string_view(data_.data(), data_.size() - 1);
+        event.id = last_event_id_;
+        bool keep_going = handler_(event);
+
+        data_.clear();
+        type_.clear();
+        if (data_.capacity() > max_retained_size) {
+            std::string().swap(data_);
+        }
+        return keep_going;
+    }
+
+    // Largest event data buffer kept for reuse
+    static constexpr size_t max_retained_size = 1024 * 1024;
+
+    event_handler handler_;
+
+    // Line spanning chunks, data and type of the current event
+    std::string line_;
+    std::string data_;
+    std::string type_;
+
+    // ID field of the current event, ID of the last complete event
+    std::string id_;
+    std::string last_event_id_;
+    int64_t retry_ms_ = -1;
+
+    // Set when the last chunk ended with CR
+    bool skip_lf_ = false;
+};
+
+} // namespace mcp
+
+#endif // MCP_FRAMING_H
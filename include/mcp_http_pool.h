@@ -0,0 +1,167 @@
+/**
+ * @file mcp_http_pool.h
+ * @brief Pool of persistent HTTP connections
+ *
+ * This file defines the pool of keep-alive HTTP clients the SSE client posts
+ * its messages through, so that concurrent calls neither wait for one shared
+ * connection nor pay for a new TCP (and TLS) connection per message.
+ */
+
+#ifndef MCP_HTTP_POOL_H
+#define MCP_HTTP_POOL_H
+
+// Include the HTTP library
+#include "httplib.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mcp {
+
+/**
+ * @class http_connection_pool
+ * @brief Keep-alive HTTP clients for one server, handed out one request at a time
+ *
+ * Connections are opened lazily, up to the configured maximum, when all open
+ * ones are busy; a request beyond the maximum waits for the next free one.
+ * Free connections are reused most recently used first, so light traffic keeps
+ * a single warm connection while idle ones are dropped by the server. All
+ * connections are keep-alive with TCP_NODELAY set.
+ */
+class http_connection_pool {
+public:
+    /**
+     * @struct configuration
+     * @brief Configuration settings for the pool.
+     */
+    struct configuration {
+        /** Maximum number of connections */
+        size_t max_connections{ 4 };
+
+        /** Connection, read and write timeout in seconds */
+        int timeout_seconds{ 30 };
+
+        /** Whether to validate SSL certificates */
+        bool validate_certificates{ true };
+
+        /** Path to a CA certificate file for SSL validation (optional) */
+        std::string ca_cert_path;
+    };
+
+    /**
+     * @struct statistics
+     * @brief Pool utilization counters
+     */
+    struct statistics {
+        /** Connections currently in the pool (busy or free) */
+        size_t connections = 0;
+
+        /** Connections currently running a request */
+        size_t busy = 0;
+
+        /** Highest number of connections busy at the same time */
+        size_t peak_busy = 0;
+
+        /** Requests sent */
+        uint64_t requests = 0;
+
+        /** Requests that waited because all connections were busy */
+        uint64_t waits = 0;
+
+        /** TCP connections established (requests - connects were sent on reused connections) */
+        uint64_t connects = 0;
+    };
+
+    /**
+     * @brief Constructor
+     * @param scheme_host_port The base URL of the server (e.g., "http://localhost:8080")
+     * @param conf The pool configuration
+     */
+    http_connection_pool(const std::string& scheme_host_port, const configuration& conf);
+
+    /**
+     * @brief Constructor with the default configuration
+     * @param scheme_host_port The base URL of the server
+     */
+    explicit http_connection_pool(const std::string& scheme_host_port)
+        : http_connection_pool(scheme_host_port, configuration()) {
+    }
+
+    /**
+     * @brief Destructor, closes all connections
+     */
+    ~http_connection_pool();
+
+    http_connection_pool(const http_connection_pool&) = delete;
+    http_connection_pool& operator=(const http_connection_pool&) = delete;
+
+    /**
+     * @brief Send a POST request on a free connection
+     * @param path The request path
+     * @param headers The request headers
+     * @param body The request body
+     * @param content_type The content type of the body
+     * @return The result of the request
+     */
+    httplib::Result post(const std::string& path, const httplib::Headers& headers, const std::string& body,
+        const std::string& content_type);
+
+    /**
+     * @brief Set the connection, read and write timeout
+     * @param timeout_seconds The timeout in seconds
+     */
+    void set_timeout(int timeout_seconds);
+
+    /**
+     * @brief Set the maximum number of connections
+     * @param max_connections The maximum (at least 1); extra connections are closed when they become free
+     */
+    void set_max_connections(size_t max_connections);
+
+    /**
+     * @brief Get the utilization counters
+     * @return The counters
+     */
+    statistics stats() const;
+
+private:
+    // Take a free connection, opening or waiting for one when none is free
+    std::unique_ptr<httplib::Client> acquire();
+
+    // Return a connection after a request
+    void release(std::unique_ptr<httplib::Client> client);
+
+    // Create a client configured for this pool
+    std::unique_ptr<httplib::Client> create_client() const;
+
+    // scheme://host:port
+    std::string scheme_host_port_;
+
+    // Pool configuration
+    configuration conf_;
+
+    // Free connections, most recently used last
+    std::vector<std::unique_ptr<httplib::Client>> free_;
+
+    // Connections in the pool (busy or free)
+    size_t connections_ = 0;
+
+    // Utilization counters (connects is updated from socket creation)
+    statistics stats_;
+    std::shared_ptr<std::atomic<uint64_t>> connects_;
+
+    // Mutex
+    mutable std::mutex mutex_;
+
+    // Signaled when a connection becomes free
+    std::condition_variable free_cv_;
+};
+
+} // namespace mcp
+
+#endif // MCP_HTTP_POOL_H
@@ -0,0 +1,251 @@
+/**
+ * @file mcp_inprocess_client.h
+ * @brief MCP in-process client
+ *
+ * This file implements a client bound directly to a server instance in the
+ * same process, for tests and embedded deployments that do not need a
+ * transport at all.
+ */
+
+#ifndef MCP_INPROCESS_CLIENT_H
+#define MCP_INPROCESS_CLIENT_H
+
+#include "mcp_client.h"
+#include "mcp_server.h"
+#include "mcp_cancellation.h"
+#include "mcp_message.h"
+#include "mcp_tool.h"
+#include "mcp_logger.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mcp {
+
+/**
+ * @class inprocess_client
+ * @brief Client calling the request processing of a server in the same process
+ *
+ * Requests are handed to the server as objects and processed on the calling
+ * thread with the same dispatch as requests received over HTTP or stdio;
+ * neither requests nor responses are serialized, and results are moved out of
+ * the response. The client is a session of its own, requests and notifications
+ * the server sends to it run on the client's dispatcher.
+ */
+class inprocess_client : public client {
+public:
+    /**
+     * @brief Constructor
+     * @param mcp_server Shared pointer to the MCP server instance
+     * @param capabilities The capabilities of the client
+     */
+    inprocess_client(std::shared_ptr<server> mcp_server, const json& capabilities = json::object());
+
+    /**
+     * @brief Destructor, ends the session
+     */
+    ~inprocess_client() override;
+
+    inprocess_client(const inprocess_client&) = delete;
+    inprocess_client& operator=(const inprocess_client&) = delete;
+
+    /**
+     * @brief Set the executor running handlers for server requests and notifications
+     * @param executor The executor (may be shared between clients)
+     */
+    void set_executor(std::shared_ptr<thread_pool> executor);
+
+    /**
+     * @brief Open a session and initialize it
+     * @param client_name The name of the client
+     * @param client_version The version of the client
+     * @return True if initialization was successful
+     */
+    bool initialize(const std::string& client_name, const std::string& client_version) override;
+
+    /**
+     * @brief Ping request
+     * @return True if the server is alive
+     */
+    bool ping() override;
+
+    /**
+     * @brief Set client capabilities
+     * @param capabilities The capabilities of the client
+     */
+    void set_capabilities(const json& capabilities) override;
+
+    /**
+     * @brief Send a request and wait for a response
+     * @param method The method to call
+     * @param params The parameters to pass
+     * @return The response
+     * @throws mcp_exception on error
+     */
+    response send_request(const std::string& method, const json& params = json::object()) override;
+
+    /**
+     * @brief Send a request built by the caller and wait for a response
+     * @param req The request; its ID lets another thread cancel it with cancel_request()
+     * @return The response
+     * @throws mcp_exception on error, if another request with the same ID is waiting, or if the request was cancelled
+     */
+    response send_prepared_request(const request& req) override;
+
+    /**
+     * @brief Cancel a request that is waiting for its response
+     * @param id The ID of the request
+     * @param reason Optional reason passed to the server
+     * @return False if no request with this ID is waiting
+     */
+    bool cancel_request(const json& id, const std::string& reason = "") override;
+
+    /**
+     * @brief Send a notification (no response expected)
+     * @param method The method to call
+     * @param params The parameters to pass
+     * @throws mcp_exception on error
+     */
+    void send_notification(const std::string& method, const json& params = json::object()) override;
+
+    /**
+     * @brief Get server capabilities
+     * @return The server capabilities
+     */
+    json get_server_capabilities() override;
+
+    /**
+     * @brief Call a tool
+     * @param tool_name The name of the tool to call
+     * @param arguments The arguments to pass to the tool
+     * @return The result of the tool call
+     * @throws mcp_exception on error
+     */
+    json call_tool(const std::string& tool_name, const json& arguments = json::object()) override;
+
+    /**
+     * @brief Call a tool, moving the arguments into the request
+     * @param tool_name The name of the tool to call
+     * @param arguments The arguments to pass to the tool
+     * @return The result of the tool call
+     * @throws mcp_exception on error
+     */
+    json call_tool(const std::string& tool_name, json&& arguments);
+
+    /**
+     * @brief Get available tools
+     * @return List of available tools
+     * @throws mcp_exception on error
+     */
+    std::vector<tool> get_tools() override;
+
+    /**
+     * @brief Get client capabilities
+     * @return The client capabilities
+     */
+    json get_capabilities() override;
+
+    /**
+     * @brief List available resources
+     * @param cursor Optional cursor for pagination
+     * @return List of resources
+     */
+    json list_resources(const std::string& cursor = "") override;
+
+    /**
+     * @brief Read a resource
+     * @param resource_uri The URI of the resource
+     * @return The resource content
+     */
+    json read_resource(const std::string& resource_uri) override;
+
+    /**
+     * @brief Read part of a resource
+     * @param resource_uri The URI of the resource
+     * @param offset Start of the range in bytes (negative: relative to the end)
+     * @param length Number of bytes to read (nullopt: up to the end)
+     * @return The resource content
+     */
+    json read_resource_range(const std::string& resource_uri, int64_t offset, std::optional<uint64_t> length = std::nullopt) override;
+
+    /**
+     * @brief Subscribe to resource changes
+     * @param resource_uri The URI of the resource
+     * @return Subscription result
+     */
+    json subscribe_to_resource(const std::string& resource_uri) override;
+
+    /**
+     * @brief List resource templates
+     * @return List of resource templates
+     */
+    json list_resource_templates() override;
+
+    /**
+     * @brief Check if the session is open
+     * @return True if initialized
+     */
+    bool is_running() const override;
+
+    /**
+     * @brief Get the session ID of the client
+     * @return The session ID (empty before initialize())
+     */
+    std::string get_session_id() const;
+
+    /**
+     * @brief Register a handler for requests sent by the server
+     * @param method The method name
+     * @param handler The handler (nullptr removes it)
+     */
+    void register_request_handler(const std::string& method, client_request_handler handler) override;
+
+    /**
+     * @brief Register a handler for notifications sent by the server
+     * @param method The method name
+     * @param handler The handler (nullptr removes it)
+     */
+    void register_notification_handler(const std::string& method, client_notification_handler handler) override;
+
+private:
+    // Process a request on the server and move the result out of the response
+    json send_jsonrpc(request&& req);
+
+    // Build a request without copying the parameters
+    static request make_request(const std::string& method, json&& params);
+
+    // End the session
+    void close();
+
+    // Served MCP server
+    std::shared_ptr<server> server_;
+
+    // Session of the client
+    std::string session_id_;
+
+    // Client capabilities
+    json capabilities_;
+
+    // Tokens of the requests being processed, cancelled by cancel_request()
+    std::map<json, cancellation_token> pending_requests_;
+
+    // Server capabilities
+    json server_capabilities_;
+
+    // Mutex
+    mutable std::mutex mutex_;
+
+    // Set while the session is open
+    std::atomic<bool> running_{false};
+
+    // Handlers for server requests and notifications (last member: handlers finish before the rest is destroyed)
+    message_dispatcher dispatcher_;
+};
+
+} // namespace mcp
+
+#endif // MCP_INPROCESS_CLIENT_H
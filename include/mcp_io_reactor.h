@@ -0,0 +1,143 @@
+/**
+ * @file mcp_io_reactor.h
+ * @brief Shared I/O reactor for MCP transports
+ *
+ * This file defines an event loop that multiplexes many file descriptors over
+ * a small, fixed number of threads (epoll on Linux, poll elsewhere), so that
+ * the number of threads does not grow with the number of connections.
+ * Only available on POSIX platforms.
+ */
+
+#ifndef MCP_IO_REACTOR_H
+#define MCP_IO_REACTOR_H
+
+#if !defined(_WIN32)
+
+#include "mcp_message.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace mcp {
+
+/**
+ * @class io_reactor
+ * @brief Readiness-based event loop shared by many descriptors
+ *
+ * Handlers of one descriptor never run concurrently with each other, but
+ * handlers of different descriptors may run in parallel on different threads.
+ * Handlers should not block; long running work belongs on a thread pool.
+ */
+class io_reactor {
+public:
+    /**
+     * @brief Readiness events reported to handlers (bit mask)
+     */
+    enum event : uint32_t {
+        readable = 1,
+        writable = 2,
+        hangup = 4,
+        error = 8
+    };
+
+    /**
+     * @brief Handler invoked with the mask of ready events
+     */
+    using handler = std::function<void(uint32_t events)>;
+
+    /**
+     * @brief Constructor
+     * @param thread_count Number of event loop threads (the poll backend always uses one)
+     * @throws mcp_exception if the event loop cannot be created
+     */
+    explicit io_reactor(size_t thread_count = 1);
+
+    /**
+     * @brief Destructor, stops the event loop threads
+     */
+    ~io_reactor();
+
+    io_reactor(const io_reactor&) = delete;
+    io_reactor& operator=(const io_reactor&) = delete;
+
+    /**
+     * @brief Start watching a descriptor
+     * @param fd The descriptor (should be non-blocking)
+     * @param interest Mask of readable/writable events to watch
+     * @param h Handler to call when the descriptor is ready
+     * @throws mcp_exception if the descriptor cannot be watched
+     */
+    void add(int fd, uint32_t interest, handler h);
+
+    /**
+     * @brief Change the events watched for a descriptor
+     * @param fd The descriptor
+     * @param interest Mask of readable/writable events to watch
+     */
+    void modify(int fd, uint32_t interest);
+
+    /**
+     * @brief Stop watching a descriptor
+     * @param fd The descriptor
+     *
+     * When this returns the handler is not running and will not be called
+     * again, unless remove() is called from the handler itself.
+     */
+    void remove(int fd);
+
+    /**
+     * @brief Get the number of event loop threads
+     * @return The number of threads
+     */
+    size_t thread_count() const {
+        return threads_.size();
+    }
+
+    /**
+     * @brief Get the number of watched descriptors
+     * @return The number of descriptors
+     */
+    size_t size() const;
+
+private:
+    struct registration;
+
+    // Event loop thread function
+    void run();
+
+    // Invoke the handler of a registration and re-arm it
+    void dispatch(const std::shared_ptr<registration>& reg, uint32_t events);
+
+    // Arm the descriptor with its current interest (epoll backend), returns false on failure
+    bool arm(const registration& reg, bool add);
+
+    // Wake up the event loop threads
+    void wakeup();
+
+    // epoll or poll wakeup descriptors
+    int poll_fd_ = -1;
+    int wakeup_fd_[2] = {-1, -1};
+
+    // Registrations (id -> registration) and descriptor index
+    mutable std::mutex mutex_;
+    std::unordered_map<uint64_t, std::shared_ptr<registration>> registrations_;
+    std::unordered_map<int, uint64_t> ids_;
+    uint64_t next_id_ = 1;
+
+    // Event loop threads
+    std::vector<std::thread> threads_;
+    std::atomic<bool> stopping_{false};
+};
+
+} // namespace mcp
+
+#endif // !_WIN32
+
+#endif // MCP_IO_REACTOR_H
@@ -9,12 +9,16 @@
 #ifndef MCP_MESSAGE_H
 #define MCP_MESSAGE_H
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include <map>
 #include <functional>
 #include <memory>
 #include <stdexcept>
+#include <chrono>
+#include <cstdint>
+#include <optional>
 
 // Include the JSON library for parsing and generating JSON
 #include "json.hpp"
@@ -34,6 +38,8 @@ enum class error_code {
     method_not_found = -32601,      // Method not found
     invalid_params = -32602,        // Invalid method parameters
     internal_error = -32603,        // Internal JSON-RPC error
+    server_busy = -32001,           // Server overloaded, retry later
+    request_timeout = -32002,       // Request deadline passed before it completed
     server_error_start = -32000,    // Server error start
     server_error_end = -32099       // Server error end
 };
@@ -92,6 +98,36 @@ struct request {
         return id.is_null();
     }
     
+    // Longest time a caller may give a request, longer ones are cut to it
+    static constexpr std::chrono::milliseconds max_timeout{std::chrono::hours(24)};
+    
+    // Time the caller gives the request, from "_meta": {"timeoutMs": ...} (nullopt: no deadline)
+    // Throws mcp_exception (invalid_params) if timeoutMs is not a positive integer
+    std::optional<std::chrono::milliseconds> timeout() const {
+        if (!params.is_object()) {
+            return std::nullopt;
+        }
+        auto meta = params.find("_meta");
+        if (meta == params.end() || !meta->is_object()) {
+            return std::nullopt;
+        }
+        auto timeout_ms = meta->find("timeoutMs");
+        if (timeout_ms == meta->end()) {
+            return std::nullopt;
+        }
+        // Positive integers parse as unsigned, those built in code may be signed
+        bool positive = timeout_ms->is_number_unsigned() ? timeout_ms->get<uint64_t>() > 0
+            : timeout_ms->is_number_integer() && timeout_ms->get<int64_t>() > 0;
+        if (!positive) {
+            throw mcp_exception(error_code::invalid_params, "timeoutMs must be a positive integer");
+        }
+        uint64_t value = timeout_ms->get<uint64_t>();
+        if (value > static_cast<uint64_t>(max_timeout.count())) {
+            return max_timeout;
+        }
+        return std::chrono::milliseconds(static_cast<int64_t>(value));
+    }
+    
     // Convert to JSON
     json to_json() const {
         json j = {
@@ -120,10 +156,10 @@ struct request {
     }
     
 private:
-    // Generate a unique ID
+    // Generate a unique ID; safe to call from concurrent requesters
     static json generate_id() {
-        static int next_id = 1;
-        return next_id++;
+        static std::atomic<int64_t> next_id{1};
+        return next_id.fetch_add(1, std::memory_order_relaxed);
     }
 };
 
@@ -135,11 +171,11 @@ struct response {
     json error;
     
     // Create a success response
-    static response create_success(const json& req_id, const json& result_data = json::object()) {
+    static response create_success(const json& req_id, json result_data = json::object()) {
         response res;
         res.jsonrpc = "2.0";
         res.id = req_id;
-        res.result = result_data;
+        res.result = std::move(result_data);
         return res;
     }
     
@@ -166,7 +202,7 @@ struct response {
     }
     
     // Convert to JSON
-    json to_json() const {
+    json to_json() const & {
         json j = {
             {"jsonrpc", jsonrpc},
             {"id", id}
@@ -181,6 +217,22 @@ struct response {
         return j;
     }
 
+    // Convert to JSON, moving the (possibly large) result instead of copying it
+    json to_json() && {
+        json j = {
+            {"jsonrpc", jsonrpc},
+            {"id", id}
+        };
+        
+        if (is_error()) {
+            j["error"] = std::move(error);
+        } else {
+            j["result"] = std::move(result);
+        }
+        
+        return j;
+    }
+
     static response from_json(const json& j) {
         response res;
         res.jsonrpc = j["jsonrpc"].get<std::string>();
@@ -191,6 +243,112 @@ struct response {
     }
 };
 
+// The only use of nlohmann::json internals: dump_to() appends through the library's serializer
+// to avoid an intermediate string. The serializer is not public API, so it is used only with
+// the vendored version in common/json.hpp; any other version falls back to json::dump().
+#if NLOHMANN_JSON_VERSION_MAJOR == 3 && NLOHMANN_JSON_VERSION_MINOR == 11 && NLOHMANN_JSON_VERSION_PATCH == 3
+#define MCP_JSON_DIRECT_SERIALIZER 1
+#endif
+
+// Serialize a JSON value by appending it to an existing buffer (no intermediate string)
+inline void dump_to(std::string& out, const json& j) {
+#if defined(MCP_JSON_DIRECT_SERIALIZER)
+    nlohmann::detail::serializer<json> s(nlohmann::detail::output_adapter<char, std::string>(out), ' ');
+    s.dump(j, false, false, 0);
+#else
+    out += j.dump();
+#endif
+}
+
+// Length of the well-formed UTF-8 sequence starting with a byte >= 0x80, 0 if it is malformed
+// (overlong forms, surrogates and code points above U+10FFFF included)
+inline std::size_t utf8_sequence_length(const unsigned char* p, std::size_t available) {
+    unsigned char low = 0x80;
+    unsigned char high = 0xbf;
+    std::size_t length = 0;
+
+    if (p[0] >= 0xc2 && p[0] <= 0xdf) {
+        length = 2;
+    } else if (p[0] >= 0xe0 && p[0] <= 0xef) {
+        length = 3;
+        if (p[0] == 0xe0) {
+            low = 0xa0;
+        } else if (p[0] == 0xed) {
+            high = 0x9f;
+        }
+    } else if (p[0] >= 0xf0 && p[0] <= 0xf4) {
+        length = 4;
+        if (p[0] == 0xf0) {
+            low = 0x90;
+        } else if (p[0] == 0xf4) {
+            high = 0x8f;
+        }
+    } else {
+        return 0;
+    }
+
+    if (length > available || p[1] < low || p[1] > high) {
+        return 0;
+    }
+    for (std::size_t i = 2; i < length; ++i) {
+        if (p[i] < 0x80 || p[i] > 0xbf) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+// Serialize raw characters as a quoted JSON string by appending it to an existing buffer.
+// Escapes match json::dump(), which also rejects malformed UTF-8.
+// Throws mcp_exception if the input is not valid UTF-8.
+inline void dump_string_to(std::string& out, const char* data, std::size_t size) {
+    static const char hex[] = "0123456789abcdef";
+
+    out.reserve(out.size() + size + 2);
+    out += '"';
+
+    std::size_t run = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        const unsigned char c = static_cast<unsigned char>(data[i]);
+        if (c >= 0x80) {
+            std::size_t length = utf8_sequence_length(reinterpret_cast<const unsigned char*>(data + i), size - i);
+            if (length == 0) {
+                throw mcp_exception(error_code::internal_error, "Invalid UTF-8 byte at index " + std::to_string(i));
+            }
+            i += length - 1;
+            continue;
+        }
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        out.append(data + run, i - run);
+        run = i + 1;
+
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                out += "\\u00";
+                out += hex[c >> 4];
+                out += hex[c & 0x0f];
+                break;
+        }
+    }
+    out.append(data + run, size - run);
+
+    out += '"';
+}
+
+// Serialize a JSON value with the members of all objects sorted by key, so that values
+// differing only in member order serialize the same (used for cache keys).
+void dump_canonical_to(std::string& out, const json& j);
+
 } // namespace mcp
 
 #endif // MCP_MESSAGE_H
\ No newline at end of file
@@ -10,15 +10,67 @@
 #define MCP_RESOURCE_H
 
 #include "mcp_message.h"
+#include "mcp_base64.h"
+#include "mcp_snapshot.h"
 #include "base64.hpp"
 #include <string>
 #include <vector>
 #include <memory>
 #include <functional>
 #include <map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <utility>
 
 namespace mcp {
 
+/**
+ * @brief Immutable, reference-counted text payload
+ *
+ * Readers keep the snapshot they loaded alive while the owning resource
+ * swaps in a new buffer, so concurrent reads share one allocation.
+ */
+using text_buffer = std::shared_ptr<const std::string>;
+
+/**
+ * @brief Immutable, reference-counted binary payload
+ */
+using binary_buffer = std::shared_ptr<const std::vector<uint8_t>>;
+
+/**
+ * @struct resource_range
+ * @brief Byte range of a partial resource read
+ * 
+ * A negative offset counts from the end of the content, so an offset of -4096
+ * without a length reads the last 4 KiB. Text slices are adjusted to UTF-8
+ * character boundaries; the range actually returned is reported back in the
+ * "range" field of the content.
+ */
+struct resource_range {
+    // Start of the range in bytes (negative: relative to the end)
+    int64_t offset = 0;
+    
+    // Number of bytes to read (nullopt: up to the end)
+    std::optional<uint64_t> length;
+    
+    /**
+     * @brief Resolve the range against a content size
+     * @param total The content size in bytes
+     * @return The [begin, end) byte positions, clamped to the content
+     */
+    std::pair<uint64_t, uint64_t> resolve(uint64_t total) const;
+    
+    /**
+     * @brief Parse the range from resources/read parameters
+     * @param params The request parameters ("offset" and/or "length")
+     * @return The range, or nullopt if the parameters do not request one
+     * @throws mcp_exception if offset or length are not valid integers
+     */
+    static std::optional<resource_range> from_params(const json& params);
+};
+
 /**
  * @class resource
  * @brief Base class for MCP resources
@@ -42,6 +94,35 @@ public:
      */
     virtual json read() const = 0;
     
+    /**
+     * @brief Serialize the resource content as JSON and append it to a string
+     * @param out The string to append to
+     * 
+     * The default implementation dumps read(). Implementations holding a
+     * shared buffer override it to serialize straight from that buffer.
+     */
+    virtual void write_content(std::string& out) const {
+        dump_to(out, read());
+    }
+    
+    /**
+     * @brief Read part of the resource content
+     * @param range The byte range to read
+     * @return The resource content as JSON, with a "range" field describing the returned slice
+     * 
+     * The default implementation reads the whole content and slices it.
+     */
+    virtual json read_range(const resource_range& range) const;
+    
+    /**
+     * @brief Serialize part of the resource content as JSON and append it to a string
+     * @param out The string to append to
+     * @param range The byte range to read
+     */
+    virtual void write_content(std::string& out, const resource_range& range) const {
+        dump_to(out, read_range(range));
+    }
+    
     /**
      * @brief Check if the resource has been modified
      * @return True if the resource has been modified since last read
@@ -60,7 +141,8 @@ public:
  * @brief Resource containing text content
  * 
  * The text_resource class provides a base implementation for resources
- * that contain text content.
+ * that contain text content. Reads are safe to run concurrently with each
+ * other and with updates, and do not take a lock.
  */
 class text_resource : public resource {
 public:
@@ -88,6 +170,26 @@ public:
      */
     json read() const override;
     
+    /**
+     * @brief Serialize the resource content straight from the current text buffer
+     * @param out The string to append to
+     */
+    void write_content(std::string& out) const override;
+    
+    /**
+     * @brief Read part of the text content
+     * @param range The byte range to read
+     * @return The resource content as JSON
+     */
+    json read_range(const resource_range& range) const override;
+    
+    /**
+     * @brief Serialize part of the text content straight from the current text buffer
+     * @param out The string to append to
+     * @param range The byte range to read
+     */
+    void write_content(std::string& out, const resource_range& range) const override;
+    
     /**
      * @brief Check if the resource has been modified
      * @return True if the resource has been modified since last read
@@ -106,19 +208,44 @@ public:
      */
     void set_text(const std::string& text);
     
+    /**
+     * @brief Set the text content of the resource, taking ownership of the string
+     * @param text The text content
+     */
+    void set_text(std::string&& text);
+    
+    /**
+     * @brief Replace the text content with an existing shared buffer
+     * @param buffer The new buffer (nullptr means empty text)
+     */
+    void set_text_buffer(text_buffer buffer);
+    
     /**
      * @brief Get the text content of the resource
-     * @return The text content
+     * @return A copy of the text content
      */
     std::string get_text() const;
+    
+    /**
+     * @brief Get the current text snapshot without copying
+     * @return The shared buffer, never nullptr
+     */
+    text_buffer get_text_buffer() const;
 
 protected:
+    /**
+     * @brief Publish a new text snapshot and mark the resource as modified
+     * @param buffer The new buffer
+     */
+    void store_text(text_buffer buffer) const;
+
     std::string uri_;
     std::string name_;
     std::string mime_type_;
     std::string description_;
-    std::string text_;
-    mutable bool modified_;
+    // Current text snapshot (mutable so that file_resource can refresh it while reading)
+    mutable snapshot_cell<std::string> text_;
+    mutable std::atomic<bool> modified_;
 };
 
 /**
@@ -126,7 +253,8 @@ protected:
  * @brief Resource containing binary content
  * 
  * The binary_resource class provides a base implementation for resources
- * that contain binary content.
+ * that contain binary content. Reads are safe to run concurrently with each
+ * other and with updates, and do not take a lock.
  */
 class binary_resource : public resource {
 public:
@@ -154,6 +282,26 @@ public:
      */
     json read() const override;
     
+    /**
+     * @brief Serialize the resource content, base64-encoding straight from the current buffer
+     * @param out The string to append to
+     */
+    void write_content(std::string& out) const override;
+    
+    /**
+     * @brief Read part of the binary content
+     * @param range The byte range to read
+     * @return The resource content as JSON with base64-encoded data
+     */
+    json read_range(const resource_range& range) const override;
+    
+    /**
+     * @brief Serialize part of the binary content straight from the current buffer
+     * @param out The string to append to
+     * @param range The byte range to read
+     */
+    void write_content(std::string& out, const resource_range& range) const override;
+    
     /**
      * @brief Check if the resource has been modified
      * @return True if the resource has been modified since last read
@@ -174,18 +322,37 @@ public:
     void set_data(const uint8_t* data, size_t size);
     
     /**
-     * @brief Get the binary content of the resource
-     * @return The binary content
+     * @brief Set the binary content of the resource, taking ownership of the vector
+     * @param data The binary data
+     */
+    void set_data(std::vector<uint8_t>&& data);
+    
+    /**
+     * @brief Replace the binary content with an existing shared buffer
+     * @param buffer The new buffer (nullptr means empty data)
+     */
+    void set_data_buffer(binary_buffer buffer);
+    
+    /**
+     * @brief Get a copy of the binary content of the resource
+     * @return The binary content (use get_data_buffer() to share it without copying)
+     */
+    std::vector<uint8_t> get_data() const;
+    
+    /**
+     * @brief Get the current binary snapshot without copying
+     * @return The shared buffer, never nullptr
      */
-    const std::vector<uint8_t>& get_data() const;
+    binary_buffer get_data_buffer() const;
 
 protected:
     std::string uri_;
     std::string name_;
     std::string mime_type_;
     std::string description_;
-    std::vector<uint8_t> data_;
-    mutable bool modified_;
+    // Current binary snapshot
+    snapshot_cell<std::vector<uint8_t>> data_;
+    mutable std::atomic<bool> modified_;
 };
 
 /**
@@ -212,6 +379,28 @@ public:
      */
     json read() const override;
     
+    /**
+     * @brief Reload the file and serialize it straight from the new text buffer
+     * @param out The string to append to
+     */
+    void write_content(std::string& out) const override;
+    
+    /**
+     * @brief Read part of the file
+     * @param range The byte range to read
+     * @return The resource content as JSON
+     * 
+     * Only the requested slice is read from the file (with pread where available).
+     */
+    json read_range(const resource_range& range) const override;
+    
+    /**
+     * @brief Read part of the file and serialize it
+     * @param out The string to append to
+     * @param range The byte range to read
+     */
+    void write_content(std::string& out, const resource_range& range) const override;
+    
     /**
      * @brief Check if the resource has been modified
      * @return True if the resource has been modified since last read
@@ -219,8 +408,53 @@ public:
     bool is_modified() const override;
 
 private:
+    // Identity of the file contents a snapshot was loaded from
+    struct file_stamp {
+        int64_t mtime_ns = 0;
+        uint64_t size = 0;
+        uint64_t inode = 0;
+        uint64_t device = 0;
+        bool settled = false; // mtime is old enough that a same-tick rewrite is ruled out
+        
+        bool same_file(const file_stamp& other) const {
+            return mtime_ns == other.mtime_ns && size == other.size &&
+                   inode == other.inode && device == other.device;
+        }
+    };
+    
+    // File content together with the stamp of the file it was read from
+    struct file_snapshot {
+        text_buffer text;
+        file_stamp stamp;
+    };
+    
     std::string file_path_;
-    mutable time_t last_modified_;
+    mutable snapshot_cell<file_snapshot> loaded_;
+    
+    // Keeps the text snapshot in the same order as loaded_ when reloads race
+    mutable std::mutex publish_mutex_;
+    
+    /**
+     * @brief Get the current stamp of the file
+     * @param stamp Receives the stamp
+     * @return False if the file could not be examined
+     */
+    bool stat_file(file_stamp& stamp) const;
+    
+    /**
+     * @brief Read the file if it changed and publish its content together with its stamp
+     * @return The current content and stamp
+     */
+    std::shared_ptr<const file_snapshot> reload() const;
+    
+    /**
+     * @brief Read a slice of the file, adjusted to UTF-8 character boundaries
+     * @param range The byte range to read
+     * @param begin Receives the file offset of the returned slice
+     * @param total Receives the file size
+     * @return The slice
+     */
+    std::string read_slice(const resource_range& range, uint64_t& begin, uint64_t& total) const;
     
     /**
      * @brief Guess the MIME type from file extension
@@ -234,14 +468,32 @@ private:
  * @class resource_manager
  * @brief Manager for MCP resources
  * 
- * The resource_manager class provides a central registry for resources
- * and handles resource operations.
+ * The resource_manager class provides a registry for resources and handles
+ * resource operations. Resources are spread over shards by URI hash; each
+ * shard has its own reader-writer lock, so lookups proceed concurrently and
+ * only contend with writers touching the same shard.
  */
 class resource_manager {
 public:
     /**
-     * @brief Get the singleton instance
-     * @return Reference to the singleton instance
+     * @brief Default number of shards
+     */
+    static constexpr size_t default_shard_count = 16;
+    
+    /**
+     * @brief Constructor
+     * @param shard_count Number of shards (at least 1)
+     */
+    explicit resource_manager(size_t shard_count = default_shard_count);
+    
+    ~resource_manager();
+    
+    resource_manager(const resource_manager&) = delete;
+    resource_manager& operator=(const resource_manager&) = delete;
+    
+    /**
+     * @brief Get the process-wide instance
+     * @return Reference to the shared instance
      */
     static resource_manager& instance();
     
@@ -251,6 +503,13 @@ public:
      */
     void register_resource(std::shared_ptr<resource> resource);
     
+    /**
+     * @brief Register a resource under an explicit URI
+     * @param uri The URI to register the resource under
+     * @param resource Shared pointer to the resource
+     */
+    void register_resource(const std::string& uri, std::shared_ptr<resource> resource);
+    
     /**
      * @brief Unregister a resource
      * @param uri The URI of the resource to unregister
@@ -267,7 +526,7 @@ public:
     
     /**
      * @brief List all registered resources
-     * @return JSON array of resource metadata
+     * @return JSON object whose "resources" array holds the resource metadata, ordered by URI
      */
     json list_resources() const;
     
@@ -277,31 +536,36 @@ public:
      * @param callback The callback function to call when the resource changes
      * @return Subscription ID
      */
-    int subscribe(const std::string& uri, std::function<void(const std::string&)> callback);
+    int64_t subscribe(const std::string& uri, std::function<void(const std::string&)> callback);
     
     /**
      * @brief Unsubscribe from resource changes
      * @param subscription_id The subscription ID
      * @return True if the subscription was removed
      */
-    bool unsubscribe(int subscription_id);
+    bool unsubscribe(int64_t subscription_id);
     
     /**
      * @brief Notify subscribers of resource changes
      * @param uri The URI of the resource that changed
+     * 
+     * Callbacks are invoked without holding any lock, so they may subscribe
+     * or unsubscribe.
      */
     void notify_resource_changed(const std::string& uri);
 
 private:
-    resource_manager() = default;
-    ~resource_manager() = default;
+    struct shard;
     
-    resource_manager(const resource_manager&) = delete;
-    resource_manager& operator=(const resource_manager&) = delete;
+    // Get the shard responsible for a URI
+    shard& shard_for(const std::string& uri) const;
+    
+    std::unique_ptr<shard[]> shards_;
+    size_t shard_count_;
     
-    std::map<std::string, std::shared_ptr<resource>> resources_;
-    std::map<int, std::pair<std::string, std::function<void(const std::string&)>>> subscriptions_;
-    int next_subscription_id_ = 1;
+    // Subscription IDs encode the shard index (id % shard_count_); 64 bits
+    // keep the id space from running out within any realistic lifetime
+    std::atomic<int64_t> next_subscription_id_{1};
 };
 
 } // namespace mcp
@@ -12,6 +12,8 @@
 #include "mcp_message.h"
 #include "mcp_resource.h"
 #include "mcp_tool.h"
+#include "mcp_tool_memo.h"
+#include "mcp_cancellation.h"
 #include "mcp_thread_pool.h"
 #include "mcp_logger.h"
 
@@ -19,7 +21,10 @@
 #include "httplib.h"
 
 #include <string>
+#include <algorithm>
 #include <map>
+#include <unordered_map>
+#include <deque>
 #include <vector>
 #include <memory>
 #include <mutex>
@@ -42,64 +47,133 @@ using session_cleanup_handler = std::function<void(const std::string&)>;
 
 class event_dispatcher {
 public:
-    event_dispatcher() {
-        message_.reserve(128); // Pre-allocate space for messages
+    /**
+     * @brief Constructor
+     * @param session_id The session the events belong to (prefix of the event IDs)
+     * @param max_replay_bytes Size of the resumable events kept for replay after a reconnection (0: no event IDs, no replay)
+     */
+    explicit event_dispatcher(std::string session_id = "", size_t max_replay_bytes = 0)
+        : session_id_(std::move(session_id)), max_replay_bytes_(max_replay_bytes) {
     }
     
     ~event_dispatcher() {
         close();
     }
 
-    bool wait_event(httplib::DataSink* sink, const std::chrono::milliseconds& timeout = std::chrono::milliseconds(10000)) {
+    /**
+     * @brief Attach a stream, replacing the previous one
+     * @param last_event_seq Sequence number of the last event the client received (0: none)
+     * @return The stream generation, or 0 if events after last_event_seq are no longer available
+     */
+    uint64_t attach(uint64_t last_event_seq = 0) {
+        std::lock_guard<std::mutex> lk(m_);
+        if (closed_.load(std::memory_order_acquire) || last_event_seq >= next_seq_) {
+            return 0;
+        }
+        uint64_t first_kept = replay_.empty() ? next_seq_ : replay_.front().seq;
+        if (last_event_seq + 1 < first_kept) {
+            return 0;
+        }
+        
+        pending_.clear();
+        for (const auto& event : replay_) {
+            if (event.seq > last_event_seq) {
+                pending_.push_back(event);
+            }
+        }
+        attached_ = true;
+        ++stream_;
+        
+        // A waiter for the previous stream gives up
+        cv_.notify_all();
+        return stream_;
+    }
+
+    /**
+     * @brief Detach a stream that failed, resumable events are kept for the next attach()
+     * @param stream The stream generation returned by attach()
+     */
+    void detach(uint64_t stream) {
+        std::lock_guard<std::mutex> lk(m_);
+        if (stream != stream_ || !attached_) {
+            return;
+        }
+        attached_ = false;
+        detached_since_ = std::chrono::steady_clock::now();
+        pending_.clear();
+        cv_.notify_all();
+    }
+
+    /**
+     * @brief Get the time since the stream was detached
+     * @return The duration (zero while a stream is attached)
+     */
+    std::chrono::steady_clock::duration detached_for() const {
+        std::lock_guard<std::mutex> lk(m_);
+        if (attached_) {
+            return std::chrono::steady_clock::duration::zero();
+        }
+        return std::chrono::steady_clock::now() - detached_since_;
+    }
+
+    bool wait_event(httplib::DataSink* sink, uint64_t stream, const std::chrono::milliseconds& timeout = std::chrono::milliseconds(10000)) {
         if (!sink || closed_.load(std::memory_order_acquire)) {
             return false;
         }
         
-        std::string message_copy;
+        std::deque<queued_event> events;
         {
             std::unique_lock<std::mutex> lk(m_);
             
-            if (closed_.load(std::memory_order_acquire)) {
-                return false;
-            }
-            
-            int id = id_.load(std::memory_order_relaxed);
-            
-            bool result = cv_.wait_for(lk, timeout, [&] { 
-                return cid_.load(std::memory_order_relaxed) == id || closed_.load(std::memory_order_acquire); 
+            cv_.wait_for(lk, timeout, [&] { 
+                return !pending_.empty() || stream != stream_ || !attached_ || closed_.load(std::memory_order_acquire); 
             });
             
-            if (closed_.load(std::memory_order_acquire)) {
+            if (closed_.load(std::memory_order_acquire) || stream != stream_ || !attached_) {
                 return false;
             }
             
-            if (!result) {
-                return false;
-            }
-            
-            // Only copy the message if there is one
-            if (!message_.empty()) {
-                message_copy.swap(message_);
-            } else {
-                return true; // No message but condition satisfied
-            }
+            // Take everything queued (nothing on timeout), events sent while writing wait for the next call
+            events.swap(pending_);
         }
         
         try {
-            if (!message_copy.empty()) {
-                if (!sink->write(message_copy.data(), message_copy.size())) {
-                    close();
+            // Small events are written together, large frames are written directly instead of being copied
+            std::string batch;
+            for (const auto& event : events) {
+                if (event.seq != 0) {
+                    batch += "id: ";
+                    batch += session_id_;
+                    batch += ':';
+                    batch += std::to_string(event.seq);
+                    batch += "\r\n";
+                }
+                if (event.frame->size() < max_batched_frame) {
+                    batch += *event.frame;
+                    continue;
+                }
+                if (!batch.empty() && !sink->write(batch.data(), batch.size())) {
+                    return false;
+                }
+                batch.clear();
+                if (!sink->write(event.frame->data(), event.frame->size())) {
                     return false;
                 }
             }
-            return true;
+            return batch.empty() || sink->write(batch.data(), batch.size());
         } catch (...) {
-            close();
             return false;
         }
     }
 
-    bool send_event(const std::string& message) {
+    /**
+     * @brief Send an event to the attached stream
+     * @param message The SSE frame
+     * @param resumable Number the event and keep it for replay after a reconnection
+     * @return False if the dispatcher is closed
+     * @note Events that are not resumable are dropped while no stream is attached
+     */
+    bool send_event(std::string message, bool resumable = false) {
         if (closed_.load(std::memory_order_acquire) || message.empty()) {
             return false;
         }
@@ -111,14 +185,21 @@ public:
                 return false;
             }
             
-            // Efficiently set the message and allocate space as needed
-            if (message.size() > message_.capacity()) {
-                message_.reserve(message.size() + 64); // Pre-allocate extra space to avoid frequent reallocations
+            // Take over the caller's buffer instead of copying large frames
+            queued_event event{0, std::make_shared<const std::string>(std::move(message))};
+            if (resumable && max_replay_bytes_ > 0) {
+                event.seq = next_seq_++;
+                replay_.push_back(event);
+                replay_bytes_ += event.frame->size();
+                while (replay_bytes_ > max_replay_bytes_) {
+                    replay_bytes_ -= replay_.front().frame->size();
+                    replay_.pop_front();
+                }
+            }
+            if (attached_) {
+                pending_.push_back(std::move(event));
+                cv_.notify_one(); // Notify waiting threads
             }
-            message_ = message;
-            
-            cid_.store(id_.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
-            cv_.notify_one(); // Notify waiting threads
             return true;
         } catch (...) {
             return false;
@@ -132,6 +213,8 @@ public:
         }
         
         try {
+            // Lock so that a waiter cannot miss the notification between its check and its wait
+            std::lock_guard<std::mutex> lk(m_);
             cv_.notify_all();
         } catch (...) {
             // Ignore exceptions
@@ -141,6 +224,16 @@ public:
     bool is_closed() const {
         return closed_.load(std::memory_order_acquire);
     }
+
+    /**
+     * @brief Wait until the dispatcher is closed
+     * @param timeout The longest time to wait
+     * @return True if the dispatcher is closed
+     */
+    bool wait_closed(const std::chrono::milliseconds& timeout) {
+        std::unique_lock<std::mutex> lk(m_);
+        return cv_.wait_for(lk, timeout, [this] { return closed_.load(std::memory_order_acquire); });
+    }
     
     // Get the last activity time
     std::chrono::steady_clock::time_point last_activity() const {
@@ -155,15 +248,102 @@ public:
     }
 
 private:
+    // SSE frame with its sequence number (0: not resumable, written without an ID)
+    struct queued_event {
+        uint64_t seq;
+        std::shared_ptr<const std::string> frame;
+    };
+
+    // Frames from this size on are not copied into the write batch
+    static constexpr size_t max_batched_frame = 16 * 1024;
+
     mutable std::mutex m_;
     std::condition_variable cv_;
-    std::atomic<int> id_{0};
-    std::atomic<int> cid_{-1};
-    std::string message_;
+    std::string session_id_;
+    // Events not yet written to the attached stream, in the order they were sent
+    std::deque<queued_event> pending_;
+    // Most recent resumable events, replayed to a stream resuming after one of them
+    std::deque<queued_event> replay_;
+    size_t replay_bytes_ = 0;
+    size_t max_replay_bytes_;
+    uint64_t next_seq_ = 1;
+    // Generation of the attached stream, and whether it is still attached
+    uint64_t stream_ = 0;
+    bool attached_ = false;
+    std::chrono::steady_clock::time_point detached_since_{std::chrono::steady_clock::now()};
     std::atomic<bool> closed_{false};
     std::chrono::steady_clock::time_point last_activity_{std::chrono::steady_clock::now()};
 };
 
+class server;
+
+/**
+ * @class tool_stream
+ * @brief Sink a streaming tool handler reports progress and partial content to
+ *
+ * If the caller sent a progress token with the call, progress and content are
+ * sent to its session as notifications/progress and notifications/tools/partial
+ * while the tool runs, and the content is not repeated in the final result.
+ * Otherwise progress is dropped and the content is collected into the result.
+ */
+class tool_stream {
+public:
+    /**
+     * @brief Report progress
+     * @param progress The progress so far (must increase from call to call)
+     * @param total The total, if known
+     * @param message A human-readable message (optional)
+     */
+    void progress(double progress, std::optional<double> total = std::nullopt, const std::string& message = "");
+
+    /**
+     * @brief Emit partial content
+     * @param content A content item or an array of content items
+     */
+    void write(const json& content);
+
+    /**
+     * @brief Check whether progress and content reach the caller while the tool runs
+     * @return True if the caller sent a progress token
+     */
+    bool is_streaming() const {
+        return !progress_token_.is_null();
+    }
+
+    /**
+     * @brief Check whether the call was cancelled
+     * @return True if cancelled
+     */
+    bool is_cancelled() const {
+        return token_.is_cancelled();
+    }
+
+private:
+    friend class server;
+
+    tool_stream(server& srv, const std::string& session_id, json progress_token);
+
+    // Final result content: the collected content followed by the returned content
+    json finish(json content);
+
+    // Server sending the notifications
+    server& server_;
+
+    // Session of the call
+    std::string session_id_;
+
+    // Progress token sent with the call (null: not streaming)
+    json progress_token_;
+
+    // Token of the call
+    cancellation_token token_;
+
+    // Content collected when not streaming
+    json collected_ = json::array();
+};
+
+using streaming_tool_handler = std::function<json(const json&, tool_stream&, const std::string&)>;
+
 /**
  * @class server
  * @brief Main MCP server class
@@ -203,6 +383,27 @@ public:
 
         unsigned int threadpool_size{ std::thread::hardware_concurrency() };
 
+        /** Bytes of recent SSE events kept per session for replay when the client reconnects (0, the default, disables resumption) */
+        size_t sse_replay_buffer_size{ 0 };
+
+        /** Time a session whose SSE stream dropped is kept for the client to resume it */
+        std::chrono::seconds sse_resume_timeout{ 30 };
+
+        /** Longest time a request may take, also without a deadline from the client (0: client deadlines only) */
+        std::chrono::milliseconds request_timeout{ 0 };
+
+        /** Requests waiting for a worker beyond which new ones are rejected with 503 (0: unbounded) */
+        size_t max_queued_requests{ 0 };
+
+        /** Requests a session may have queued or running beyond which new ones are rejected with 429 (0: unlimited) */
+        size_t max_session_requests{ 0 };
+
+        /** Retry-After sent with rejected requests */
+        std::chrono::seconds retry_after{ 1 };
+
+        /** Methods processed ahead of queued requests of all sessions */
+        std::vector<std::string> priority_methods{ "initialize", "ping" };
+
         #ifdef MCP_SSL        
         /**
          * @brief SSL configuration settings.
@@ -283,12 +484,78 @@ public:
      */
     void register_resource(const std::string& path, std::shared_ptr<resource> resource);
     
+    /**
+     * @brief Get the resource registry of this server
+     * @return Reference to the resource manager
+     */
+    resource_manager& get_resource_manager() {
+        return resources_;
+    }
+    
     /**
      * @brief Register a tool
      * @param tool The tool to register
      * @param handler The function to call when the tool is invoked
      */
     void register_tool(const tool& tool, tool_handler handler);
+    
+    /**
+     * @brief Register a pure tool whose results are memoized
+     * @param tool The tool to register
+     * @param handler The function to call when the tool is invoked; its result must depend on the arguments only
+     * @param memo The memo configuration (number of results kept)
+     *
+     * Calls with arguments seen before are answered with the stored result, and
+     * concurrent calls with the same arguments run the handler once.
+     */
+    void register_tool(const tool& tool, tool_handler handler, const tool_memo::configuration& memo);
+    
+    /**
+     * @struct load_statistics
+     * @brief Request queue and admission counters
+     */
+    struct load_statistics {
+        /** Requests waiting for a worker */
+        size_t queued = 0;
+
+        /** Requests being processed */
+        size_t active = 0;
+
+        /** Highest number of requests waiting at the same time */
+        size_t peak_queued = 0;
+
+        /** Requests rejected because the queue was full */
+        uint64_t rejected_overload = 0;
+
+        /** Requests rejected because their session had too many in flight */
+        uint64_t rejected_session = 0;
+
+        /** Requests not answered because the client cancelled them */
+        uint64_t dropped = 0;
+
+        /** Requests answered with request_timeout because their deadline passed before they ran */
+        uint64_t timed_out = 0;
+    };
+
+    /**
+     * @brief Get the request queue and admission counters
+     * @return The counters
+     */
+    load_statistics get_load_stats();
+
+    /**
+     * @brief Register a tool that reports progress and partial content while it runs
+     * @param tool The tool to register
+     * @param handler The function to call when the tool is invoked, with the sink to report to
+     */
+    void register_streaming_tool(const tool& tool, streaming_tool_handler handler);
+    
+    /**
+     * @brief Get the memo of a tool registered as pure
+     * @param tool_name The name of the tool
+     * @return The memo (for its counters or to clear it), nullptr if the tool is not memoized
+     */
+    std::shared_ptr<tool_memo> get_tool_memo(const std::string& tool_name) const;
 
     /**
      * @brief Register a session cleanup handler
@@ -381,6 +648,25 @@ private:
     // Server-sent events endpoint
     std::string sse_endpoint_;
     std::string msg_endpoint_;
+
+    // SSE session resumption: replay buffer size per session, time a dropped session is kept
+    size_t sse_replay_buffer_size_;
+    std::chrono::seconds sse_resume_timeout_;
+    
+    // Longest time a request may take (0: no limit of the server's own)
+    std::chrono::milliseconds request_timeout_;
+    
+    // Admission control: requests in flight per session (0: unlimited), Retry-After of rejections
+    size_t max_session_requests_;
+    std::chrono::seconds retry_after_;
+    
+    // Methods processed ahead of queued requests
+    std::vector<std::string> priority_methods_;
+    
+    // Admission counters
+    std::atomic<uint64_t> rejected_session_{0};
+    std::atomic<uint64_t> dropped_requests_{0};
+    std::atomic<uint64_t> timed_out_requests_{0};
     
     // Method handlers
     std::map<std::string, method_handler> method_handlers_;
@@ -388,12 +674,21 @@ private:
     // Notification handlers
     std::map<std::string, notification_handler> notification_handlers_;
     
-    // Resources map (path -> resource)
-    std::map<std::string, std::shared_ptr<resource>> resources_;
+    // Resources registry (path -> resource)
+    resource_manager resources_;
+    
+    // Whether resources/read is served by the built-in handler
+    std::atomic<bool> builtin_resource_read_{false};
     
     // Tools map (name -> handler)
     std::map<std::string, std::pair<tool, tool_handler>> tools_;
     
+    // Handlers of the tools registered as streaming (name -> handler)
+    std::map<std::string, streaming_tool_handler> streaming_tools_;
+    
+    // Memos of the tools registered as pure (name -> memo)
+    std::map<std::string, std::shared_ptr<tool_memo>> tool_memos_;
+    
     // Authentication handler
     auth_handler auth_handler_;
     
@@ -409,6 +704,12 @@ private:
     // Map to track session initialization status (session_id -> initialized)
     std::map<std::string, bool> session_initialized_;
 
+    // Requests queued or running per session (session_id -> serialized request ID -> token)
+    std::map<std::string, std::unordered_map<std::string, cancellation_token>> in_flight_requests_;
+    
+    // Mutex for the in-flight requests
+    std::mutex in_flight_mutex_;
+
     // Handle SSE requests
     void handle_sse(const httplib::Request& req, httplib::Response& res);
     
@@ -421,6 +722,38 @@ private:
     // Process a JSON-RPC request
     json process_request(const request& req, const std::string& session_id);
     
+    // Process a JSON-RPC request and append the serialized response to a buffer
+    void write_response(const request& req, const std::string& session_id, std::string& out);
+    
+    // Process a request received from a session, with its cancellation token current; false if
+    // the client cancelled the request before or while it ran and no response must be sent
+    bool write_tracked_response(const request& req, const std::string& session_id,
+        const cancellation_token& token, std::string& out);
+    
+    // Register a request received from a session so that notifications/cancelled can reach it,
+    // the token expires at the request's deadline; nullopt if the session has too many requests in flight,
+    // throws mcp_exception (invalid_params) if the request's timeout is invalid, or (invalid_request) if a
+    // request with the same ID is still in flight in the session
+    std::optional<cancellation_token> begin_request(const std::string& session_id, const request& req);
+    
+    // Error response for a request the server cannot take now
+    json busy_response(const request& req, const std::string& message) const;
+    
+    // Queue a request's processing, taking turns with the other sessions; false if the queue is full
+    bool queue_request(const std::string& session_id, const request& req, std::function<void()> task);
+    
+    // Forget a request once it was processed
+    void end_request(const std::string& session_id, const json& id);
+    
+    // Cancel a request of a session (unknown or finished requests are ignored)
+    void cancel_request(const std::string& session_id, const json& id);
+    
+    // Cancel all requests of a session
+    void cancel_session_requests(const std::string& session_id);
+    
+    // Serialize a resources/read response straight from the resource buffer
+    bool write_resource_read(const request& req, const std::string& session_id, std::string& out);
+    
     // Handle initialization request
     json handle_initialize(const request& req, const std::string& session_id);
     
@@ -469,6 +802,25 @@ private:
 
     // Close session
     void close_session(const std::string& session_id);
+
+    // Stream and in-process transports drive request processing directly
+    friend class stdio_server;
+    friend class inprocess_client;
+    
+    // Streaming tools send notifications to the session of the call
+    friend class tool_stream;
+
+    // Writes a message to a session served over a byte stream, returns false if it was not written
+    using stream_writer = std::function<bool(const json&)>;
+
+    // Sessions served over a byte stream instead of SSE (session_id -> writer)
+    std::map<std::string, stream_writer> stream_sessions_;
+
+    // Register a session served over a byte stream
+    void open_stream_session(const std::string& session_id, stream_writer writer);
+
+    // Remove a session served over a byte stream and run its cleanup handlers
+    void close_stream_session(const std::string& session_id);
 };
 
 } // namespace mcp
@@ -0,0 +1,230 @@
+/**
+ * @file mcp_snapshot.h
+ * @brief Read-mostly snapshot cell for MCP
+ *
+ * This file defines an RCU-style holder for immutable values. Readers access the
+ * current value without taking a lock; read() does not touch a shared reference
+ * count either, load() copies the shared_ptr. Writers publish a new value and wait
+ * for a grace period before releasing the old one.
+ */
+
+#ifndef MCP_SNAPSHOT_H
+#define MCP_SNAPSHOT_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace mcp {
+
+/**
+ * @class snapshot_domain
+ * @brief Reader registry and grace periods shared by snapshot cells
+ *
+ * Readers register in one of several cache-line padded counters (selected per
+ * thread), so readers on different cores do not write to the same cache line.
+ * Registration uses two counter sets selected by the parity of an epoch; a writer
+ * flips the epoch and waits until the readers of the previous parity have left.
+ *
+ * The counters are paid for once per domain rather than once per cell, at the
+ * cost of a writer also waiting for in-flight reads of the other cells. Reads
+ * must therefore be short; long work on a value belongs on a handle from load().
+ */
+class snapshot_domain {
+public:
+    /**
+     * @brief Constructor
+     * @param stripe_count Number of reader counters per epoch parity (0: one per hardware thread)
+     */
+    explicit snapshot_domain(std::size_t stripe_count = 0)
+        : stripe_count_(std::max<std::size_t>(1, stripe_count ? stripe_count : std::thread::hardware_concurrency())) {
+        stripes_[0].reset(new stripe[stripe_count_]);
+        stripes_[1].reset(new stripe[stripe_count_]);
+    }
+
+    snapshot_domain(const snapshot_domain&) = delete;
+    snapshot_domain& operator=(const snapshot_domain&) = delete;
+
+    /**
+     * @brief Get the domain used by cells that are not given one
+     * @return The process-wide domain (never destroyed, so cells may outlive static destruction)
+     */
+    static snapshot_domain& global() {
+        static snapshot_domain* domain = new snapshot_domain();
+        return *domain;
+    }
+
+    /**
+     * @brief Registers a reader for its lifetime
+     */
+    class read_guard {
+    public:
+        explicit read_guard(const snapshot_domain& domain) {
+            const std::size_t index = stripe_index() % domain.stripe_count_;
+            for (;;) {
+                const unsigned epoch = domain.epoch_.load(std::memory_order_seq_cst);
+                counter_ = &domain.stripes_[epoch & 1][index].readers;
+                counter_->fetch_add(1, std::memory_order_seq_cst);
+
+                // Registered under the current epoch: any writer that flips it will wait for us
+                if (domain.epoch_.load(std::memory_order_seq_cst) == epoch) {
+                    break;
+                }
+                counter_->fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        ~read_guard() {
+            counter_->fetch_sub(1, std::memory_order_release);
+        }
+
+        read_guard(const read_guard&) = delete;
+        read_guard& operator=(const read_guard&) = delete;
+
+    private:
+        std::atomic<long>* counter_;
+    };
+
+    /**
+     * @brief Publish under the writer lock and wait for a grace period
+     * @param publish Callable swapping in the new value
+     *
+     * Every reader that may still see the value replaced by publish has left when
+     * this returns.
+     */
+    template<typename F>
+    void publish(F&& publish) {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        publish();
+        synchronize();
+    }
+
+private:
+    struct alignas(64) stripe {
+        std::atomic<long> readers{0};
+    };
+
+    // Threads are spread over the stripes round-robin on first use
+    static std::size_t stripe_index() {
+        static std::atomic<std::size_t> next_index{0};
+        thread_local const std::size_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    // Wait until every reader of the previous epoch has left
+    void synchronize() {
+        const unsigned epoch = epoch_.load(std::memory_order_relaxed);
+        epoch_.store(epoch + 1, std::memory_order_seq_cst);
+
+        const stripe* stripes = stripes_[epoch & 1].get();
+        for (std::size_t i = 0; i < stripe_count_; ++i) {
+            while (stripes[i].readers.load(std::memory_order_acquire) != 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // Number of reader counters per epoch parity
+    const std::size_t stripe_count_;
+
+    // Grace period epoch, only changed by writers
+    std::atomic<unsigned> epoch_{0};
+
+    // Reader counters per epoch parity
+    mutable std::unique_ptr<stripe[]> stripes_[2];
+
+    // Serializes writers
+    std::mutex writer_mutex_;
+};
+
+/**
+ * @class snapshot_cell
+ * @brief Holder of an immutable value with lock-free reads
+ *
+ * A cell is a single pointer; readers register and writers wait for grace periods
+ * in the cell's snapshot_domain.
+ *
+ * @note A writer blocks until in-flight reads in its domain finish, so a thread
+ *       must not store into a cell while it is reading from a cell of the same domain.
+ */
+template<typename T>
+class snapshot_cell {
+public:
+    using pointer = std::shared_ptr<const T>;
+
+    /**
+     * @brief Constructor
+     * @param value The initial value (must not be nullptr)
+     * @param domain The domain readers and writers synchronize in
+     */
+    explicit snapshot_cell(pointer value, snapshot_domain& domain = snapshot_domain::global())
+        : current_(new pointer(std::move(value))), domain_(domain) {
+    }
+
+    ~snapshot_cell() {
+        delete current_.load(std::memory_order_relaxed);
+    }
+
+    snapshot_cell(const snapshot_cell&) = delete;
+    snapshot_cell& operator=(const snapshot_cell&) = delete;
+
+    /**
+     * @brief Get a reference-counted handle to the current value
+     * @return The current value, kept alive after later stores
+     */
+    pointer load() const {
+        snapshot_domain::read_guard guard(domain_);
+        return *current_.load(std::memory_order_seq_cst);
+    }
+
+    /**
+     * @brief Access the current value without reference counting
+     * @param f Callable invoked with a const reference to the current value
+     * @return The result of f
+     * @note Writers to every cell of the domain wait for f, it must not take long
+     */
+    template<typename F>
+    auto read(F&& f) const -> decltype(f(std::declval<const T&>())) {
+        snapshot_domain::read_guard guard(domain_);
+        return f(**current_.load(std::memory_order_seq_cst));
+    }
+
+    /**
+     * @brief Publish a new value
+     * @param value The new value (must not be nullptr)
+     * @return The previous value
+     */
+    pointer exchange(pointer value) {
+        pointer* previous = nullptr;
+        domain_.publish([&]() {
+            previous = current_.exchange(new pointer(std::move(value)), std::memory_order_seq_cst);
+        });
+
+        pointer result = std::move(*previous);
+        delete previous;
+        return result;
+    }
+
+    /**
+     * @brief Publish a new value, releasing the previous one
+     * @param value The new value (must not be nullptr)
+     */
+    void store(pointer value) {
+        exchange(std::move(value));
+    }
+
+private:
+    // Current value
+    std::atomic<pointer*> current_;
+
+    // Domain of the readers and writers of this cell
+    snapshot_domain& domain_;
+};
+
+} // namespace mcp
+
+#endif // MCP_SNAPSHOT_H
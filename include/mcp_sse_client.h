@@ -10,6 +10,8 @@
 #define MCP_SSE_CLIENT_H
 
 #include "mcp_client.h"
+#include "mcp_framing.h"
+#include "mcp_http_pool.h"
 #include "mcp_message.h"
 #include "mcp_tool.h"
 #include "mcp_logger.h"
@@ -87,6 +89,27 @@ public:
      */
     void set_timeout(int timeout_seconds);
 
+    /**
+     * @brief Set the maximum number of connections posting messages concurrently
+     * @param max_connections The maximum (default: 4)
+     */
+    void set_max_connections(size_t max_connections);
+
+    /**
+     * @brief Get the utilization counters of the message connections
+     * @return The counters
+     */
+    http_connection_pool::statistics connection_stats() const;
+
+    /**
+     * @brief Cancel all requests waiting for a response
+     * @param reason The reason sent to the server (optional)
+     *
+     * The waiting calls throw mcp_exception, and the server is sent
+     * notifications/cancelled for each request so that it stops working on it.
+     */
+    void cancel_pending_requests(const std::string& reason = "");
+
     /**
      * @brief Set client capabilities
      * @param capabilities The capabilities of the client
@@ -102,6 +125,22 @@ public:
      */
     response send_request(const std::string& method, const json& params = json::object()) override;
     
+    /**
+     * @brief Send a request built by the caller and wait for a response
+     * @param req The request; its ID lets another thread cancel it with cancel_request()
+     * @return The response
+     * @throws mcp_exception on error, if another request with the same ID is waiting, or if the request was cancelled
+     */
+    response send_prepared_request(const request& req) override;
+    
+    /**
+     * @brief Cancel a request that is waiting for its response
+     * @param id The ID of the request
+     * @param reason Optional reason passed to the server
+     * @return False if no request with this ID is waiting
+     */
+    bool cancel_request(const json& id, const std::string& reason = "") override;
+    
     /**
      * @brief Send a notification (no response expected)
      * @param method The method to call
@@ -153,6 +192,7 @@ public:
      */
     json read_resource(const std::string& resource_uri) override;
 
+
     /**
      * @brief Subscribe to resource changes
      * @param resource_uri The URI of the resource
@@ -171,6 +211,26 @@ public:
      * @return True if the client is running
      */
     bool is_running() const override;
+    
+    /**
+     * @brief Register a handler for requests sent by the server
+     * @param method The method name
+     * @param handler The handler (nullptr removes it)
+     */
+    void register_request_handler(const std::string& method, client_request_handler handler) override;
+    
+    /**
+     * @brief Register a handler for notifications sent by the server
+     * @param method The method name
+     * @param handler The handler (nullptr removes it)
+     */
+    void register_notification_handler(const std::string& method, client_notification_handler handler) override;
+    
+    /**
+     * @brief Set the executor running handlers for server requests and notifications
+     * @param executor The executor (may be shared between clients)
+     */
+    void set_executor(std::shared_ptr<thread_pool> executor);
 
 private:
     // Initialize HTTP client
@@ -179,8 +239,8 @@ private:
     // Open SSE connection
     void open_sse_connection();
     
-    // Parse SSE data
-    bool parse_sse_data(const char* data, size_t length);
+    // Handle an event received on the SSE stream
+    bool handle_sse_event(const sse_event& event);
     
     // Close SSE connection
     void close_sse_connection();
@@ -188,6 +248,15 @@ private:
     // Send JSON-RPC request
     json send_jsonrpc(const request& req);
     
+    // Tell the server a request is no longer awaited
+    void send_cancelled(const json& id, const std::string& reason);
+    
+    // Result completing a cancelled request, makes the waiting call throw
+    static json cancelled_result();
+    
+    // POST a serialized message to the message endpoint
+    httplib::Result post_message(const std::string& body);
+    
     // Server host and port
     std::string host_;
     int port_ = 8080;
@@ -201,8 +270,8 @@ private:
     // Message endpoint
     std::string msg_endpoint_;
     
-    // HTTP client
-    std::unique_ptr<httplib::Client> http_client_;
+    // Keep-alive connections posting messages
+    std::unique_ptr<http_connection_pool> post_pool_;
     
     // SSE HTTP client
     std::unique_ptr<httplib::Client> sse_client_;
@@ -242,6 +311,9 @@ private:
     
     // Response condition variable
     std::condition_variable response_cv_;
+    
+    // Handlers for server requests and notifications (last member: handlers finish before the rest is destroyed)
+    message_dispatcher dispatcher_;
 };
 
 } // namespace mcp
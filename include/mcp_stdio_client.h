@@ -11,11 +11,13 @@
 #define MCP_STDIO_CLIENT_H
 
 #include "mcp_client.h"
+#include "mcp_framing.h"
 #include "mcp_message.h"
 #include "mcp_tool.h"
 #include "mcp_logger.h"
 
 #include <string>
+#include <string_view>
 #include <map>
 #include <vector>
 #include <memory>
@@ -28,6 +30,9 @@
 
 #if defined(_WIN32)
 #include <windows.h>
+#else
+#include "mcp_io_reactor.h"
+#include "mcp_write_queue.h"
 #endif
 
 namespace mcp {
@@ -63,6 +68,21 @@ public:
      */
     void set_environment_variables(const json& env_vars);
     
+#if !defined(_WIN32)
+    /**
+     * @brief Read the server output on a shared I/O reactor instead of a dedicated thread
+     * @param reactor The reactor (nullptr to use a dedicated thread)
+     * @note This must be called before initialize()
+     */
+    void set_io_reactor(std::shared_ptr<io_reactor> reactor);
+#endif
+    
+    /**
+     * @brief Set the executor running handlers for server requests and notifications
+     * @param executor The executor (may be shared between clients)
+     */
+    void set_executor(std::shared_ptr<thread_pool> executor);
+    
     /**
      * @brief Initialize the connection with the server
      * @param client_name The name of the client
@@ -77,6 +97,12 @@ public:
      */
     bool ping() override;
     
+    /**
+     * @brief Set the time to wait for responses (calls with a shorter timeout of their own wait less)
+     * @param timeout_seconds Timeout in seconds (default: 60)
+     */
+    void set_timeout(int timeout_seconds);
+    
     /**
      * @brief Set client capabilities
      * @param capabilities The capabilities of the client
@@ -92,6 +118,22 @@ public:
      */
     response send_request(const std::string& method, const json& params = json::object()) override;
     
+    /**
+     * @brief Send a request built by the caller and wait for a response
+     * @param req The request; its ID lets another thread cancel it with cancel_request()
+     * @return The response
+     * @throws mcp_exception on error, if another request with the same ID is waiting, or if the request was cancelled
+     */
+    response send_prepared_request(const request& req) override;
+    
+    /**
+     * @brief Cancel a request that is waiting for its response
+     * @param id The ID of the request
+     * @param reason Optional reason passed to the server
+     * @return False if no request with this ID is waiting
+     */
+    bool cancel_request(const json& id, const std::string& reason = "") override;
+    
     /**
      * @brief Send a notification (no response expected)
      * @param method The method to call
@@ -143,6 +185,7 @@ public:
      */
     json read_resource(const std::string& resource_uri) override;
 
+
     /**
      * @brief Subscribe to resource changes
      * @param resource_uri The URI of the resource
@@ -158,9 +201,41 @@ public:
 
     /**
      * @brief Check if the server process is running
-     * @return True if the server process is running
+     * @return True if the server process is running and has not closed its output
      */
     bool is_running() const override;
+    
+    /**
+     * @brief Stop the server process, calls still waiting for a response fail
+     */
+    void stop();
+    
+    /**
+     * @brief Split a command line into arguments the way a POSIX shell does
+     * 
+     * Arguments are separated by unquoted whitespace. Single quotes keep their
+     * content literally, inside double quotes a backslash escapes ", \\, $ and `,
+     * and outside quotes it escapes any character. No expansion is done.
+     * 
+     * @param command The command line
+     * @return The arguments, starting with the program
+     * @throws mcp_exception if a quote is not terminated
+     */
+    static std::vector<std::string> split_command(const std::string& command);
+    
+    /**
+     * @brief Register a handler for requests sent by the server
+     * @param method The method name
+     * @param handler The handler (nullptr removes it)
+     */
+    void register_request_handler(const std::string& method, client_request_handler handler) override;
+    
+    /**
+     * @brief Register a handler for notifications sent by the server
+     * @param method The method name
+     * @param handler The handler (nullptr removes it)
+     */
+    void register_notification_handler(const std::string& method, client_notification_handler handler) override;
 
 private:
     // Start server process
@@ -172,8 +247,30 @@ private:
     // Read thread function
     void read_thread_func();
     
+#if !defined(_WIN32)
+    // Read all available server output and handle complete lines, returns false on EOF or error
+    bool read_available();
+#endif
+    
+    // Handle one line (JSON-RPC message) received from the server
+    void handle_line(std::string_view line);
+    
+    // Complete all pending requests with an error
+    void fail_pending_requests(const std::string& reason);
+    
     // Send JSON-RPC request
     json send_jsonrpc(const request& req);
+
+    // Tell the server a request is no longer awaited
+    void send_cancelled(const json& id, const std::string& reason);
+    
+    // Write one serialized message (terminated by a newline) to the server, returns false on failure
+    bool write_message(std::string data);
+    
+#if !defined(_WIN32)
+    // Wake the read thread up (to stop or to write queued data)
+    void wake_read_thread();
+#endif
     
     // Server command
     std::string command_;
@@ -194,14 +291,26 @@ private:
     
     // Standard output pipe (POSIX)
     int stdout_pipe_[2] = {-1, -1};
+    
+    // Read thread wakeup descriptors (eventfd on Linux, where both entries are the same, pipe elsewhere)
+    int wakeup_fd_[2] = {-1, -1};
+    
+    // Shared reactor reading the server output (nullptr: dedicated read thread)
+    std::shared_ptr<io_reactor> reactor_;
 #endif
     
+    // Server output not yet split into lines
+    line_buffer read_buffer_;
+    
     // Read thread
     std::unique_ptr<std::thread> read_thread_;
     
     // Running status
     std::atomic<bool> running_{false};
     
+    // Set when the server closed its output (exited or crashed)
+    std::atomic<bool> output_closed_{false};
+    
     // Client capabilities
     json capabilities_;
     
@@ -217,6 +326,9 @@ private:
     // Response processing mutex
     std::mutex response_mutex_;
     
+    // Time to wait for responses in seconds
+    std::atomic<int> timeout_seconds_{60};
+    
     // Initialization status
     std::atomic<bool> initialized_{false};
     
@@ -225,6 +337,17 @@ private:
     
     // Environment variables
     json env_vars_;
+    
+#if defined(_WIN32)
+    // Serializes writes to the server input and closing it
+    std::mutex write_mutex_;
+#else
+    // Messages waiting for the server input pipe
+    write_queue write_queue_;
+#endif
+    
+    // Handlers for server requests and notifications (last member: handlers finish before the rest is destroyed)
+    message_dispatcher dispatcher_;
 };
 
 } // namespace mcp
@@ -0,0 +1,259 @@
+/**
+ * @file mcp_stdio_pool.h
+ * @brief Pool of warm stdio MCP server processes
+ *
+ * This file defines a pool that keeps a number of stdio server processes
+ * started and initialized ahead of time, so that handing one out does not pay
+ * for process spawn, runtime warmup and the initialize handshake.
+ */
+
+#ifndef MCP_STDIO_POOL_H
+#define MCP_STDIO_POOL_H
+
+#include "mcp_stdio_client.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mcp {
+
+/**
+ * @class stdio_client_pool
+ * @brief Keeps initialized stdio clients ready and hands them out as leases
+ *
+ * A background thread starts processes until the configured number of idle
+ * clients is ready, pings idle clients periodically and stops the ones that
+ * were retired. A lease returns its client to the pool when it is destroyed;
+ * the client is replaced instead when it reached its maximum number of uses,
+ * its process exited or the lease was invalidated.
+ *
+ * @note Handlers registered on a leased client stay registered when it is
+ *       returned; use max_uses = 1 when every lease needs a fresh process.
+ */
+class stdio_client_pool {
+public:
+    /**
+     * @struct configuration
+     * @brief Configuration settings for the pool.
+     */
+    struct configuration {
+        /** Number of initialized idle processes to keep ready */
+        size_t size{ 4 };
+
+        /** Idle processes kept when leases are returned, extra ones are stopped (0: twice size) */
+        size_t max_idle{ 0 };
+
+        /** Leases per process before it is replaced (0: unlimited) */
+        size_t max_uses{ 0 };
+
+        /** Interval between pings of an idle process (0: no health checks) */
+        std::chrono::milliseconds health_check_interval{ 30000 };
+
+        /** Time a health check ping may take before the process counts as unhealthy */
+        std::chrono::milliseconds health_check_timeout{ 5000 };
+
+        /** Maximum time acquire() waits for an idle process */
+        std::chrono::milliseconds acquire_timeout{ 30000 };
+
+        /** Environment variables of the server processes */
+        json env_vars = json::object();
+
+        /** Client capabilities sent in the initialize request */
+        json capabilities = json::object();
+
+        /** Client name and version sent in the initialize request */
+        std::string client_name{ "mcp-stdio-pool" };
+        std::string client_version{ "1.0.0" };
+
+#if !defined(_WIN32)
+        /** Reactor reading the server output (nullptr: one read thread per process) */
+        std::shared_ptr<io_reactor> reactor;
+#endif
+    };
+
+private:
+    struct entry {
+        std::unique_ptr<stdio_client> client;
+        size_t uses = 0;
+        std::chrono::steady_clock::time_point last_checked;
+    };
+
+    // Link from the leases to the pool, cleared when the pool is destroyed
+    struct owner {
+        std::mutex mutex;
+        stdio_client_pool* pool = nullptr;
+    };
+
+public:
+    /**
+     * @class lease
+     * @brief Exclusive use of a pooled client, returned to the pool on destruction
+     */
+    class lease {
+    public:
+        lease() = default;
+        lease(lease&& other) noexcept;
+        lease& operator=(lease&& other) noexcept;
+        ~lease();
+
+        lease(const lease&) = delete;
+        lease& operator=(const lease&) = delete;
+
+        /**
+         * @brief Get the leased client
+         * @return The client (nullptr if the lease is empty)
+         */
+        stdio_client* get() const {
+            return entry_ ? entry_->client.get() : nullptr;
+        }
+
+        stdio_client* operator->() const {
+            return get();
+        }
+
+        stdio_client& operator*() const {
+            return *get();
+        }
+
+        explicit operator bool() const {
+            return entry_ != nullptr;
+        }
+
+        /**
+         * @brief Get the number of times the client was leased, this lease included
+         * @return The number of leases (1 for a fresh process)
+         */
+        size_t uses() const {
+            return entry_ ? entry_->uses : 0;
+        }
+
+        /**
+         * @brief Replace the process instead of returning it to the pool
+         */
+        void invalidate() {
+            invalid_ = true;
+        }
+
+        /**
+         * @brief Return the client to the pool now
+         */
+        void release();
+
+    private:
+        friend class stdio_client_pool;
+
+        lease(std::shared_ptr<owner> o, std::unique_ptr<entry> e)
+            : owner_(std::move(o)), entry_(std::move(e)) {
+        }
+
+        std::shared_ptr<owner> owner_;
+        std::unique_ptr<entry> entry_;
+        bool invalid_ = false;
+    };
+
+    /**
+     * @brief Constructor, starts filling the pool in the background
+     * @param command The command starting a server process
+     * @param conf The pool configuration
+     */
+    stdio_client_pool(const std::string& command, const configuration& conf);
+
+    /**
+     * @brief Constructor with the default configuration
+     * @param command The command starting a server process
+     */
+    explicit stdio_client_pool(const std::string& command)
+        : stdio_client_pool(command, configuration()) {
+    }
+
+    /**
+     * @brief Destructor, stops all idle processes
+     * @note Leases may outlive the pool; their processes are stopped when they are released
+     */
+    ~stdio_client_pool();
+
+    stdio_client_pool(const stdio_client_pool&) = delete;
+    stdio_client_pool& operator=(const stdio_client_pool&) = delete;
+
+    /**
+     * @brief Take an initialized client out of the pool
+     * @return The lease
+     * @throws mcp_exception if no client became ready within the acquire timeout
+     */
+    lease acquire();
+
+    /**
+     * @brief Get the number of idle, initialized clients
+     * @return The number of clients
+     */
+    size_t idle_count() const;
+
+    /**
+     * @brief Get the number of leased clients
+     * @return The number of clients
+     */
+    size_t leased_count() const;
+
+    /**
+     * @brief Wait until the pool holds the configured number of idle clients
+     * @param timeout Maximum time to wait
+     * @return True if the pool is full
+     */
+    bool wait_ready(std::chrono::milliseconds timeout);
+
+private:
+    // Take back a leased client
+    void give_back(std::unique_ptr<entry> e, bool invalid);
+
+    // Background thread: start, check and stop processes
+    void maintain();
+
+    // Start and initialize one process, returns nullptr on failure
+    std::unique_ptr<entry> spawn();
+
+    // Ping idle clients that were not checked for a health check interval, one at a time
+    void check_health();
+
+    // Server command
+    std::string command_;
+
+    // Pool configuration
+    configuration conf_;
+
+    // Shared with the leases
+    std::shared_ptr<owner> owner_;
+
+    // Guards the fields below
+    mutable std::mutex mutex_;
+
+    // Signalled when an idle client is available
+    std::condition_variable available_cv_;
+
+    // Signalled when the maintenance thread has work
+    std::condition_variable work_cv_;
+
+    // Initialized clients ready to be leased
+    std::deque<std::unique_ptr<entry>> idle_;
+
+    // Clients to stop
+    std::vector<std::unique_ptr<entry>> retired_;
+
+    // Number of leased clients
+    size_t leased_ = 0;
+
+    // Stop flag
+    bool stopping_ = false;
+
+    // Maintenance thread
+    std::thread maintainer_;
+};
+
+} // namespace mcp
+
+#endif // MCP_STDIO_POOL_H
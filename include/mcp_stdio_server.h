@@ -0,0 +1,176 @@
+/**
+ * @file mcp_stdio_server.h
+ * @brief MCP stdio server transport
+ *
+ * This file implements a transport that serves an MCP server over its
+ * standard input and output, so that the server can be started as a
+ * subprocess by a stdio client instead of listening on a port.
+ */
+
+#ifndef MCP_STDIO_SERVER_H
+#define MCP_STDIO_SERVER_H
+
+#include "mcp_server.h"
+#include "mcp_framing.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace mcp {
+
+/**
+ * @class stdio_server
+ * @brief Serves an MCP server over newline-delimited JSON-RPC on a pair of descriptors
+ *
+ * Requests are read from the input descriptor and processed on the server's
+ * thread pool with the same dispatch as HTTP requests, so slow handlers do not
+ * hold up the ones behind them. Notifications are handled on the reading thread
+ * in the order they arrive. Responses are queued as they complete and written by
+ * a dedicated thread, which gathers everything queued into as few writes as
+ * possible; messages are never interleaved. The connection forms one session,
+ * and server::send_request() can address it through session_id().
+ *
+ * @note Log output goes to stderr, stdout only carries protocol messages.
+ */
+class stdio_server {
+public:
+    /**
+     * @struct configuration
+     * @brief Configuration for the stdio server
+     */
+    struct configuration {
+        /** Descriptor requests are read from (default: standard input) */
+        int input_fd{ 0 };
+
+        /** Descriptor responses are written to (default: standard output) */
+        int output_fd{ 1 };
+    };
+
+    /**
+     * @brief Constructor
+     * @param mcp_server Shared pointer to the MCP server instance
+     * @param conf Stdio transport configuration
+     */
+    stdio_server(std::shared_ptr<server> mcp_server, const configuration& conf);
+
+    /**
+     * @brief Constructor serving standard input and output
+     * @param mcp_server Shared pointer to the MCP server instance
+     */
+    explicit stdio_server(std::shared_ptr<server> mcp_server)
+        : stdio_server(std::move(mcp_server), configuration()) {
+    }
+
+    /**
+     * @brief Destructor
+     */
+    ~stdio_server();
+
+    stdio_server(const stdio_server&) = delete;
+    stdio_server& operator=(const stdio_server&) = delete;
+
+    /**
+     * @brief Start serving
+     * @param blocking If true, blocks until the input is closed or stop() is called
+     * @return True if the server started successfully
+     */
+    bool start(bool blocking = true);
+
+    /**
+     * @brief Stop reading, wait for the requests in progress and flush their responses
+     */
+    void stop();
+
+    /**
+     * @brief Check if the server is reading requests
+     * @return True if running
+     */
+    bool is_running() const;
+
+    /**
+     * @brief Get the number of requests being processed
+     * @return The number of requests
+     */
+    size_t pending_requests() const;
+
+    /**
+     * @brief Get the session ID of the connection
+     * @return The session ID
+     */
+    const std::string& session_id() const {
+        return session_id_;
+    }
+
+private:
+    // Read and handle messages until the input closes or stop() is called
+    void read_loop();
+
+    // Handle one message read from the input
+    void handle_line(std::string_view line);
+
+    // Queue a serialized message for the writer thread
+    bool enqueue_output(std::string data);
+
+    // Writer thread: write queued messages in batches
+    void write_loop();
+
+    // Wait for the requests in progress, flush the output and end the session
+    void finish();
+
+    // Served MCP server
+    std::shared_ptr<server> server_;
+
+    // Transport configuration
+    configuration conf_;
+
+    // Session of the connection
+    std::string session_id_;
+
+    // Receive buffer of the input
+    line_buffer read_buffer_;
+
+    // Reading flag
+    std::atomic<bool> running_{false};
+
+    // Reader thread (non-blocking mode)
+    std::thread reader_;
+
+#if !defined(_WIN32)
+    // Descriptor used to wake the reader up on stop()
+    int wakeup_fd_[2] = {-1, -1};
+#endif
+
+    // Guards the fields below
+    mutable std::mutex mutex_;
+
+    // Signalled when output is queued or the last request completes
+    std::condition_variable cv_;
+
+    // Serialized messages waiting for the writer thread
+    std::deque<std::string> output_;
+
+    // Requests being processed on the thread pool
+    size_t in_flight_ = 0;
+
+    // Set when no more output will be queued
+    bool output_done_ = false;
+
+    // Set when the output descriptor failed
+    bool output_failed_ = false;
+
+    // Set once finish() ran
+    bool finished_ = true;
+
+    // Writer thread
+    std::thread writer_;
+};
+
+} // namespace mcp
+
+#endif // MCP_STDIO_SERVER_H
@@ -6,25 +6,69 @@
 #ifndef MCP_THREAD_POOL_H
 #define MCP_THREAD_POOL_H
 
+#include "mcp_logger.h"
+
+#include <algorithm>
+#include <exception>
 #include <vector>
+#include <deque>
 #include <queue>
+#include <string>
+#include <unordered_map>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <functional>
 #include <future>
 #include <atomic>
+#include <cstdint>
 #include <type_traits>
 
 namespace mcp {
 
+/**
+ * @class thread_pool
+ * @brief Fixed set of worker threads running queued tasks
+ *
+ * Tasks are queued under a key, such as the session they belong to. Workers
+ * take turns between the keys with waiting tasks, so a key that queued many
+ * tasks does not hold back the others, while the tasks of one key still run
+ * in the order they were queued. Priority tasks run before all others.
+ *
+ * try_enqueue() bounds priority tasks separately from the others, each to
+ * max_queue waiting tasks, so a queue full of ordinary tasks does not reject
+ * priority ones (e.g. health checks and session setup of a server).
+ */
 class thread_pool {
 public:
+    /**
+     * @struct statistics
+     * @brief Queue and rejection counters
+     */
+    struct statistics {
+        /** Tasks waiting for a worker */
+        size_t queued = 0;
+
+        /** Tasks being run */
+        size_t active = 0;
+
+        /** Highest number of tasks waiting at the same time */
+        size_t peak_queued = 0;
+
+        /** Tasks try_enqueue() rejected because the queue was full */
+        uint64_t rejected = 0;
+
+        /** Tasks run to completion */
+        uint64_t completed = 0;
+    };
+
     /**
      * @brief Constructor
      * @param num_threads Number of threads in the thread pool
+     * @param max_queue Tasks waiting beyond which try_enqueue() rejects new ones, counted separately for priority tasks (0: unbounded)
      */
-    explicit thread_pool(unsigned int num_threads = std::thread::hardware_concurrency()) : stop_(false) {
+    explicit thread_pool(unsigned int num_threads = std::thread::hardware_concurrency(), size_t max_queue = 0)
+        : max_queue_(max_queue), stop_(false) {
         for (unsigned int i = 0; i < num_threads; ++i) {
             workers_.emplace_back([this] {
                 while (true) {
@@ -33,18 +77,27 @@ public:
                     {
                         std::unique_lock<std::mutex> lock(queue_mutex_);
                         condition_.wait(lock, [this] { 
-                            return stop_ || !tasks_.empty(); 
+                            return stop_ || queued_ > 0; 
                         });
                         
-                        if (stop_ && tasks_.empty()) {
+                        if (stop_ && queued_ == 0) {
                             return;
                         }
                         
-                        task = std::move(tasks_.front());
-                        tasks_.pop();
+                        task = pop();
+                        ++active_;
                     }
                     
-                    task();
+                    // A task that throws must not take the worker down with it
+                    try {
+                        task();
+                    } catch (const std::exception& e) {
+                        LOG_ERROR("Uncaught exception in thread pool task: ", e.what());
+                    } catch (...) {
+                        LOG_ERROR("Uncaught exception in thread pool task");
+                    }
+                    --active_;
+                    ++completed_;
                 }
             });
         }
@@ -91,24 +144,133 @@ public:
                 throw std::runtime_error("Thread pool stopped, cannot add task");
             }
             
-            tasks_.emplace([task]() { (*task)(); });
+            push(std::string(), [task]() { (*task)(); }, false);
         }
         
         condition_.notify_one();
         return result;
     }
     
+    /**
+     * @brief Submit a task unless the queue is full
+     * @param task Task function
+     * @return False if the task was rejected because max_queue tasks are already waiting
+     */
+    bool try_enqueue(std::function<void()> task) {
+        return try_enqueue(std::string(), std::move(task));
+    }
+    
+    /**
+     * @brief Submit a task taking turns with the tasks of other keys, unless the queue is full
+     * @param key Key the task is queued under, e.g. its session
+     * @param task Task function
+     * @param priority If true, the task runs before all tasks that are not priority ones
+     * @return False if the task was rejected because max_queue tasks of its kind (priority or not) are already waiting
+     */
+    bool try_enqueue(const std::string& key, std::function<void()> task, bool priority = false) {
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            
+            if (stop_) {
+                throw std::runtime_error("Thread pool stopped, cannot add task");
+            }
+            
+            // Priority tasks have a bound of their own, ordinary tasks cannot crowd them out
+            size_t waiting = priority ? priority_tasks_.size() : queued_ - priority_tasks_.size();
+            if (max_queue_ > 0 && waiting >= max_queue_) {
+                ++rejected_;
+                return false;
+            }
+            
+            push(key, std::move(task), priority);
+        }
+        
+        condition_.notify_one();
+        return true;
+    }
+    
+    /**
+     * @brief Get the queue and rejection counters
+     * @return The counters
+     */
+    statistics stats() {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        statistics stats;
+        stats.queued = queued_;
+        stats.active = active_;
+        stats.peak_queued = peak_queued_;
+        stats.rejected = rejected_;
+        stats.completed = completed_;
+        return stats;
+    }
+    
 private:
+    // Queue a task (queue mutex held)
+    void push(const std::string& key, std::function<void()> task, bool priority) {
+        if (priority) {
+            priority_tasks_.push(std::move(task));
+        } else {
+            auto& queue = tasks_[key];
+            if (queue.empty()) {
+                turns_.push_back(key);
+            }
+            queue.push(std::move(task));
+        }
+        ++queued_;
+        peak_queued_ = std::max(peak_queued_, queued_);
+    }
+    
+    // Take the next task (queue mutex held, a task is waiting)
+    std::function<void()> pop() {
+        std::function<void()> task;
+        --queued_;
+        if (!priority_tasks_.empty()) {
+            task = std::move(priority_tasks_.front());
+            priority_tasks_.pop();
+            return task;
+        }
+        
+        // The key whose turn it is gives one task and goes to the back if it has more
+        auto it = tasks_.find(turns_.front());
+        turns_.pop_front();
+        task = std::move(it->second.front());
+        it->second.pop();
+        if (it->second.empty()) {
+            tasks_.erase(it);
+        } else {
+            turns_.push_back(it->first);
+        }
+        return task;
+    }
+    
     // Worker threads
     std::vector<std::thread> workers_;
     
-    // Task queue
-    std::queue<std::function<void()>> tasks_;
+    // Task queues by key
+    std::unordered_map<std::string, std::queue<std::function<void()>>> tasks_;
+    
+    // Keys with waiting tasks, in the order they take turns
+    std::deque<std::string> turns_;
+    
+    // Tasks run before the keyed ones
+    std::queue<std::function<void()>> priority_tasks_;
+    
+    // Tasks waiting in all queues
+    size_t queued_ = 0;
     
     // Mutex and condition variable
     std::mutex queue_mutex_;
     std::condition_variable condition_;
     
+    // Queue bound of try_enqueue(), for priority and other tasks each (0: unbounded)
+    size_t max_queue_;
+    
+    // Counters (peak and rejections under the queue mutex)
+    size_t peak_queued_ = 0;
+    uint64_t rejected_ = 0;
+    std::atomic<size_t> active_{0};
+    std::atomic<uint64_t> completed_{0};
+    
     // Stop flag
     std::atomic<bool> stop_;
 };
@@ -25,13 +25,26 @@ struct tool {
     std::string description;
     json parameters_schema;
     
+    // Behavior hints such as "readOnlyHint" and "idempotentHint" (empty: none)
+    json annotations = json::object();
+    
     // Convert to JSON for API documentation
     json to_json() const {
-        return {
+        json j = {
             {"name", name},
             {"description", description},
             {"inputSchema", parameters_schema} // You may need `parameters` instead of `inputSchema` for OAI format
         };
+        if (!annotations.empty()) {
+            j["annotations"] = annotations;
+        }
+        return j;
+    }
+    
+    // Check a boolean annotation
+    bool has_hint(const std::string& hint) const {
+        auto it = annotations.find(hint);
+        return it != annotations.end() && it->is_boolean() && it->get<bool>();
     }
 };
 
@@ -116,6 +129,27 @@ public:
                                    const json& properties,
                                    bool required = true);
     
+    /**
+     * @brief Mark the tool as not modifying its environment
+     * @param read_only The hint value
+     * @return Reference to this builder
+     */
+    tool_builder& with_read_only_hint(bool read_only = true);
+    
+    /**
+     * @brief Mark repeated calls with the same arguments as having no additional effect
+     * @param idempotent The hint value
+     * @return Reference to this builder
+     */
+    tool_builder& with_idempotent_hint(bool idempotent = true);
+    
+    /**
+     * @brief Mark the tool as possibly destroying or overwriting data
+     * @param destructive The hint value
+     * @return Reference to this builder
+     */
+    tool_builder& with_destructive_hint(bool destructive = true);
+    
     /**
      * @brief Build the tool
      * @return The constructed tool
@@ -127,6 +161,7 @@ private:
     std::string description_;
     json parameters_;
     std::vector<std::string> required_params_;
+    json annotations_ = json::object();
     
     // Helper to add a parameter of any type
     tool_builder& add_param(const std::string& name, 
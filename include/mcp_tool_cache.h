@@ -0,0 +1,199 @@
+/**
+ * @file mcp_tool_cache.h
+ * @brief Client-side cache of tool call results
+ *
+ * This file defines the cache clients can consult before calling a tool, so
+ * that repeated calls of a side-effect-free tool with the same arguments do
+ * not go to the server again while the earlier result is still fresh.
+ */
+
+#ifndef MCP_TOOL_CACHE_H
+#define MCP_TOOL_CACHE_H
+
+#include "mcp_message.h"
+#include "mcp_tool.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mcp {
+
+/**
+ * @class tool_result_cache
+ * @brief Results of tool calls keyed by server, tool name and canonical arguments
+ *
+ * Arguments are serialized with object keys sorted, so arguments that differ
+ * only in key order share an entry. A tool's results are cached only if a
+ * policy was set for the tool on its server (or for every server), or if the
+ * server annotated it as read-only or idempotent; results flagged with isError and failed calls are never cached.
+ * Entries expire after the policy's TTL, and the least recently used ones are
+ * evicted when a tool exceeds its entry limit or the cache its size limit.
+ *
+ * One cache can serve any number of clients. The scope passed with each call
+ * identifies the server, so clients of the same server share their entries.
+ */
+class tool_result_cache {
+public:
+    /**
+     * @struct policy
+     * @brief Caching policy of a tool
+     */
+    struct policy {
+        /** Time a result stays valid (zero: results are not cached) */
+        std::chrono::milliseconds ttl{ 0 };
+
+        /** Maximum number of results kept for the tool (0: limited by the cache size only) */
+        size_t max_entries{ 0 };
+    };
+
+    /**
+     * @struct configuration
+     * @brief Configuration settings for the cache.
+     */
+    struct configuration {
+        /** Policy of tools without their own policy that are annotated read-only or idempotent */
+        policy annotated{ std::chrono::milliseconds(60000), 0 };
+
+        /** Maximum total size of the cached results in bytes */
+        size_t max_bytes{ 16 * 1024 * 1024 };
+    };
+
+    /**
+     * @struct statistics
+     * @brief Cache counters
+     */
+    struct statistics {
+        /** Calls answered from the cache */
+        uint64_t hits = 0;
+
+        /** Calls of cacheable tools that went to the server */
+        uint64_t misses = 0;
+
+        /** Entries removed to stay within the limits (expired entries are not counted) */
+        uint64_t evictions = 0;
+
+        /** Entries currently cached */
+        size_t entries = 0;
+
+        /** Size of the cached results in bytes */
+        size_t bytes = 0;
+    };
+
+    /**
+     * @brief Constructor
+     * @param conf The cache configuration
+     */
+    explicit tool_result_cache(const configuration& conf);
+
+    /**
+     * @brief Constructor with the default configuration
+     */
+    tool_result_cache()
+        : tool_result_cache(configuration()) {
+    }
+
+    tool_result_cache(const tool_result_cache&) = delete;
+    tool_result_cache& operator=(const tool_result_cache&) = delete;
+
+    /**
+     * @brief Get the cache shared by all clients of the process that opt in to it
+     * @return The shared cache
+     */
+    static std::shared_ptr<tool_result_cache> shared();
+
+    /** Scope of policies applying to the tool of that name on every server */
+    static constexpr const char* any_scope = "*";
+
+    /**
+     * @brief Set the policy of a tool, overriding its annotations
+     * @param scope The server the tool belongs to (any_scope: every server without its own policy for the tool)
+     * @param tool_name The name of the tool
+     * @param p The policy (a zero TTL disables caching of the tool)
+     */
+    void set_policy(const std::string& scope, const std::string& tool_name, const policy& p);
+
+    /**
+     * @brief Remember the annotations of the tools a server lists
+     * @param scope The server the tools belong to
+     * @param tools The tools
+     */
+    void set_tools(const std::string& scope, const std::vector<tool>& tools);
+
+    /**
+     * @brief Call a tool through the cache
+     * @param scope The server the tool belongs to
+     * @param tool_name The name of the tool
+     * @param arguments The arguments of the call
+     * @param call Function calling the tool on the server
+     * @return The cached or the new result
+     * @throws Whatever the call throws (nothing is cached then)
+     */
+    json call(const std::string& scope, const std::string& tool_name, const json& arguments,
+        const std::function<json()>& call);
+
+    /**
+     * @brief Remove cached results
+     * @param scope The server whose results are removed (empty: all servers)
+     * @param tool_name The tool whose results are removed (empty: all tools)
+     */
+    void invalidate(const std::string& scope = "", const std::string& tool_name = "");
+
+    /**
+     * @brief Get the cache counters
+     * @return The counters
+     */
+    statistics stats() const;
+
+private:
+    struct entry {
+        std::string key;
+        std::string scope;
+        std::string tool_name;
+        json result;
+        size_t bytes;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    // Find the policy of a tool, nullptr if its results are not cached
+    const policy* find_policy(const std::string& scope, const std::string& tool_name) const;
+
+    // Remove an entry (lock held)
+    void erase(std::list<entry>::iterator it);
+
+    // Cache configuration
+    configuration conf_;
+
+    // Policies set per scope and tool name
+    std::map<std::pair<std::string, std::string>, policy> policies_;
+
+    // Tools annotated read-only or idempotent, per scope
+    std::map<std::string, std::set<std::string>> cacheable_tools_;
+
+    // Entries, most recently used first
+    std::list<entry> entries_;
+
+    // Entries by key
+    std::unordered_map<std::string, std::list<entry>::iterator> index_;
+
+    // Number of entries per scope and tool
+    std::map<std::pair<std::string, std::string>, size_t> tool_entries_;
+
+    // Counters
+    statistics stats_;
+
+    // Mutex
+    mutable std::mutex mutex_;
+};
+
+} // namespace mcp
+
+#endif // MCP_TOOL_CACHE_H
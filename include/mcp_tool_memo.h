@@ -0,0 +1,134 @@
+/**
+ * @file mcp_tool_memo.h
+ * @brief Server-side memoization of pure tools
+ *
+ * This file defines the wrapper the server runs the handlers of tools
+ * registered as cacheable through, so that an expensive pure tool runs once
+ * per distinct set of arguments.
+ */
+
+#ifndef MCP_TOOL_MEMO_H
+#define MCP_TOOL_MEMO_H
+
+#include "mcp_message.h"
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace mcp {
+
+/**
+ * @class tool_memo
+ * @brief Bounded LRU of a tool handler's results keyed by canonical arguments
+ *
+ * The handler must be pure: its result depends on the arguments only, not on
+ * the session or on time. Arguments are serialized with object keys sorted, so
+ * arguments that differ only in key order share an entry. Concurrent calls with
+ * the same arguments are coalesced: the first one runs the handler and the
+ * others wait for its result (or its exception, which is not cached), each as
+ * long as its own request is neither cancelled nor past its deadline. A result
+ * computed for a request that was cancelled meanwhile may be cut short, so it
+ * is neither stored nor shared: the waiting calls run the handler again.
+ */
+class tool_memo {
+public:
+    /**
+     * @struct configuration
+     * @brief Configuration settings for the memo.
+     */
+    struct configuration {
+        /** Maximum number of results kept (at least 1) */
+        size_t max_entries{ 256 };
+    };
+
+    /**
+     * @struct statistics
+     * @brief Memo counters
+     */
+    struct statistics {
+        /** Calls answered with a stored result */
+        uint64_t hits = 0;
+
+        /** Calls that ran the handler */
+        uint64_t misses = 0;
+
+        /** Calls that waited for a concurrent call with the same arguments */
+        uint64_t coalesced = 0;
+
+        /** Results removed to stay within max_entries */
+        uint64_t evictions = 0;
+
+        /** Results currently stored */
+        size_t entries = 0;
+    };
+
+    /**
+     * @brief Constructor
+     * @param handler The pure tool handler
+     * @param conf The memo configuration
+     */
+    tool_memo(std::function<json(const json&, const std::string&)> handler, const configuration& conf);
+
+    tool_memo(const tool_memo&) = delete;
+    tool_memo& operator=(const tool_memo&) = delete;
+
+    /**
+     * @brief Get the result for the arguments, running the handler if none is stored
+     * @param arguments The tool arguments
+     * @param session_id The session calling the tool (passed to the handler, not part of the key)
+     * @return The tool result
+     * @throws Whatever the handler throws, mcp_exception if the calling request is cancelled while waiting
+     */
+    json call(const json& arguments, const std::string& session_id);
+
+    /**
+     * @brief Drop all stored results (results of calls in flight are not stored either)
+     */
+    void clear();
+
+    /**
+     * @brief Get the memo counters
+     * @return The counters
+     */
+    statistics stats() const;
+
+private:
+    struct entry {
+        std::string key;
+        json result;
+    };
+
+    // Tool handler
+    std::function<json(const json&, const std::string&)> handler_;
+
+    // Memo configuration
+    configuration conf_;
+
+    // Results, most recently used first
+    std::list<entry> entries_;
+
+    // Results by key
+    std::unordered_map<std::string, std::list<entry>::iterator> index_;
+
+    // Results of calls in flight by key (nullopt: the call was cancelled, waiters run the handler themselves)
+    std::unordered_map<std::string, std::shared_future<std::optional<json>>> in_flight_;
+
+    // Incremented by clear(), results of calls started before are discarded
+    uint64_t generation_ = 0;
+
+    // Counters
+    statistics stats_;
+
+    // Mutex
+    mutable std::mutex mutex_;
+};
+
+} // namespace mcp
+
+#endif // MCP_TOOL_MEMO_H
@@ -0,0 +1,277 @@
+/**
+ * @file mcp_unix_client.h
+ * @brief MCP Unix domain socket client
+ *
+ * This file implements a client that connects to an MCP server served on a
+ * Unix domain socket (see unix_server). Only available on POSIX platforms.
+ */
+
+#ifndef MCP_UNIX_CLIENT_H
+#define MCP_UNIX_CLIENT_H
+
+#if !defined(_WIN32)
+
+#include "mcp_client.h"
+#include "mcp_framing.h"
+#include "mcp_message.h"
+#include "mcp_tool.h"
+#include "mcp_logger.h"
+#include "mcp_write_queue.h"
+
+#include <string>
+#include <string_view>
+#include <map>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <thread>
+
+namespace mcp {
+
+/**
+ * @class unix_client
+ * @brief Client for connecting to MCP servers on a Unix domain socket
+ *
+ * Messages are newline-delimited JSON-RPC, as over stdio. Requests are written
+ * without blocking through a write queue, and a read thread waits for the
+ * responses and for the requests and notifications sent by the server.
+ */
+class unix_client : public client {
+public:
+    /**
+     * @brief Constructor
+     * @param socket_path The path of the server socket
+     * @param capabilities The capabilities of the client
+     */
+    unix_client(const std::string& socket_path, const json& capabilities = json::object());
+
+    /**
+     * @brief Destructor
+     */
+    ~unix_client() override;
+
+    /**
+     * @brief Set the executor running handlers for server requests and notifications
+     * @param executor The executor (may be shared between clients)
+     */
+    void set_executor(std::shared_ptr<thread_pool> executor);
+
+    /**
+     * @brief Connect and initialize the connection with the server
+     * @param client_name The name of the client
+     * @param client_version The version of the client
+     * @return True if initialization was successful
+     */
+    bool initialize(const std::string& client_name, const std::string& client_version) override;
+
+    /**
+     * @brief Ping request
+     * @return True if the server is alive
+     */
+    bool ping() override;
+
+    /**
+     * @brief Set the time to wait for responses (calls with a shorter timeout of their own wait less)
+     * @param timeout_seconds Timeout in seconds (default: 60)
+     */
+    void set_timeout(int timeout_seconds);
+
+    /**
+     * @brief Set client capabilities
+     * @param capabilities The capabilities of the client
+     */
+    void set_capabilities(const json& capabilities) override;
+
+    /**
+     * @brief Send a request and wait for a response
+     * @param method The method to call
+     * @param params The parameters to pass
+     * @return The response
+     * @throws mcp_exception on error
+     */
+    response send_request(const std::string& method, const json& params = json::object()) override;
+
+    /**
+     * @brief Send a request built by the caller and wait for a response
+     * @param req The request; its ID lets another thread cancel it with cancel_request()
+     * @return The response
+     * @throws mcp_exception on error, if another request with the same ID is waiting, or if the request was cancelled
+     */
+    response send_prepared_request(const request& req) override;
+
+    /**
+     * @brief Cancel a request that is waiting for its response
+     * @param id The ID of the request
+     * @param reason Optional reason passed to the server
+     * @return False if no request with this ID is waiting
+     */
+    bool cancel_request(const json& id, const std::string& reason = "") override;
+
+    /**
+     * @brief Send a notification (no response expected)
+     * @param method The method to call
+     * @param params The parameters to pass
+     * @throws mcp_exception on error
+     */
+    void send_notification(const std::string& method, const json& params = json::object()) override;
+
+    /**
+     * @brief Get server capabilities
+     * @return The server capabilities
+     */
+    json get_server_capabilities() override;
+
+    /**
+     * @brief Call a tool
+     * @param tool_name The name of the tool to call
+     * @param arguments The arguments to pass to the tool
+     * @return The result of the tool call
+     * @throws mcp_exception on error
+     */
+    json call_tool(const std::string& tool_name, const json& arguments = json::object()) override;
+
+    /**
+     * @brief Get available tools
+     * @return List of available tools
+     * @throws mcp_exception on error
+     */
+    std::vector<tool> get_tools() override;
+
+    /**
+     * @brief Get client capabilities
+     * @return The client capabilities
+     */
+    json get_capabilities() override;
+
+    /**
+     * @brief List available resources
+     * @param cursor Optional cursor for pagination
+     * @return List of resources
+     */
+    json list_resources(const std::string& cursor = "") override;
+
+    /**
+     * @brief Read a resource
+     * @param resource_uri The URI of the resource
+     * @return The resource content
+     */
+    json read_resource(const std::string& resource_uri) override;
+
+
+    /**
+     * @brief Subscribe to resource changes
+     * @param resource_uri The URI of the resource
+     * @return Subscription result
+     */
+    json subscribe_to_resource(const std::string& resource_uri) override;
+
+    /**
+     * @brief List resource templates
+     * @return List of resource templates
+     */
+    json list_resource_templates() override;
+
+    /**
+     * @brief Check if the connection is open
+     * @return True if connected and the server has not closed the connection
+     */
+    bool is_running() const override;
+
+    /**
+     * @brief Register a handler for requests sent by the server
+     * @param method The method name
+     * @param handler The handler (nullptr removes it)
+     */
+    void register_request_handler(const std::string& method, client_request_handler handler) override;
+
+    /**
+     * @brief Register a handler for notifications sent by the server
+     * @param method The method name
+     * @param handler The handler (nullptr removes it)
+     */
+    void register_notification_handler(const std::string& method, client_notification_handler handler) override;
+
+private:
+    // Connect to the server socket and start the read thread
+    bool connect_socket();
+
+    // Close the connection and stop the read thread
+    void disconnect();
+
+    // Read thread function
+    void read_thread_func();
+
+    // Read all available data and handle complete lines, returns false on EOF or error
+    bool read_available();
+
+    // Handle one line (JSON-RPC message) received from the server
+    void handle_line(std::string_view line);
+
+    // Complete all pending requests with an error
+    void fail_pending_requests(const std::string& reason);
+
+    // Send JSON-RPC request
+    json send_jsonrpc(const request& req);
+
+    // Tell the server a request is no longer awaited
+    void send_cancelled(const json& id, const std::string& reason);
+
+    // Write one serialized message (terminated by a newline), returns false on failure
+    bool write_message(std::string data);
+
+    // Wake the read thread up (to stop or to write queued data)
+    void wake_read_thread();
+
+    // Server socket path
+    std::string socket_path_;
+
+    // Connection socket
+    int socket_fd_ = -1;
+
+    // Read thread wakeup pipe
+    int wakeup_fd_[2] = {-1, -1};
+
+    // Data received but not yet split into lines
+    line_buffer read_buffer_;
+
+    // Read thread
+    std::unique_ptr<std::thread> read_thread_;
+
+    // Running status
+    std::atomic<bool> running_{false};
+
+    // Set when the server closed the connection
+    std::atomic<bool> connection_closed_{false};
+
+    // Client capabilities
+    json capabilities_;
+
+    // Server capabilities
+    json server_capabilities_;
+
+    // Mutex
+    mutable std::mutex mutex_;
+
+    // Request ID to Promise mapping, used for asynchronous waiting for responses
+    std::map<json, std::promise<json>> pending_requests_;
+
+    // Response processing mutex
+    std::mutex response_mutex_;
+
+    // Time to wait for responses in seconds
+    std::atomic<int> timeout_seconds_{60};
+
+    // Messages waiting for the socket
+    write_queue write_queue_;
+
+    // Handlers for server requests and notifications (last member: handlers finish before the rest is destroyed)
+    message_dispatcher dispatcher_;
+};
+
+} // namespace mcp
+
+#endif // !_WIN32
+
+#endif // MCP_UNIX_CLIENT_H
@@ -0,0 +1,140 @@
+/**
+ * @file mcp_unix_server.h
+ * @brief MCP Unix domain socket server transport
+ *
+ * This file implements a transport that serves an MCP server on a Unix domain
+ * socket, for clients on the same host that do not need HTTP. Only available
+ * on POSIX platforms.
+ */
+
+#ifndef MCP_UNIX_SERVER_H
+#define MCP_UNIX_SERVER_H
+
+#if !defined(_WIN32)
+
+#include "mcp_server.h"
+#include "mcp_stdio_server.h"
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace mcp {
+
+/**
+ * @class unix_server
+ * @brief Serves an MCP server over newline-delimited JSON-RPC on a Unix domain socket
+ *
+ * Every accepted connection is a session of its own and is served by a
+ * stdio_server on the connection socket: the framing, concurrent request
+ * processing and batched output are the same as over stdio. Messages carry no
+ * HTTP headers and no SSE framing, and responses travel on the connection the
+ * request came in on.
+ */
+class unix_server {
+public:
+    /**
+     * @struct configuration
+     * @brief Configuration for the Unix domain socket server
+     */
+    struct configuration {
+        /** Socket path; a socket file left by a server that is gone is replaced, anything else there makes start() fail */
+        std::string path;
+
+        /** Maximum number of pending connections */
+        int backlog{ 64 };
+    };
+
+    /**
+     * @brief Constructor
+     * @param mcp_server Shared pointer to the MCP server instance
+     * @param conf Socket transport configuration
+     */
+    unix_server(std::shared_ptr<server> mcp_server, const configuration& conf);
+
+    /**
+     * @brief Destructor
+     */
+    ~unix_server();
+
+    unix_server(const unix_server&) = delete;
+    unix_server& operator=(const unix_server&) = delete;
+
+    /**
+     * @brief Bind the socket and start accepting connections
+     * @param blocking If true, blocks until stop() is called
+     * @return True if the socket was bound successfully
+     */
+    bool start(bool blocking = true);
+
+    /**
+     * @brief Stop accepting, close all connections and remove the socket file
+     */
+    void stop();
+
+    /**
+     * @brief Check if the server is accepting connections
+     * @return True if running
+     */
+    bool is_running() const;
+
+    /**
+     * @brief Get the number of open connections
+     * @return The number of connections
+     */
+    size_t connection_count() const;
+
+private:
+    struct connection {
+        int fd = -1;
+        std::unique_ptr<stdio_server> transport;
+    };
+
+    // Accept connections until stop() is called
+    void accept_loop();
+
+    // Close all connections, the listening socket and the wakeup pipe
+    void release();
+
+    // Close connections whose client disconnected
+    void reap_connections();
+
+    // Stop a connection and close its socket
+    static void close_connection(connection& conn);
+
+    // Served MCP server
+    std::shared_ptr<server> server_;
+
+    // Transport configuration
+    configuration conf_;
+
+    // Listening socket
+    int listen_fd_ = -1;
+
+    // Descriptors used to wake the accept loop up on stop()
+    int wakeup_fd_[2] = {-1, -1};
+
+    // Running flag
+    std::atomic<bool> running_{false};
+
+    // Set while start() runs the accept loop in blocking mode
+    std::atomic<bool> accepting_{false};
+
+    // Accept thread (non-blocking mode)
+    std::thread acceptor_;
+
+    // Guards connections_
+    mutable std::mutex mutex_;
+
+    // Open connections
+    std::list<connection> connections_;
+};
+
+} // namespace mcp
+
+#endif // !_WIN32
+
+#endif // MCP_UNIX_SERVER_H
@@ -0,0 +1,125 @@
+/**
+ * @file mcp_write_queue.h
+ * @brief Non-blocking outgoing message queue for stream descriptors
+ *
+ * This file defines the queue that transports use to write messages to a pipe
+ * or socket without blocking the caller. Only available on POSIX platforms.
+ */
+
+#ifndef MCP_WRITE_QUEUE_H
+#define MCP_WRITE_QUEUE_H
+
+#if !defined(_WIN32)
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+
+#include <sys/types.h>
+
+namespace mcp {
+
+/**
+ * @brief Write messages from the front of a deque with one writev() call
+ * @param fd The descriptor
+ * @param messages The messages; the ones written completely are removed
+ * @param offset Bytes of the first message written before, advanced past a short write
+ * @return The number of bytes written, or -1 with errno set (EPIPE instead of SIGPIPE)
+ */
+ssize_t write_messages(int fd, std::deque<std::string>& messages, size_t& offset);
+
+/**
+ * @class write_queue
+ * @brief Queue of outgoing messages written with writev() as the descriptor accepts them
+ *
+ * push() writes immediately when nothing is queued and queues whatever the
+ * descriptor did not accept; queued messages are written later by flush(), many
+ * at a time. Messages are never interleaved, and a short write continues where
+ * it stopped. Writing to a closed pipe fails with EPIPE instead of raising SIGPIPE.
+ */
+class write_queue {
+public:
+    /**
+     * @brief Result of a write attempt
+     */
+    enum class result {
+        complete, // Everything queued has been written
+        pending,  // Data is left, call flush() when the descriptor is writable
+        failed    // The descriptor failed, the queue is closed or full
+    };
+
+    /**
+     * @brief Called with true when data starts waiting for the descriptor and false when it is written
+     *
+     * Runs while the queue is locked, so it must not call back into the queue.
+     */
+    using pending_callback = std::function<void(bool pending)>;
+
+    /**
+     * @brief Constructor
+     * @param max_pending_bytes Limit of queued bytes, pushes beyond it fail
+     */
+    explicit write_queue(size_t max_pending_bytes = 64 * 1024 * 1024);
+
+    write_queue(const write_queue&) = delete;
+    write_queue& operator=(const write_queue&) = delete;
+
+    /**
+     * @brief Start writing to a descriptor, discarding anything queued before
+     * @param fd The descriptor (must be non-blocking)
+     * @param callback Called when data starts or stops waiting (may be nullptr)
+     */
+    void open(int fd, pending_callback callback = nullptr);
+
+    /**
+     * @brief Stop writing, discarding queued data (the descriptor is not closed)
+     */
+    void close();
+
+    /**
+     * @brief Queue a message and write as much as possible without blocking
+     * @param data The message
+     * @return The write result
+     */
+    result push(std::string data);
+
+    /**
+     * @brief Write queued data without blocking
+     * @return The write result
+     */
+    result flush();
+
+    /**
+     * @brief Get the number of queued bytes not written yet
+     * @return The number of bytes
+     */
+    size_t pending_bytes() const;
+
+private:
+    // Write queued data, called with the lock held
+    result write_pending();
+
+    // Close after a write error, called with the lock held
+    result fail(int error);
+
+    mutable std::mutex mutex_;
+
+    // Descriptor (-1: closed)
+    int fd_ = -1;
+
+    // Queued messages; the first one is written from offset_
+    std::deque<std::string> messages_;
+    size_t offset_ = 0;
+    size_t pending_bytes_ = 0;
+    size_t max_pending_bytes_;
+
+    pending_callback callback_;
+};
+
+} // namespace mcp
+
+#endif // !_WIN32
+
+#endif // MCP_WRITE_QUEUE_H
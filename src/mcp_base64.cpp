@@ -0,0 +1,357 @@
+/**
+ * @file mcp_base64.cpp
+ * @brief Implementation of the vectorized base64 codec
+ *
+ * The SIMD kernels follow the well known pshufb/multiply-add formulation
+ * (Muła and Lemire). Each kernel only handles whole blocks and hands the tail
+ * over to the scalar code, which also performs padding and error reporting.
+ */
+
+#include "mcp_base64.h"
+
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define MCP_BASE64_X86 1
+#include <immintrin.h>
+#define MCP_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define MCP_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace mcp {
+
+namespace {
+
+const char encode_table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+struct decode_table_t {
+    uint8_t values[256];
+
+    decode_table_t() {
+        std::memset(values, 0xFF, sizeof(values));
+        for (uint8_t i = 0; i < 64; ++i) {
+            values[static_cast<uint8_t>(encode_table[i])] = i;
+        }
+    }
+};
+
+const decode_table_t decode_table;
+
+[[noreturn]] void throw_invalid_input() {
+    throw mcp_exception(error_code::invalid_params, "Invalid base64 input");
+}
+
+std::size_t encode_scalar(const uint8_t* in, std::size_t size, char* out) {
+    char* o = out;
+    std::size_t i = 0;
+
+    for (; i + 3 <= size; i += 3) {
+        const uint32_t v = (uint32_t(in[i]) << 16) | (uint32_t(in[i + 1]) << 8) | in[i + 2];
+        o[0] = encode_table[(v >> 18) & 0x3F];
+        o[1] = encode_table[(v >> 12) & 0x3F];
+        o[2] = encode_table[(v >> 6) & 0x3F];
+        o[3] = encode_table[v & 0x3F];
+        o += 4;
+    }
+
+    if (size - i == 1) {
+        const uint32_t v = uint32_t(in[i]) << 16;
+        o[0] = encode_table[(v >> 18) & 0x3F];
+        o[1] = encode_table[(v >> 12) & 0x3F];
+        o[2] = '=';
+        o[3] = '=';
+        o += 4;
+    } else if (size - i == 2) {
+        const uint32_t v = (uint32_t(in[i]) << 16) | (uint32_t(in[i + 1]) << 8);
+        o[0] = encode_table[(v >> 18) & 0x3F];
+        o[1] = encode_table[(v >> 12) & 0x3F];
+        o[2] = encode_table[(v >> 6) & 0x3F];
+        o[3] = '=';
+        o += 4;
+    }
+
+    return static_cast<std::size_t>(o - out);
+}
+
+// Decodes a tail that starts on a quantum boundary, handling the final padding
+std::size_t decode_scalar(const char* in, std::size_t size, uint8_t* out) {
+    if (size > 0 && in[size - 1] == '=') {
+        --size;
+        if (size > 0 && in[size - 1] == '=') {
+            --size;
+        }
+    }
+
+    const uint8_t* values = decode_table.values;
+    uint8_t* o = out;
+    std::size_t i = 0;
+
+    for (; i + 4 <= size; i += 4) {
+        const uint8_t a = values[static_cast<uint8_t>(in[i])];
+        const uint8_t b = values[static_cast<uint8_t>(in[i + 1])];
+        const uint8_t c = values[static_cast<uint8_t>(in[i + 2])];
+        const uint8_t d = values[static_cast<uint8_t>(in[i + 3])];
+        if ((a | b | c | d) & 0x80) {
+            throw_invalid_input();
+        }
+        const uint32_t v = (uint32_t(a) << 18) | (uint32_t(b) << 12) | (uint32_t(c) << 6) | d;
+        o[0] = static_cast<uint8_t>(v >> 16);
+        o[1] = static_cast<uint8_t>(v >> 8);
+        o[2] = static_cast<uint8_t>(v);
+        o += 3;
+    }
+
+    const std::size_t rest = size - i;
+    if (rest == 1) {
+        throw_invalid_input();
+    } else if (rest >= 2) {
+        const uint8_t a = values[static_cast<uint8_t>(in[i])];
+        const uint8_t b = values[static_cast<uint8_t>(in[i + 1])];
+        const uint8_t c = rest == 3 ? values[static_cast<uint8_t>(in[i + 2])] : 0;
+        if ((a | b | c) & 0x80) {
+            throw_invalid_input();
+        }
+        const uint32_t v = (uint32_t(a) << 18) | (uint32_t(b) << 12) | (uint32_t(c) << 6);
+        *o++ = static_cast<uint8_t>(v >> 16);
+        if (rest == 3) {
+            *o++ = static_cast<uint8_t>(v >> 8);
+        }
+    }
+
+    return static_cast<std::size_t>(o - out);
+}
+
+#ifdef MCP_BASE64_X86
+
+MCP_TARGET_SSSE3
+std::size_t encode_ssse3(const uint8_t* in, std::size_t size, char* out) {
+    const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m128i shift_lut = _mm_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+    std::size_t i = 0;
+    char* o = out;
+
+    // Each round reads 16 bytes but only consumes 12
+    for (; size - i >= 16; i += 12, o += 16) {
+        __m128i v = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), shuffle);
+
+        const __m128i t0 = _mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00));
+        const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+        const __m128i t2 = _mm_and_si128(v, _mm_set1_epi32(0x003f03f0));
+        const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+        const __m128i indices = _mm_or_si128(t1, t3);
+
+        __m128i result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+        result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+        result = _mm_add_epi8(_mm_shuffle_epi8(shift_lut, result), indices);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(o), result);
+    }
+
+    return static_cast<std::size_t>(o - out) + encode_scalar(in + i, size - i, o);
+}
+
+MCP_TARGET_AVX2
+std::size_t encode_avx2(const uint8_t* in, std::size_t size, char* out) {
+    const __m256i shuffle = _mm256_set_epi8(
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m256i shift_lut = _mm256_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+    std::size_t i = 0;
+    char* o = out;
+
+    // Each round reads 28 bytes (two overlapping 16 byte loads) and consumes 24
+    for (; size - i >= 28; i += 24, o += 32) {
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 12));
+        __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        v = _mm256_shuffle_epi8(v, shuffle);
+
+        const __m256i t0 = _mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00));
+        const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        const __m256i t2 = _mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0));
+        const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        const __m256i indices = _mm256_or_si256(t1, t3);
+
+        __m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+        result = _mm256_add_epi8(_mm256_shuffle_epi8(shift_lut, result), indices);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(o), result);
+    }
+
+    return static_cast<std::size_t>(o - out) + encode_ssse3(in + i, size - i, o);
+}
+
+MCP_TARGET_SSSE3
+std::size_t decode_ssse3(const char* in, std::size_t size, uint8_t* out) {
+    const __m128i lut_lo = _mm_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i lut_hi = _mm_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lut_roll = _mm_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71,
+        0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask_2f = _mm_set1_epi8(0x2F);
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+    std::size_t i = 0;
+    uint8_t* o = out;
+
+    // Each round stores 16 bytes but only produces 12; keeping 8 more characters
+    // in the input guarantees the extra 4 bytes are still inside the output buffer
+    for (; size - i >= 24; i += 16, o += 12) {
+        __m128i str = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+
+        const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask_2f);
+        const __m128i lo_nibbles = _mm_and_si128(str, mask_2f);
+        const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+        const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+
+        // Padding or invalid characters: let the scalar code deal with them
+        if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0) {
+            break;
+        }
+
+        const __m128i eq_2f = _mm_cmpeq_epi8(str, mask_2f);
+        const __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+        str = _mm_add_epi8(str, roll);
+
+        const __m128i merged = _mm_maddubs_epi16(str, _mm_set1_epi32(0x01400140));
+        __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        packed = _mm_shuffle_epi8(packed, pack);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(o), packed);
+    }
+
+    return static_cast<std::size_t>(o - out) + decode_scalar(in + i, size - i, o);
+}
+
+MCP_TARGET_AVX2
+std::size_t decode_avx2(const char* in, std::size_t size, uint8_t* out) {
+    const __m256i lut_lo = _mm256_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m256i lut_hi = _mm256_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m256i lut_roll = _mm256_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71,
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 16, 19, 4, -65, -65, -71, -71,
+        0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i mask_2f = _mm256_set1_epi8(0x2F);
+    const __m256i pack = _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m256i compact = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1);
+
+    std::size_t i = 0;
+    uint8_t* o = out;
+
+    // Each round stores 32 bytes but only produces 24, see decode_ssse3()
+    for (; size - i >= 44; i += 32, o += 24) {
+        __m256i str = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+
+        const __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask_2f);
+        const __m256i lo_nibbles = _mm256_and_si256(str, mask_2f);
+        const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+        const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+
+        if (!_mm256_testz_si256(lo, hi)) {
+            break;
+        }
+
+        const __m256i eq_2f = _mm256_cmpeq_epi8(str, mask_2f);
+        const __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles));
+        str = _mm256_add_epi8(str, roll);
+
+        const __m256i merged = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+        __m256i packed = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+        packed = _mm256_shuffle_epi8(packed, pack);
+        packed = _mm256_permutevar8x32_epi32(packed, compact);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(o), packed);
+    }
+
+    return static_cast<std::size_t>(o - out) + decode_ssse3(in + i, size - i, o);
+}
+
+#endif // MCP_BASE64_X86
+
+struct codec_impl {
+    std::size_t (*encode)(const uint8_t*, std::size_t, char*);
+    std::size_t (*decode)(const char*, std::size_t, uint8_t*);
+    const char* name;
+};
+
+const codec_impl& select_impl() {
+    static const codec_impl impl = []() -> codec_impl {
+#ifdef MCP_BASE64_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return {encode_avx2, decode_avx2, "avx2"};
+        }
+        if (__builtin_cpu_supports("ssse3")) {
+            return {encode_ssse3, decode_ssse3, "ssse3"};
+        }
+#endif
+        return {encode_scalar, decode_scalar, "scalar"};
+    }();
+    return impl;
+}
+
+} // namespace
+
+std::size_t base64_codec::encode(const uint8_t* data, std::size_t size, char* out) {
+    if (size == 0) {
+        return 0;
+    }
+    return select_impl().encode(data, size, out);
+}
+
+void base64_codec::encode_append(const uint8_t* data, std::size_t size, std::string& out) {
+    const std::size_t offset = out.size();
+    out.resize(offset + encoded_size(size));
+    encode(data, size, &out[offset]);
+}
+
+std::string base64_codec::encode(const uint8_t* data, std::size_t size) {
+    std::string result;
+    encode_append(data, size, result);
+    return result;
+}
+
+std::size_t base64_codec::decode(const char* data, std::size_t size, uint8_t* out) {
+    if (size == 0) {
+        return 0;
+    }
+    return select_impl().decode(data, size, out);
+}
+
+std::vector<uint8_t> base64_codec::decode(const std::string& str) {
+    std::vector<uint8_t> result(max_decoded_size(str.size()));
+    result.resize(decode(str.data(), str.size(), result.data()));
+    return result;
+}
+
+const char* base64_codec::implementation() {
+    return select_impl().name;
+}
+
+} // namespace mcp
@@ -0,0 +1,138 @@
+/**
+ * @file mcp_client.cpp
+ * @brief Implementation of the functionality shared by the MCP clients
+ */
+
+#include "mcp_client.h"
+
+namespace mcp {
+
+json client::read_resource_range(const std::string& resource_uri, int64_t offset, std::optional<uint64_t> length) {
+    json params = {
+        {"uri", resource_uri},
+        {"offset", offset}
+    };
+    if (length) {
+        params["length"] = *length;
+    }
+    return send_request("resources/read", params).result;
+}
+
+response client::send_prepared_request(const request& req) {
+    throw mcp_exception(error_code::internal_error, "Client does not send prepared requests: " + req.method);
+}
+
+bool client::cancel_request(const json& id, const std::string& /* reason */) {
+    throw mcp_exception(error_code::internal_error, "Client does not cancel requests: " + id.dump());
+}
+
+void client::register_request_handler(const std::string& method, client_request_handler /* handler */) {
+    throw mcp_exception(error_code::internal_error, "Client does not handle server requests: " + method);
+}
+
+void client::register_notification_handler(const std::string& method, client_notification_handler /* handler */) {
+    throw mcp_exception(error_code::internal_error, "Client does not handle server notifications: " + method);
+}
+
+json client::call_tool_streaming(const std::string& tool_name, const json& arguments, const tool_call_listener& listener) {
+    auto stream = std::make_shared<tool_stream>();
+    stream->listener = listener;
+    int64_t progress_token;
+    {
+        std::lock_guard<std::mutex> lock(tool_streams_mutex_);
+        progress_token = next_tool_stream_++;
+        tool_streams_[progress_token] = stream;
+    }
+
+    json params = {
+        {"name", tool_name},
+        {"arguments", arguments},
+        {"_meta", {{"progressToken", progress_token}}}
+    };
+
+    // Everything the server sent before the response was queued before it, wait for it to reach the listener
+    auto finish = [&]() {
+        std::unique_lock<std::mutex> lock(tool_streams_mutex_);
+        tool_streams_.erase(progress_token);
+        tool_streams_cv_.wait(lock, [&]() { return stream->queued == 0; });
+    };
+
+    try {
+        json result = send_request("tools/call", params).result;
+        finish();
+        return result;
+    } catch (...) {
+        finish();
+        throw;
+    }
+}
+
+json client::call_tool_with_timeout(const std::string& tool_name, const json& arguments, std::chrono::milliseconds timeout) {
+    return cached_tool_call(tool_name, arguments, [&]() {
+        return send_request("tools/call", {
+            {"name", tool_name},
+            {"arguments", arguments},
+            {"_meta", {{"timeoutMs", timeout.count()}}}
+        }).result;
+    });
+}
+
+bool client::deliver_tool_stream(const json& message, message_dispatcher& dispatcher) {
+    auto method = message.find("method");
+    if (method == message.end() || !method->is_string() || message.contains("id")) {
+        return false;
+    }
+
+    const std::string& name = method->get_ref<const std::string&>();
+    bool is_progress = name == "notifications/progress";
+    if (!is_progress && name != "notifications/tools/partial") {
+        return false;
+    }
+
+    auto params = message.find("params");
+    if (params == message.end() || !params->is_object()) {
+        return false;
+    }
+    auto token = params->find("progressToken");
+    if (token == params->end() || !token->is_number_integer()) {
+        return false;
+    }
+
+    std::shared_ptr<tool_stream> stream;
+    {
+        std::lock_guard<std::mutex> lock(tool_streams_mutex_);
+        auto it = tool_streams_.find(token->get<int64_t>());
+        if (it == tool_streams_.end()) {
+            return false;
+        }
+        stream = it->second;
+        ++stream->queued;
+    }
+
+    // Released with the task, whether it ran or the dispatcher dropped it
+    std::shared_ptr<void> finished(nullptr, [this, stream](void*) {
+        std::lock_guard<std::mutex> lock(tool_streams_mutex_);
+        if (--stream->queued == 0) {
+            tool_streams_cv_.notify_all();
+        }
+    });
+
+    // A slow listener must not hold up the reader, it runs on the executor in order with the notifications
+    dispatcher.post_notification([stream, is_progress, finished = std::move(finished)](const json& params) {
+        const tool_call_listener& listener = stream->listener;
+        try {
+            if (is_progress) {
+                if (listener.on_progress) {
+                    listener.on_progress(params);
+                }
+            } else if (listener.on_content && params.contains("content")) {
+                listener.on_content(params["content"]);
+            }
+        } catch (const std::exception& e) {
+            LOG_WARNING("Tool call listener failed: ", e.what());
+        }
+    }, *params);
+    return true;
+}
+
+} // namespace mcp
@@ -0,0 +1,206 @@
+/**
+ * @file mcp_dispatcher.cpp
+ * @brief Implementation of the client-side message dispatcher
+ */
+
+#include "mcp_dispatcher.h"
+#include "mcp_logger.h"
+
+namespace mcp {
+
+message_dispatcher::message_dispatcher(std::shared_ptr<thread_pool> executor)
+    : executor_(std::move(executor)) {
+    request_handlers_["ping"] = [](const json&) {
+        return json::object();
+    };
+}
+
+message_dispatcher::~message_dispatcher() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stopping_ = true;
+    notifications_.clear();
+    idle_cv_.wait(lock, [this]() { return in_flight_ == 0; });
+}
+
+void message_dispatcher::set_executor(std::shared_ptr<thread_pool> executor) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    executor_ = std::move(executor);
+}
+
+void message_dispatcher::register_request_handler(const std::string& method, client_request_handler handler) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (handler) {
+        request_handlers_[method] = std::move(handler);
+    } else {
+        request_handlers_.erase(method);
+    }
+}
+
+void message_dispatcher::register_notification_handler(const std::string& method, client_notification_handler handler) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (handler) {
+        notification_handlers_[method] = std::move(handler);
+    } else {
+        notification_handlers_.erase(method);
+    }
+}
+
+bool message_dispatcher::dispatch(json& message, reply_function reply) {
+    auto method_it = message.find("method");
+    if (method_it == message.end() || !method_it->is_string()) {
+        return false;
+    }
+
+    std::string method = method_it->get<std::string>();
+    json params = message.contains("params") ? std::move(message["params"]) : json::object();
+
+    auto id_it = message.find("id");
+    if (id_it != message.end() && !id_it->is_null()) {
+        // Request: answered from the executor, even without a handler
+        json id = std::move(*id_it);
+        LOG_INFO("Received request from server: ", method);
+        post([this, id = std::move(id), method = std::move(method), params = std::move(params), reply = std::move(reply)]() {
+            handle_request(id, method, params, reply);
+        });
+        return true;
+    }
+
+    // Notification: queued behind earlier notifications of this dispatcher
+    client_notification_handler handler;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = notification_handlers_.find(method);
+        if (it == notification_handlers_.end()) {
+            LOG_INFO("Ignoring notification without handler: ", method);
+            return true;
+        }
+        handler = it->second;
+    }
+    post_notification(std::move(handler), std::move(params));
+    return true;
+}
+
+bool message_dispatcher::post_notification(client_notification_handler handler, json params) {
+    bool start_drain = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return false;
+        }
+        notifications_.emplace_back(std::move(handler), std::move(params));
+        if (!draining_) {
+            draining_ = start_drain = true;
+        }
+    }
+
+    // The queue was empty if nobody drained it, so only this notification is dropped
+    if (start_drain && !post([this]() { drain_notifications(); })) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        notifications_.clear();
+        draining_ = false;
+        return false;
+    }
+    return true;
+}
+
+bool message_dispatcher::post(std::function<void()> task) {
+    std::shared_ptr<thread_pool> executor;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return false;
+        }
+        if (!executor_) {
+            executor_ = std::make_shared<thread_pool>(1);
+        }
+        executor = executor_;
+        ++in_flight_;
+    }
+
+    auto finish = [this]() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--in_flight_ == 0) {
+            idle_cv_.notify_all();
+        }
+    };
+
+    try {
+        executor->enqueue([this, task = std::move(task), finish]() {
+            bool run;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                run = !stopping_;
+            }
+            if (run) {
+                task();
+            }
+            finish();
+        });
+    } catch (const std::exception& e) {
+        LOG_ERROR("Failed to schedule handler: ", e.what());
+        finish();
+        return false;
+    }
+    return true;
+}
+
+void message_dispatcher::handle_request(const json& id, const std::string& method, const json& params, const reply_function& reply) {
+    json message;
+    try {
+        client_request_handler handler;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = request_handlers_.find(method);
+            if (it != request_handlers_.end()) {
+                handler = it->second;
+            }
+        }
+
+        if (handler) {
+            message = response::create_success(id, handler(params)).to_json();
+        } else {
+            LOG_WARNING("Method not found: ", method);
+            message = response::create_error(id, error_code::method_not_found, "Method not found: " + method).to_json();
+        }
+    } catch (const mcp_exception& e) {
+        LOG_ERROR("MCP exception in request handler: ", e.what(), ", code: ", static_cast<int>(e.code()));
+        message = response::create_error(id, e.code(), e.what()).to_json();
+    } catch (const std::exception& e) {
+        LOG_ERROR("Exception in request handler: ", e.what());
+        message = response::create_error(id, error_code::internal_error, "Internal error: " + std::string(e.what())).to_json();
+    } catch (...) {
+        LOG_ERROR("Unknown exception in request handler");
+        message = response::create_error(id, error_code::internal_error, "Unknown internal error").to_json();
+    }
+
+    try {
+        reply(message);
+    } catch (const std::exception& e) {
+        LOG_ERROR("Failed to send response to server request ", method, ": ", e.what());
+    }
+}
+
+void message_dispatcher::drain_notifications() {
+    for (;;) {
+        std::pair<client_notification_handler, json> next;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (notifications_.empty() || stopping_) {
+                draining_ = false;
+                return;
+            }
+            next = std::move(notifications_.front());
+            notifications_.pop_front();
+        }
+
+        try {
+            next.first(next.second);
+        } catch (const std::exception& e) {
+            LOG_ERROR("Exception in notification handler: ", e.what());
+        } catch (...) {
+            LOG_ERROR("Unknown exception in notification handler");
+        }
+    }
+}
+
+} // namespace mcp
@@ -0,0 +1,143 @@
+/**
+ * @file mcp_http_pool.cpp
+ * @brief Implementation of the pool of persistent HTTP connections
+ */
+
+#include "mcp_http_pool.h"
+
+#include <algorithm>
+
+namespace mcp {
+
+http_connection_pool::http_connection_pool(const std::string& scheme_host_port, const configuration& conf)
+    : scheme_host_port_(scheme_host_port), conf_(conf), connects_(std::make_shared<std::atomic<uint64_t>>(0)) {
+    conf_.max_connections = std::max<size_t>(conf_.max_connections, 1);
+}
+
+http_connection_pool::~http_connection_pool() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& client : free_) {
+        client->stop();
+    }
+}
+
+httplib::Result http_connection_pool::post(const std::string& path, const httplib::Headers& headers,
+    const std::string& body, const std::string& content_type) {
+    std::unique_ptr<httplib::Client> client = acquire();
+
+    httplib::Result result;
+    try {
+        result = client->Post(path, headers, body, content_type);
+    } catch (...) {
+        release(std::move(client));
+        throw;
+    }
+
+    release(std::move(client));
+    return result;
+}
+
+void http_connection_pool::set_timeout(int timeout_seconds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    conf_.timeout_seconds = timeout_seconds;
+}
+
+void http_connection_pool::set_max_connections(size_t max_connections) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    conf_.max_connections = std::max<size_t>(max_connections, 1);
+
+    // Close free connections above the new maximum, busy ones are closed when released
+    while (connections_ > conf_.max_connections && !free_.empty()) {
+        free_.front()->stop();
+        free_.erase(free_.begin());
+        --connections_;
+    }
+    free_cv_.notify_all();
+}
+
+http_connection_pool::statistics http_connection_pool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    statistics stats = stats_;
+    stats.connections = connections_;
+    stats.busy = connections_ - free_.size();
+    stats.connects = connects_->load();
+    return stats;
+}
+
+std::unique_ptr<httplib::Client> http_connection_pool::acquire() {
+    std::unique_ptr<httplib::Client> client;
+    int timeout_seconds;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ++stats_.requests;
+
+        if (free_.empty() && connections_ >= conf_.max_connections) {
+            ++stats_.waits;
+            free_cv_.wait(lock, [this] {
+                return !free_.empty() || connections_ < conf_.max_connections;
+            });
+        }
+
+        if (!free_.empty()) {
+            client = std::move(free_.back());
+            free_.pop_back();
+        } else {
+            ++connections_;
+        }
+
+        stats_.peak_busy = std::max(stats_.peak_busy, connections_ - free_.size());
+        timeout_seconds = conf_.timeout_seconds;
+    }
+
+    if (!client) {
+        try {
+            client = create_client();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --connections_;
+            free_cv_.notify_one();
+            throw;
+        }
+    }
+
+    client->set_connection_timeout(timeout_seconds, 0);
+    client->set_read_timeout(timeout_seconds, 0);
+    client->set_write_timeout(timeout_seconds, 0);
+    return client;
+}
+
+void http_connection_pool::release(std::unique_ptr<httplib::Client> client) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (connections_ > conf_.max_connections) {
+        --connections_;
+        client->stop();
+    } else {
+        free_.push_back(std::move(client));
+    }
+    free_cv_.notify_one();
+}
+
+std::unique_ptr<httplib::Client> http_connection_pool::create_client() const {
+    auto client = std::make_unique<httplib::Client>(scheme_host_port_.c_str());
+
+    // Keep the connection open between requests, send small messages without delay
+    client->set_keep_alive(true);
+    client->set_tcp_nodelay(true);
+
+    // Count the connections established, the socket is reused while the server keeps it open
+    auto connects = connects_;
+    client->set_socket_options([connects](socket_t) {
+        ++*connects;
+    });
+
+    #ifdef MCP_SSL
+    client->enable_server_certificate_verification(conf_.validate_certificates);
+    if (!conf_.ca_cert_path.empty()) {
+        client->set_ca_cert_path(conf_.ca_cert_path.c_str());
+    }
+    #endif
+
+    return client;
+}
+
+} // namespace mcp
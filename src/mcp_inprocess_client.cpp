@@ -0,0 +1,309 @@
+/**
+ * @file mcp_inprocess_client.cpp
+ * @brief Implementation of the MCP in-process client
+ */
+
+#include "mcp_inprocess_client.h"
+
+namespace mcp {
+
+inprocess_client::inprocess_client(std::shared_ptr<server> mcp_server, const json& capabilities)
+    : server_(std::move(mcp_server)), capabilities_(capabilities) {
+}
+
+inprocess_client::~inprocess_client() {
+    close();
+}
+
+bool inprocess_client::initialize(const std::string& client_name, const std::string& client_version) {
+    LOG_INFO("Initializing MCP in-process client...");
+
+    if (!server_) {
+        LOG_ERROR("No MCP server to connect to");
+        return false;
+    }
+
+    if (!running_) {
+        std::string session_id = server_->generate_session_id();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            session_id_ = session_id;
+        }
+
+        // Messages the server sends to this session go straight to the dispatcher
+        server_->open_stream_session(session_id, [this](const json& message) {
+            if (deliver_tool_stream(message, dispatcher_)) {
+                return true;
+            }
+            json copy = message;
+            dispatcher_.dispatch(copy, [](const json&) {
+                // The server does not wait for responses to its requests
+            });
+            return true;
+        });
+        running_ = true;
+    }
+
+    json params = {
+        {"protocolVersion", MCP_VERSION},
+        {"capabilities", get_capabilities()},
+        {"clientInfo", {
+            {"name", client_name},
+            {"version", client_version}
+        }}
+    };
+
+    try {
+        json result = send_jsonrpc(make_request("initialize", std::move(params)));
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            server_capabilities_ = std::move(result["capabilities"]);
+        }
+
+        send_notification("initialized");
+        return true;
+    } catch (const std::exception& e) {
+        LOG_ERROR("Initialization failed: ", e.what());
+        close();
+        return false;
+    }
+}
+
+bool inprocess_client::ping() {
+    if (!running_) {
+        return false;
+    }
+
+    try {
+        json result = send_jsonrpc(make_request("ping", json::object()));
+        return result.empty();
+    } catch (...) {
+        return false;
+    }
+}
+
+void inprocess_client::set_capabilities(const json& capabilities) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capabilities_ = capabilities;
+}
+
+response inprocess_client::send_request(const std::string& method, const json& params) {
+    request req = make_request(method, json(params));
+    json id = req.id;
+
+    response res;
+    res.jsonrpc = "2.0";
+    res.result = send_jsonrpc(std::move(req));
+    res.id = std::move(id);
+
+    return res;
+}
+
+response inprocess_client::send_prepared_request(const request& req) {
+    if (req.is_notification()) {
+        throw mcp_exception(error_code::invalid_request, "Request has no ID: " + req.method);
+    }
+
+    response res;
+    res.jsonrpc = "2.0";
+    res.result = send_jsonrpc(request(req));
+    res.id = req.id;
+
+    return res;
+}
+
+bool inprocess_client::cancel_request(const json& id, const std::string& /* reason */) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pending_requests_.find(id);
+    if (it == pending_requests_.end()) {
+        return false;
+    }
+    it->second.cancel();
+    return true;
+}
+
+void inprocess_client::send_notification(const std::string& method, const json& params) {
+    if (!running_) {
+        throw mcp_exception(error_code::internal_error, "Session not open");
+    }
+
+    server_->process_request(request::create_notification(method, params), session_id_);
+}
+
+json inprocess_client::get_server_capabilities() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return server_capabilities_;
+}
+
+json inprocess_client::call_tool(const std::string& tool_name, const json& arguments) {
+    return call_tool(tool_name, json(arguments));
+}
+
+json inprocess_client::call_tool(const std::string& tool_name, json&& arguments) {
+    // The cache builds its key before making the call, the arguments can be moved from then
+    return cached_tool_call(tool_name, arguments, [&]() {
+        json params = json::object();
+        params["name"] = tool_name;
+        params["arguments"] = std::move(arguments);
+        return send_jsonrpc(make_request("tools/call", std::move(params)));
+    });
+}
+
+std::vector<tool> inprocess_client::get_tools() {
+    json response_json = send_jsonrpc(make_request("tools/list", json::object()));
+    std::vector<tool> tools;
+
+    json tools_json;
+    if (response_json.contains("tools") && response_json["tools"].is_array()) {
+        tools_json = std::move(response_json["tools"]);
+    } else if (response_json.is_array()) {
+        tools_json = std::move(response_json);
+    } else {
+        return tools;
+    }
+
+    for (auto& tool_json : tools_json) {
+        tool t;
+        t.name = tool_json["name"];
+        t.description = tool_json["description"];
+
+        if (tool_json.contains("inputSchema")) {
+            t.parameters_schema = std::move(tool_json["inputSchema"]);
+        }
+
+        if (tool_json.contains("annotations") && tool_json["annotations"].is_object()) {
+            t.annotations = std::move(tool_json["annotations"]);
+        }
+
+        tools.push_back(std::move(t));
+    }
+
+    remember_tools(tools);
+    return tools;
+}
+
+json inprocess_client::get_capabilities() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return capabilities_;
+}
+
+json inprocess_client::list_resources(const std::string& cursor) {
+    json params = json::object();
+    if (!cursor.empty()) {
+        params["cursor"] = cursor;
+    }
+    return send_jsonrpc(make_request("resources/list", std::move(params)));
+}
+
+json inprocess_client::read_resource(const std::string& resource_uri) {
+    return send_jsonrpc(make_request("resources/read", {
+        {"uri", resource_uri}
+    }));
+}
+
+json inprocess_client::read_resource_range(const std::string& resource_uri, int64_t offset, std::optional<uint64_t> length) {
+    json params = {
+        {"uri", resource_uri},
+        {"offset", offset}
+    };
+    if (length) {
+        params["length"] = *length;
+    }
+    return send_jsonrpc(make_request("resources/read", std::move(params)));
+}
+
+json inprocess_client::subscribe_to_resource(const std::string& resource_uri) {
+    return send_jsonrpc(make_request("resources/subscribe", {
+        {"uri", resource_uri}
+    }));
+}
+
+json inprocess_client::list_resource_templates() {
+    return send_jsonrpc(make_request("resources/templates/list", json::object()));
+}
+
+bool inprocess_client::is_running() const {
+    return running_;
+}
+
+std::string inprocess_client::get_session_id() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return session_id_;
+}
+
+void inprocess_client::register_request_handler(const std::string& method, client_request_handler handler) {
+    dispatcher_.register_request_handler(method, std::move(handler));
+}
+
+void inprocess_client::register_notification_handler(const std::string& method, client_notification_handler handler) {
+    dispatcher_.register_notification_handler(method, std::move(handler));
+}
+
+void inprocess_client::set_executor(std::shared_ptr<thread_pool> executor) {
+    dispatcher_.set_executor(std::move(executor));
+}
+
+request inprocess_client::make_request(const std::string& method, json&& params) {
+    request req = request::create(method, json());
+    req.params = std::move(params);
+    return req;
+}
+
+json inprocess_client::send_jsonrpc(request&& req) {
+    if (!running_) {
+        throw mcp_exception(error_code::internal_error, "Session not open");
+    }
+
+    // Handlers see the deadline of the call and cancel_request() through cancellation_token::current()
+    std::optional<std::chrono::milliseconds> timeout = req.timeout();
+    cancellation_token token = timeout ? cancellation_token(std::chrono::steady_clock::now() + *timeout) : cancellation_token();
+    if (!req.is_notification()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!pending_requests_.emplace(req.id, token).second) {
+            throw mcp_exception(error_code::invalid_request, "Request ID already in use: " + req.id.dump());
+        }
+    }
+
+    json response;
+    try {
+        cancellation_token::scope current(token);
+        response = server_->process_request(req, session_id_);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_requests_.erase(req.id);
+        throw;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_requests_.erase(req.id);
+    }
+    if (token.is_cancel_requested()) {
+        throw mcp_exception(error_code::internal_error, "Request cancelled");
+    }
+
+    auto error = response.find("error");
+    if (error != response.end() && error->is_object()) {
+        int code = error->contains("code") ? (*error)["code"].get<int>() : static_cast<int>(error_code::internal_error);
+        std::string message = error->value("message", "");
+        throw mcp_exception(static_cast<error_code>(code), message);
+    }
+
+    auto result = response.find("result");
+    if (result == response.end()) {
+        return json::object();
+    }
+    return std::move(*result);
+}
+
+void inprocess_client::close() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    // The server may still deliver messages to this session until it is removed
+    server_->close_stream_session(session_id_);
+    LOG_INFO("In-process session closed: ", session_id_);
+}
+
+} // namespace mcp
@@ -0,0 +1,334 @@
+/**
+ * @file mcp_io_reactor.cpp
+ * @brief Implementation of the shared I/O reactor
+ *
+ * Uses epoll with EPOLLONESHOT on Linux, so that several threads can wait on
+ * one epoll instance while each descriptor is handled by one thread at a time.
+ * Other POSIX platforms use a single thread running poll().
+ */
+
+#if !defined(_WIN32)
+
+#include "mcp_io_reactor.h"
+#include "mcp_logger.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#define MCP_IO_REACTOR_EPOLL 1
+#endif
+
+namespace mcp {
+
+struct io_reactor::registration {
+    int fd = -1;
+    uint64_t id = 0;
+    handler callback;
+
+    // Guards the fields below
+    std::mutex mutex;
+    std::condition_variable idle;
+    uint32_t interest = 0;
+    bool running = false;
+    bool removed = false;
+};
+
+namespace {
+
+// Registration whose handler runs on the current thread
+thread_local const void* current_registration = nullptr;
+
+} // namespace
+
+io_reactor::io_reactor(size_t thread_count) {
+#if defined(MCP_IO_REACTOR_EPOLL)
+    poll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (poll_fd_ == -1) {
+        throw mcp_exception(error_code::internal_error, std::string("Failed to create epoll instance: ") + strerror(errno));
+    }
+
+    wakeup_fd_[0] = wakeup_fd_[1] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeup_fd_[0] == -1) {
+        close(poll_fd_);
+        throw mcp_exception(error_code::internal_error, std::string("Failed to create eventfd: ") + strerror(errno));
+    }
+
+    // Level-triggered and never drained: once signalled it wakes every thread
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = 0;
+    epoll_ctl(poll_fd_, EPOLL_CTL_ADD, wakeup_fd_[0], &ev);
+#else
+    if (pipe(wakeup_fd_) == -1) {
+        throw mcp_exception(error_code::internal_error, std::string("Failed to create wakeup pipe: ") + strerror(errno));
+    }
+    for (int fd : wakeup_fd_) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+
+    // poll() cannot be shared between threads
+    thread_count = 1;
+#endif
+
+    thread_count = std::max<size_t>(thread_count, 1);
+    for (size_t i = 0; i < thread_count; ++i) {
+        threads_.emplace_back(&io_reactor::run, this);
+    }
+}
+
+io_reactor::~io_reactor() {
+    stopping_ = true;
+    wakeup();
+
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    close(wakeup_fd_[0]);
+    if (wakeup_fd_[1] != wakeup_fd_[0]) {
+        close(wakeup_fd_[1]);
+    }
+    if (poll_fd_ != -1) {
+        close(poll_fd_);
+    }
+}
+
+void io_reactor::add(int fd, uint32_t interest, handler h) {
+    auto reg = std::make_shared<registration>();
+    reg->fd = fd;
+    reg->callback = std::move(h);
+    reg->interest = interest;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ids_.find(fd) != ids_.end()) {
+            throw mcp_exception(error_code::internal_error, "Descriptor already registered: " + std::to_string(fd));
+        }
+        reg->id = next_id_++;
+        ids_[fd] = reg->id;
+        registrations_[reg->id] = reg;
+    }
+
+#if defined(MCP_IO_REACTOR_EPOLL)
+    if (!arm(*reg, true)) {
+        int err = errno;
+        std::lock_guard<std::mutex> lock(mutex_);
+        ids_.erase(fd);
+        registrations_.erase(reg->id);
+        throw mcp_exception(error_code::internal_error, std::string("Failed to watch descriptor: ") + strerror(err));
+    }
+#else
+    wakeup();
+#endif
+}
+
+void io_reactor::modify(int fd, uint32_t interest) {
+    std::shared_ptr<registration> reg;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = ids_.find(fd);
+        if (it == ids_.end()) {
+            return;
+        }
+        reg = registrations_[it->second];
+    }
+
+    std::lock_guard<std::mutex> lock(reg->mutex);
+    reg->interest = interest;
+
+    // A running handler re-arms the descriptor with the new interest when it returns
+    if (!reg->running && !reg->removed) {
+#if defined(MCP_IO_REACTOR_EPOLL)
+        if (!arm(*reg, false)) {
+            LOG_ERROR("Failed to re-arm descriptor ", fd, ": ", strerror(errno));
+        }
+#else
+        wakeup();
+#endif
+    }
+}
+
+void io_reactor::remove(int fd) {
+    std::shared_ptr<registration> reg;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = ids_.find(fd);
+        if (it == ids_.end()) {
+            return;
+        }
+        auto reg_it = registrations_.find(it->second);
+        reg = reg_it->second;
+        registrations_.erase(reg_it);
+        ids_.erase(it);
+    }
+
+    std::unique_lock<std::mutex> lock(reg->mutex);
+    reg->removed = true;
+
+#if defined(MCP_IO_REACTOR_EPOLL)
+    epoll_ctl(poll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+#else
+    wakeup();
+#endif
+
+    if (current_registration != reg.get()) {
+        reg->idle.wait(lock, [&reg]() { return !reg->running; });
+    }
+}
+
+size_t io_reactor::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return registrations_.size();
+}
+
+void io_reactor::run() {
+#if defined(MCP_IO_REACTOR_EPOLL)
+    epoll_event events[16];
+
+    while (!stopping_) {
+        int count = epoll_wait(poll_fd_, events, 16, -1);
+        if (count == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("epoll_wait failed: ", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < count && !stopping_; ++i) {
+            if (events[i].data.u64 == 0) {
+                continue; // Wakeup
+            }
+
+            std::shared_ptr<registration> reg;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = registrations_.find(events[i].data.u64);
+                if (it == registrations_.end()) {
+                    continue;
+                }
+                reg = it->second;
+            }
+
+            uint32_t mask = 0;
+            if (events[i].events & EPOLLIN) mask |= readable;
+            if (events[i].events & EPOLLOUT) mask |= writable;
+            if (events[i].events & (EPOLLHUP | EPOLLRDHUP)) mask |= hangup;
+            if (events[i].events & EPOLLERR) mask |= error;
+
+            dispatch(reg, mask);
+        }
+    }
+#else
+    std::vector<pollfd> fds;
+    std::vector<std::shared_ptr<registration>> regs;
+
+    while (!stopping_) {
+        fds.clear();
+        regs.clear();
+        fds.push_back({wakeup_fd_[0], POLLIN, 0});
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& [id, reg] : registrations_) {
+                std::lock_guard<std::mutex> reg_lock(reg->mutex);
+                short events = ((reg->interest & readable) ? POLLIN : 0) | ((reg->interest & writable) ? POLLOUT : 0);
+                fds.push_back({reg->fd, events, 0});
+                regs.push_back(reg);
+            }
+        }
+
+        if (poll(fds.data(), fds.size(), -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("poll failed: ", strerror(errno));
+            break;
+        }
+
+        if (fds[0].revents != 0) {
+            char drain[64];
+            while (read(wakeup_fd_[0], drain, sizeof(drain)) > 0) {
+            }
+        }
+
+        for (size_t i = 1; i < fds.size() && !stopping_; ++i) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+
+            uint32_t mask = 0;
+            if (fds[i].revents & POLLIN) mask |= readable;
+            if (fds[i].revents & POLLOUT) mask |= writable;
+            if (fds[i].revents & POLLHUP) mask |= hangup;
+            if (fds[i].revents & (POLLERR | POLLNVAL)) mask |= error;
+
+            dispatch(regs[i - 1], mask);
+        }
+    }
+#endif
+}
+
+void io_reactor::dispatch(const std::shared_ptr<registration>& reg, uint32_t events) {
+    {
+        std::lock_guard<std::mutex> lock(reg->mutex);
+        if (reg->removed) {
+            return;
+        }
+        reg->running = true;
+    }
+
+    current_registration = reg.get();
+    try {
+        reg->callback(events);
+    } catch (const std::exception& e) {
+        LOG_ERROR("I/O handler failed: ", e.what());
+    } catch (...) {
+        LOG_ERROR("I/O handler failed with unknown exception");
+    }
+    current_registration = nullptr;
+
+    std::lock_guard<std::mutex> lock(reg->mutex);
+    reg->running = false;
+#if defined(MCP_IO_REACTOR_EPOLL)
+    if (!reg->removed && !arm(*reg, false)) {
+        LOG_ERROR("Failed to re-arm descriptor ", reg->fd, ": ", strerror(errno));
+    }
+#endif
+    reg->idle.notify_all();
+}
+
+bool io_reactor::arm(const registration& reg, bool add) {
+#if defined(MCP_IO_REACTOR_EPOLL)
+    epoll_event ev{};
+    ev.events = EPOLLONESHOT | ((reg.interest & readable) ? EPOLLIN : 0u) | ((reg.interest & writable) ? EPOLLOUT : 0u);
+    ev.data.u64 = reg.id;
+    return epoll_ctl(poll_fd_, add ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, reg.fd, &ev) == 0;
+#else
+    (void)reg;
+    (void)add;
+    return true;
+#endif
+}
+
+void io_reactor::wakeup() {
+    uint64_t one = 1;
+    if (write(wakeup_fd_[1], &one, sizeof(one)) == -1 && errno != EAGAIN) {
+        LOG_WARNING("Failed to wake up I/O reactor: ", strerror(errno));
+    }
+}
+
+} // namespace mcp
+
+#endif // !_WIN32
@@ -7,6 +7,7 @@
  */
 
 #include "mcp_message.h"
+#include <algorithm>
 #include <random>
 #include <sstream>
 
@@ -14,4 +15,40 @@ namespace mcp {
 
 // Implementation of any protocol-related functions
 
+void dump_canonical_to(std::string& out, const json& j) {
+    if (j.is_object()) {
+        std::vector<json::const_iterator> members;
+        members.reserve(j.size());
+        for (auto it = j.begin(); it != j.end(); ++it) {
+            members.push_back(it);
+        }
+        std::sort(members.begin(), members.end(), [](const json::const_iterator& a, const json::const_iterator& b) {
+            return a.key() < b.key();
+        });
+
+        out += '{';
+        for (size_t i = 0; i < members.size(); ++i) {
+            if (i > 0) {
+                out += ',';
+            }
+            const std::string& key = members[i].key();
+            dump_string_to(out, key.data(), key.size());
+            out += ':';
+            dump_canonical_to(out, members[i].value());
+        }
+        out += '}';
+    } else if (j.is_array()) {
+        out += '[';
+        for (size_t i = 0; i < j.size(); ++i) {
+            if (i > 0) {
+                out += ',';
+            }
+            dump_canonical_to(out, j[i]);
+        }
+        out += ']';
+    } else {
+        dump_to(out, j);
+    }
+}
+
 } // namespace mcp
\ No newline at end of file
@@ -14,17 +14,143 @@
 #include <chrono>
 #include <ctime>
 #include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <tuple>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
 
 namespace fs = std::filesystem;
 
 namespace mcp {
 
+namespace {
+
+// Shared empty snapshots so that a resource never holds a null buffer
+const text_buffer& empty_text() {
+    static const text_buffer empty = std::make_shared<const std::string>();
+    return empty;
+}
+
+const binary_buffer& empty_data() {
+    static const binary_buffer empty = std::make_shared<const std::vector<uint8_t>>();
+    return empty;
+}
+
+bool is_utf8_continuation(char c) {
+    return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+// Shrink [begin, end) of data so that it neither starts nor ends inside a UTF-8 sequence.
+// The byte at end (if any) must be available to detect a split sequence.
+std::pair<size_t, size_t> snap_utf8(const char* data, size_t size, size_t begin, size_t end) {
+    while (begin < end && is_utf8_continuation(data[begin])) {
+        ++begin;
+    }
+    while (end > begin && end < size && is_utf8_continuation(data[end])) {
+        --end;
+    }
+    return {begin, end};
+}
+
+json range_metadata(uint64_t begin, uint64_t end, uint64_t total) {
+    return {
+        {"offset", begin},
+        {"length", end - begin},
+        {"total", total}
+    };
+}
+
+// Append ,"range":{...} to a content object that is being serialized
+void write_range_metadata(std::string& out, uint64_t begin, uint64_t end, uint64_t total) {
+    out += ",\"range\":";
+    dump_to(out, range_metadata(begin, end, total));
+}
+
+// Append the common {"uri":...,"mimeType":...,"<key>": prefix of a content object
+void write_content_prefix(std::string& out, const std::string& uri, const std::string& mime_type, const char* key) {
+    out += "{\"uri\":";
+    dump_string_to(out, uri.data(), uri.size());
+    out += ",\"mimeType\":";
+    dump_string_to(out, mime_type.data(), mime_type.size());
+    out += ",\"";
+    out += key;
+    out += "\":";
+}
+
+} // namespace
+
+// resource_range implementation
+std::pair<uint64_t, uint64_t> resource_range::resolve(uint64_t total) const {
+    uint64_t begin;
+    if (offset < 0) {
+        // -(offset + 1) + 1 avoids overflow for INT64_MIN
+        uint64_t back = static_cast<uint64_t>(-(offset + 1)) + 1;
+        begin = back >= total ? 0 : total - back;
+    } else {
+        begin = std::min<uint64_t>(static_cast<uint64_t>(offset), total);
+    }
+    
+    uint64_t end = length ? begin + std::min<uint64_t>(*length, total - begin) : total;
+    return {begin, end};
+}
+
+std::optional<resource_range> resource_range::from_params(const json& params) {
+    if (!params.contains("offset") && !params.contains("length")) {
+        return std::nullopt;
+    }
+    
+    resource_range range;
+    if (params.contains("offset")) {
+        if (!params["offset"].is_number_integer()) {
+            throw mcp_exception(error_code::invalid_params, "Expected integer for 'offset' parameter");
+        }
+        range.offset = params["offset"].get<int64_t>();
+    }
+    if (params.contains("length")) {
+        if (!params["length"].is_number_integer() || params["length"].get<int64_t>() < 0) {
+            throw mcp_exception(error_code::invalid_params, "Expected non-negative integer for 'length' parameter");
+        }
+        range.length = params["length"].get<uint64_t>();
+    }
+    
+    return range;
+}
+
+// resource implementation
+json resource::read_range(const resource_range& range) const {
+    json content = read();
+    
+    if (content.contains("text") && content["text"].is_string()) {
+        std::string& text = content["text"].get_ref<std::string&>();
+        auto [begin, end] = range.resolve(text.size());
+        std::tie(begin, end) = snap_utf8(text.data(), text.size(), begin, end);
+        
+        content["range"] = range_metadata(begin, end, text.size());
+        text = text.substr(begin, end - begin);
+    } else if (content.contains("blob") && content["blob"].is_string()) {
+        std::vector<uint8_t> data = base64_codec::decode(content["blob"].get_ref<const std::string&>());
+        auto [begin, end] = range.resolve(data.size());
+        
+        content["range"] = range_metadata(begin, end, data.size());
+        content["blob"] = base64_codec::encode(data.data() + begin, end - begin);
+    }
+    
+    return content;
+}
+
 // text_resource implementation
 text_resource::text_resource(const std::string& uri, 
                            const std::string& name, 
                            const std::string& mime_type,
                            const std::string& description)
-    : uri_(uri), name_(name), mime_type_(mime_type), description_(description), modified_(false) {
+    : uri_(uri), name_(name), mime_type_(mime_type), description_(description), text_(empty_text()), modified_(false) {
 }
 
 json text_resource::get_metadata() const {
@@ -38,13 +164,48 @@ json text_resource::get_metadata() const {
 
 json text_resource::read() const {
     modified_ = false;
+    text_buffer text = text_.load();
+    return {
+        {"uri", uri_},
+        {"mimeType", mime_type_},
+        {"text", *text}
+    };
+}
+
+void text_resource::write_content(std::string& out) const {
+    modified_ = false;
+    
+    // Serialized from a handle, writers need not wait for it
+    text_buffer text = text_.load();
+    write_content_prefix(out, uri_, mime_type_, "text");
+    dump_string_to(out, text->data(), text->size());
+    out += '}';
+}
+
+json text_resource::read_range(const resource_range& range) const {
+    text_buffer text = text_.load();
+    auto [begin, end] = range.resolve(text->size());
+    std::tie(begin, end) = snap_utf8(text->data(), text->size(), begin, end);
+    
     return {
         {"uri", uri_},
         {"mimeType", mime_type_},
-        {"text", text_}
+        {"text", text->substr(begin, end - begin)},
+        {"range", range_metadata(begin, end, text->size())}
     };
 }
 
+void text_resource::write_content(std::string& out, const resource_range& range) const {
+    text_buffer text = text_.load();
+    auto [begin, end] = range.resolve(text->size());
+    std::tie(begin, end) = snap_utf8(text->data(), text->size(), begin, end);
+    
+    write_content_prefix(out, uri_, mime_type_, "text");
+    dump_string_to(out, text->data() + begin, end - begin);
+    write_range_metadata(out, begin, end, text->size());
+    out += '}';
+}
+
 bool text_resource::is_modified() const {
     return modified_;
 }
@@ -54,14 +215,32 @@ std::string text_resource::get_uri() const {
 }
 
 void text_resource::set_text(const std::string& text) {
-    if (text_ != text) {
-        text_ = text;
-        modified_ = true;
+    if (*text_.load() != text) {
+        store_text(std::make_shared<const std::string>(text));
     }
 }
 
+void text_resource::set_text(std::string&& text) {
+    if (*text_.load() != text) {
+        store_text(std::make_shared<const std::string>(std::move(text)));
+    }
+}
+
+void text_resource::set_text_buffer(text_buffer buffer) {
+    store_text(buffer ? std::move(buffer) : empty_text());
+}
+
 std::string text_resource::get_text() const {
-    return text_;
+    return *text_.load();
+}
+
+text_buffer text_resource::get_text_buffer() const {
+    return text_.load();
+}
+
+void text_resource::store_text(text_buffer buffer) const {
+    text_.store(std::move(buffer));
+    modified_ = true;
 }
 
 // binary_resource implementation
@@ -69,7 +248,7 @@ binary_resource::binary_resource(const std::string& uri,
                                const std::string& name, 
                                const std::string& mime_type,
                                const std::string& description)
-    : uri_(uri), name_(name), mime_type_(mime_type), description_(description), modified_(false) {
+    : uri_(uri), name_(name), mime_type_(mime_type), description_(description), data_(empty_data()), modified_(false) {
 }
 
 json binary_resource::get_metadata() const {
@@ -84,17 +263,56 @@ json binary_resource::get_metadata() const {
 json binary_resource::read() const {
     modified_ = false;
     
-    // Base64 encode the binary data
-    std::string base64_data;
-    if (!data_.empty()) {
-        base64_data = base64::encode(reinterpret_cast<const char*>(data_.data()), data_.size());
-    }
+    json result = {
+        {"uri", uri_},
+        {"mimeType", mime_type_},
+        {"blob", ""}
+    };
     
-    return {
+    // Base64 encode the binary data straight into the JSON string
+    binary_buffer data = data_.load();
+    std::string& blob = result["blob"].get_ref<std::string&>();
+    base64_codec::encode_append(data->data(), data->size(), blob);
+    
+    return result;
+}
+
+void binary_resource::write_content(std::string& out) const {
+    modified_ = false;
+    
+    // The base64 alphabet needs no JSON escaping
+    binary_buffer data = data_.load();
+    write_content_prefix(out, uri_, mime_type_, "blob");
+    out += '"';
+    base64_codec::encode_append(data->data(), data->size(), out);
+    out += "\"}";
+}
+
+json binary_resource::read_range(const resource_range& range) const {
+    json result = {
         {"uri", uri_},
         {"mimeType", mime_type_},
-        {"blob", base64_data}
+        {"blob", ""}
     };
+    
+    binary_buffer data = data_.load();
+    auto [begin, end] = range.resolve(data->size());
+    base64_codec::encode_append(data->data() + begin, end - begin, result["blob"].get_ref<std::string&>());
+    result["range"] = range_metadata(begin, end, data->size());
+    
+    return result;
+}
+
+void binary_resource::write_content(std::string& out, const resource_range& range) const {
+    binary_buffer data = data_.load();
+    auto [begin, end] = range.resolve(data->size());
+    
+    write_content_prefix(out, uri_, mime_type_, "blob");
+    out += '"';
+    base64_codec::encode_append(data->data() + begin, end - begin, out);
+    out += '"';
+    write_range_metadata(out, begin, end, data->size());
+    out += '}';
 }
 
 bool binary_resource::is_modified() const {
@@ -106,15 +324,24 @@ std::string binary_resource::get_uri() const {
 }
 
 void binary_resource::set_data(const uint8_t* data, size_t size) {
-    data_.resize(size);
-    if (size > 0) {
-        std::memcpy(data_.data(), data, size);
-    }
+    set_data_buffer(std::make_shared<const std::vector<uint8_t>>(data, data + size));
+}
+
+void binary_resource::set_data(std::vector<uint8_t>&& data) {
+    set_data_buffer(std::make_shared<const std::vector<uint8_t>>(std::move(data)));
+}
+
+void binary_resource::set_data_buffer(binary_buffer buffer) {
+    data_.store(buffer ? std::move(buffer) : empty_data());
     modified_ = true;
 }
 
-const std::vector<uint8_t>& binary_resource::get_data() const {
-    return data_;
+std::vector<uint8_t> binary_resource::get_data() const {
+    return *data_.load();
+}
+
+binary_buffer binary_resource::get_data_buffer() const {
+    return data_.load();
 }
 
 // file_resource implementation
@@ -126,7 +353,7 @@ file_resource::file_resource(const std::string& file_path,
                    mime_type.empty() ? guess_mime_type(file_path) : mime_type,
                    description),
       file_path_(file_path),
-      last_modified_(0) {
+      loaded_(std::make_shared<const file_snapshot>(file_snapshot{empty_text(), file_stamp()})) {
     
     // Check if file exists
     if (!fs::exists(file_path_)) {
@@ -136,39 +363,214 @@ file_resource::file_resource(const std::string& file_path,
 }
 
 json file_resource::read() const {
-    // Read file content
-    std::ifstream file(file_path_, std::ios::binary);
+    auto loaded = reload();
+    modified_ = false;
+    return {
+        {"uri", uri_},
+        {"mimeType", mime_type_},
+        {"text", *loaded->text}
+    };
+}
+
+void file_resource::write_content(std::string& out) const {
+    auto loaded = reload();
+    modified_ = false;
+    
+    write_content_prefix(out, uri_, mime_type_, "text");
+    dump_string_to(out, loaded->text->data(), loaded->text->size());
+    out += '}';
+}
+
+bool file_resource::stat_file(file_stamp& stamp) const {
+    // File systems store mtime in coarse ticks, so a rewrite within the same tick
+    // keeps the mtime; such recent stamps are not trusted to detect changes.
+    constexpr int64_t mtime_tick_ns = 2000000000;
+    
+#ifdef _WIN32
+    std::error_code ec;
+    auto modified = fs::last_write_time(file_path_, ec);
+    if (ec) {
+        return false;
+    }
+    uint64_t size = fs::file_size(file_path_, ec);
+    if (ec) {
+        return false;
+    }
+    
+    stamp.mtime_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(modified.time_since_epoch()).count();
+    stamp.size = size;
+    stamp.inode = 0;
+    stamp.device = 0;
+    stamp.settled = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        fs::file_time_type::clock::now() - modified).count() >= mtime_tick_ns;
+#else
+    struct stat st;
+    if (::stat(file_path_.c_str(), &st) != 0) {
+        return false;
+    }
+    
+#ifdef __APPLE__
+    const struct timespec& mtime = st.st_mtimespec;
+#else
+    const struct timespec& mtime = st.st_mtim;
+#endif
+    stamp.mtime_ns = static_cast<int64_t>(mtime.tv_sec) * 1000000000 + mtime.tv_nsec;
+    stamp.size = static_cast<uint64_t>(st.st_size);
+    stamp.inode = static_cast<uint64_t>(st.st_ino);
+    stamp.device = static_cast<uint64_t>(st.st_dev);
+    stamp.settled = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count() - stamp.mtime_ns >= mtime_tick_ns;
+#endif
+    return true;
+}
+
+std::shared_ptr<const file_resource::file_snapshot> file_resource::reload() const {
+    // Unchanged files are served from the current snapshot, reads then take no writer lock.
+    // The stamp is taken before reading, so a change during the read is picked up next time.
+    file_stamp current;
+    bool known = stat_file(current);
+    auto last = loaded_.load();
+    if (known && last->stamp.settled && last->stamp.same_file(current)) {
+        return last;
+    }
+    
+    // Read file content straight into the string that becomes the new snapshot
+    std::ifstream file(file_path_, std::ios::binary | std::ios::ate);
     if (!file) {
         throw mcp_exception(error_code::internal_error, 
                            "Failed to open file: " + file_path_);
     }
     
-    std::stringstream buffer;
-    buffer << file.rdbuf();
+    std::string content(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(&content[0], static_cast<std::streamsize>(content.size()));
+    content.resize(static_cast<size_t>(file.gcount()));
     
-    // Update text content
-    const_cast<file_resource*>(this)->set_text(buffer.str());
+    // The stamp is only trusted if the read started a full mtime tick after the last write:
+    // a rewrite within the same tick could follow the read and keep mtime and size. Once the
+    // tick has passed, one more read gives a trusted stamp. A file that changed during the
+    // read gets an empty stamp and is reloaded next time.
+    file_stamp after;
+    bool unchanged = known && stat_file(after) && after.same_file(current);
+    file_stamp stamp = unchanged ? current : file_stamp();
     
-    // Update last modified time
-    last_modified_ = fs::last_write_time(file_path_).time_since_epoch().count();
+    // Content and stamp are published as one value, so racing reloads cannot pair
+    // older content with a newer stamp
+    auto loaded = std::make_shared<const file_snapshot>(file_snapshot{
+        std::make_shared<const std::string>(std::move(content)),
+        stamp
+    });
     
-    // Mark as not modified after read
-    modified_ = false;
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+    loaded_.store(loaded);
+    store_text(loaded->text);
+    return loaded;
+}
+
+json file_resource::read_range(const resource_range& range) const {
+    uint64_t begin = 0;
+    uint64_t total = 0;
+    std::string slice = read_slice(range, begin, total);
+    uint64_t end = begin + slice.size();
     
     return {
         {"uri", uri_},
         {"mimeType", mime_type_},
-        {"text", text_}
+        {"text", std::move(slice)},
+        {"range", range_metadata(begin, end, total)}
     };
 }
 
+void file_resource::write_content(std::string& out, const resource_range& range) const {
+    uint64_t begin = 0;
+    uint64_t total = 0;
+    std::string slice = read_slice(range, begin, total);
+    
+    write_content_prefix(out, uri_, mime_type_, "text");
+    dump_string_to(out, slice.data(), slice.size());
+    write_range_metadata(out, begin, begin + slice.size(), total);
+    out += '}';
+}
+
+std::string file_resource::read_slice(const resource_range& range, uint64_t& begin, uint64_t& total) const {
+    std::string slice;
+    uint64_t end = 0;
+    
+#ifdef _WIN32
+    std::ifstream file(file_path_, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw mcp_exception(error_code::internal_error, 
+                           "Failed to open file: " + file_path_);
+    }
+    
+    total = static_cast<uint64_t>(file.tellg());
+    std::tie(begin, end) = range.resolve(total);
+    
+    // One extra byte past the end to detect a split UTF-8 sequence
+    slice.resize(static_cast<size_t>((end < total ? end + 1 : end) - begin));
+    file.seekg(static_cast<std::streamoff>(begin));
+    file.read(&slice[0], static_cast<std::streamsize>(slice.size()));
+    slice.resize(static_cast<size_t>(file.gcount()));
+#else
+    int fd = ::open(file_path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw mcp_exception(error_code::internal_error, 
+                           "Failed to open file: " + file_path_);
+    }
+    
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw mcp_exception(error_code::internal_error, 
+                           "Failed to stat file: " + file_path_);
+    }
+    
+    total = static_cast<uint64_t>(st.st_size);
+    std::tie(begin, end) = range.resolve(total);
+    
+    // One extra byte past the end to detect a split UTF-8 sequence
+    slice.resize(static_cast<size_t>((end < total ? end + 1 : end) - begin));
+    size_t received = 0;
+    while (received < slice.size()) {
+        ssize_t n = ::pread(fd, &slice[received], slice.size() - received, static_cast<off_t>(begin + received));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            int error = errno;
+            ::close(fd);
+            throw mcp_exception(error_code::internal_error, 
+                               "Failed to read file: " + file_path_ + ": " + std::strerror(error));
+        }
+        if (n == 0) {
+            break; // File was truncated concurrently
+        }
+        received += static_cast<size_t>(n);
+    }
+    ::close(fd);
+    slice.resize(received);
+#endif
+    
+    auto [slice_begin, slice_end] = snap_utf8(slice.data(), slice.size(), 0,
+                                              std::min<size_t>(slice.size(), static_cast<size_t>(end - begin)));
+    begin += slice_begin;
+    slice.erase(slice_end);
+    slice.erase(0, slice_begin);
+    return slice;
+}
+
 bool file_resource::is_modified() const {
     if (!fs::exists(file_path_)) {
         return true; // File was deleted
     }
     
-    time_t current_modified = fs::last_write_time(file_path_).time_since_epoch().count();
-    return current_modified != last_modified_;
+    file_stamp current;
+    if (!stat_file(current)) {
+        return true;
+    }
+    
+    auto last = loaded_.load();
+    return !last->stamp.settled || !last->stamp.same_file(current);
 }
 
 std::string file_resource::guess_mime_type(const std::string& file_path) {
@@ -214,39 +616,63 @@ std::string file_resource::guess_mime_type(const std::string& file_path) {
 }
 
 // resource_manager implementation
-static std::mutex g_resource_manager_mutex;
+struct alignas(64) resource_manager::shard {
+    mutable std::shared_mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<resource>> resources;
+    std::unordered_map<int64_t, std::pair<std::string, std::function<void(const std::string&)>>> subscriptions;
+};
+
+resource_manager::resource_manager(size_t shard_count)
+    : shards_(new shard[std::max<size_t>(shard_count, 1)])
+    , shard_count_(std::max<size_t>(shard_count, 1)) {
+}
+
+resource_manager::~resource_manager() = default;
 
 resource_manager& resource_manager::instance() {
     static resource_manager instance;
     return instance;
 }
 
+resource_manager::shard& resource_manager::shard_for(const std::string& uri) const {
+    return shards_[std::hash<std::string>()(uri) % shard_count_];
+}
+
 void resource_manager::register_resource(std::shared_ptr<resource> resource) {
     if (!resource) {
         throw mcp_exception(error_code::invalid_params, "Cannot register null resource");
     }
     
     std::string uri = resource->get_uri();
+    register_resource(uri, std::move(resource));
+}
+
+void resource_manager::register_resource(const std::string& uri, std::shared_ptr<resource> resource) {
+    if (!resource) {
+        throw mcp_exception(error_code::invalid_params, "Cannot register null resource");
+    }
     
-    std::lock_guard<std::mutex> lock(g_resource_manager_mutex);
-    resources_[uri] = resource;
+    shard& s = shard_for(uri);
+    std::unique_lock<std::shared_mutex> lock(s.mutex);
+    s.resources[uri] = std::move(resource);
 }
 
 bool resource_manager::unregister_resource(const std::string& uri) {
-    std::lock_guard<std::mutex> lock(g_resource_manager_mutex);
+    shard& s = shard_for(uri);
+    std::unique_lock<std::shared_mutex> lock(s.mutex);
     
-    auto it = resources_.find(uri);
-    if (it == resources_.end()) {
+    auto it = s.resources.find(uri);
+    if (it == s.resources.end()) {
         return false;
     }
     
-    resources_.erase(it);
+    s.resources.erase(it);
     
-    // Remove any subscriptions for this resource
-    auto sub_it = subscriptions_.begin();
-    while (sub_it != subscriptions_.end()) {
+    // Remove any subscriptions for this resource (they live in the same shard)
+    auto sub_it = s.subscriptions.begin();
+    while (sub_it != s.subscriptions.end()) {
         if (sub_it->second.first == uri) {
-            sub_it = subscriptions_.erase(sub_it);
+            sub_it = s.subscriptions.erase(sub_it);
         } else {
             ++sub_it;
         }
@@ -256,10 +682,11 @@ bool resource_manager::unregister_resource(const std::string& uri) {
 }
 
 std::shared_ptr<resource> resource_manager::get_resource(const std::string& uri) const {
-    std::lock_guard<std::mutex> lock(g_resource_manager_mutex);
+    const shard& s = shard_for(uri);
+    std::shared_lock<std::shared_mutex> lock(s.mutex);
     
-    auto it = resources_.find(uri);
-    if (it == resources_.end()) {
+    auto it = s.resources.find(uri);
+    if (it == s.resources.end()) {
         return nullptr;
     }
     
@@ -267,11 +694,20 @@ std::shared_ptr<resource> resource_manager::get_resource(const std::string& uri)
 }
 
 json resource_manager::list_resources() const {
-    std::lock_guard<std::mutex> lock(g_resource_manager_mutex);
+    // Collect the resources first so that no lock is held while reading metadata
+    std::vector<std::pair<std::string, std::shared_ptr<resource>>> entries;
+    for (size_t i = 0; i < shard_count_; ++i) {
+        std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+        entries.insert(entries.end(), shards_[i].resources.begin(), shards_[i].resources.end());
+    }
+    
+    std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
     
     json resources = json::array();
     
-    for (const auto& [uri, res] : resources_) {
+    for (const auto& [uri, res] : entries) {
         resources.push_back(res->get_metadata());
     }
     
@@ -280,56 +716,67 @@ json resource_manager::list_resources() const {
     };
 }
 
-int resource_manager::subscribe(const std::string& uri, std::function<void(const std::string&)> callback) {
+int64_t resource_manager::subscribe(const std::string& uri, std::function<void(const std::string&)> callback) {
     if (!callback) {
         throw mcp_exception(error_code::invalid_params, "Cannot subscribe with null callback");
     }
     
-    std::lock_guard<std::mutex> lock(g_resource_manager_mutex);
+    const size_t index = std::hash<std::string>()(uri) % shard_count_;
+    shard& s = shards_[index];
+    std::unique_lock<std::shared_mutex> lock(s.mutex);
     
     // Check if resource exists
-    auto it = resources_.find(uri);
-    if (it == resources_.end()) {
+    if (s.resources.find(uri) == s.resources.end()) {
         throw mcp_exception(error_code::invalid_params, "Resource not found: " + uri);
     }
     
-    int id = next_subscription_id_++;
-    subscriptions_[id] = std::make_pair(uri, callback);
+    int64_t id = next_subscription_id_.fetch_add(1) * static_cast<int64_t>(shard_count_) + static_cast<int64_t>(index);
+    s.subscriptions[id] = std::make_pair(uri, std::move(callback));
     
     return id;
 }
 
-bool resource_manager::unsubscribe(int subscription_id) {
-    std::lock_guard<std::mutex> lock(g_resource_manager_mutex);
-    
-    auto it = subscriptions_.find(subscription_id);
-    if (it == subscriptions_.end()) {
+bool resource_manager::unsubscribe(int64_t subscription_id) {
+    if (subscription_id < 0) {
         return false;
     }
     
-    subscriptions_.erase(it);
-    return true;
+    shard& s = shards_[static_cast<size_t>(subscription_id) % shard_count_];
+    std::unique_lock<std::shared_mutex> lock(s.mutex);
+    
+    return s.subscriptions.erase(subscription_id) > 0;
 }
 
 void resource_manager::notify_resource_changed(const std::string& uri) {
-    std::lock_guard<std::mutex> lock(g_resource_manager_mutex);
-    
-    // Check if resource exists
-    auto it = resources_.find(uri);
-    if (it == resources_.end()) {
-        return;
-    }
-    
-    // Notify all subscribers for this resource
-    for (const auto& [id, sub] : subscriptions_) {
-        if (sub.first == uri) {
-            try {
-                sub.second(uri);
-            } catch (...) {
-                // Ignore exceptions in callbacks
+    std::vector<std::pair<int64_t, std::function<void(const std::string&)>>> callbacks;
+    {
+        const shard& s = shard_for(uri);
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
+        
+        // Check if resource exists
+        if (s.resources.find(uri) == s.resources.end()) {
+            return;
+        }
+        
+        for (const auto& [id, sub] : s.subscriptions) {
+            if (sub.first == uri) {
+                callbacks.emplace_back(id, sub.second);
             }
         }
     }
+    
+    // Notify in subscription order
+    std::sort(callbacks.begin(), callbacks.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    
+    for (const auto& [id, callback] : callbacks) {
+        try {
+            callback(uri);
+        } catch (...) {
+            // Ignore exceptions in callbacks
+        }
+    }
 }
 
 } // namespace mcp
\ No newline at end of file
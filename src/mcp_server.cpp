@@ -10,6 +10,17 @@
 
 namespace mcp {
 
+namespace {
+
+// Build an SSE message event, serializing the JSON straight into the frame
+std::string make_message_event(const json& message) {
+    std::string frame = "event: message\r\ndata: ";
+    dump_to(frame, message);
+    frame += "\r\n\r\n";
+    return frame;
+}
+
+} // namespace
 
 server::server(const server::configuration& conf)
     : host_(conf.host)
@@ -18,7 +29,13 @@ server::server(const server::configuration& conf)
     , version_(conf.version)
     , sse_endpoint_(conf.sse_endpoint)
     , msg_endpoint_(conf.msg_endpoint)
-    , thread_pool_(conf.threadpool_size)
+    , sse_replay_buffer_size_(conf.sse_replay_buffer_size)
+    , sse_resume_timeout_(conf.sse_resume_timeout)
+    , request_timeout_(conf.request_timeout)
+    , max_session_requests_(conf.max_session_requests)
+    , retry_after_(conf.retry_after)
+    , priority_methods_(conf.priority_methods)
+    , thread_pool_(conf.threadpool_size, conf.max_queued_requests)
 {
     #ifdef MCP_SSL
     if (conf.ssl.server_cert_path && conf.ssl.server_private_key_path) {
@@ -38,6 +55,9 @@ server::server(const server::configuration& conf)
     #else
      http_server_ = std::make_unique<httplib::Server>();
     #endif
+
+    // Responses and SSE events are small writes, do not hold them back for delayed ACKs on keep-alive connections
+    http_server_->set_tcp_nodelay(true);
 }
 
 server::~server() {
@@ -175,9 +195,19 @@ void server::stop() {
         session_initialized_.clear();
     }
     
-    // Close all sessions
-    for (const auto& [session_id, _] : session_dispatchers_) {
-        close_session(session_id);
+    // Requests still queued or running will not be answered
+    {
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        for (auto& [_, requests] : in_flight_requests_) {
+            for (auto& [id, token] : requests) {
+                token.cancel();
+            }
+        }
+    }
+    
+    // Close all sessions (ends their SSE streams)
+    for (const auto& dispatcher : dispatchers_to_close) {
+        dispatcher->close();
     }
     
     // Give threads some time to handle close events
@@ -277,6 +307,9 @@ void server::set_capabilities(const json& capabilities) {
 void server::register_method(const std::string& method, method_handler handler) {
     std::lock_guard<std::mutex> lock(mutex_);
     method_handlers_[method] = handler;
+    if (method == "resources/read") {
+        builtin_resource_read_ = false;
+    }
 }
 
 void server::register_notification(const std::string& method, notification_handler handler) {
@@ -286,7 +319,7 @@ void server::register_notification(const std::string& method, notification_handl
 
 void server::register_resource(const std::string& path, std::shared_ptr<resource> resource) {
     std::lock_guard<std::mutex> lock(mutex_);
-    resources_[path] = resource;
+    resources_.register_resource(path, resource);
     
     // Register methods for resource access
     if (method_handlers_.find("resources/read") == method_handlers_.end()) {
@@ -296,31 +329,27 @@ void server::register_resource(const std::string& path, std::shared_ptr<resource
             }
             
             std::string uri = params["uri"];
-            auto it = resources_.find(uri);
-            if (it == resources_.end()) {
+            auto res = resources_.get_resource(uri);
+            if (!res) {
                 throw mcp_exception(error_code::invalid_params, "Resource not found: " + uri);
             }
             
-            json contents = json::array();
-            contents.push_back(it->second->read());
+            // Optional byte range (offset/length)
+            auto range = resource_range::from_params(params);
             
-            return json{
-                {"contents", contents}
+            json result = {
+                {"contents", json::array()}
             };
+            result["contents"].push_back(range ? res->read_range(*range) : res->read());
+            
+            return result;
         };
+        builtin_resource_read_ = true;
     }
     
     if (method_handlers_.find("resources/list") == method_handlers_.end()) {
         method_handlers_["resources/list"] = [this](const json& params, const std::string& session_id) -> json {
-            json resources = json::array();
-        
-            for (const auto& [uri, res] : resources_) {
-                resources.push_back(res->get_metadata());
-            }
-            
-            json result = {
-                {"resources", resources}
-            };
+            json result = resources_.list_resources();
             
             if (params.contains("cursor")) {
                 result["nextCursor"] = "";
@@ -337,8 +366,7 @@ void server::register_resource(const std::string& path, std::shared_ptr<resource
             }
             
             std::string uri = params["uri"];
-            auto it = resources_.find(uri);
-            if (it == resources_.end()) {
+            if (!resources_.get_resource(uri)) {
                 throw mcp_exception(error_code::invalid_params, "Resource not found: " + uri);
             }
             
@@ -353,9 +381,93 @@ void server::register_resource(const std::string& path, std::shared_ptr<resource
     }
 }
 
+void server::register_tool(const tool& tool, tool_handler handler, const tool_memo::configuration& memo) {
+    auto tool_cache = std::make_shared<tool_memo>(std::move(handler), memo);
+    register_tool(tool, [tool_cache](const json& args, const std::string& session_id) -> json {
+        return tool_cache->call(args, session_id);
+    });
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    tool_memos_[tool.name] = tool_cache;
+}
+
+std::shared_ptr<tool_memo> server::get_tool_memo(const std::string& tool_name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = tool_memos_.find(tool_name);
+    return it != tool_memos_.end() ? it->second : nullptr;
+}
+
+tool_stream::tool_stream(server& srv, const std::string& session_id, json progress_token)
+    : server_(srv), session_id_(session_id), progress_token_(std::move(progress_token)),
+      token_(cancellation_token::current()) {
+}
+
+void tool_stream::progress(double progress, std::optional<double> total, const std::string& message) {
+    if (!is_streaming() || token_.is_cancelled()) {
+        return;
+    }
+
+    json params = {
+        {"progressToken", progress_token_},
+        {"progress", progress}
+    };
+    if (total) {
+        params["total"] = *total;
+    }
+    if (!message.empty()) {
+        params["message"] = message;
+    }
+    server_.send_jsonrpc(session_id_, request::create_notification("progress", params).to_json());
+}
+
+void tool_stream::write(const json& content) {
+    json items = content.is_array() ? content : json::array({content});
+    if (!is_streaming()) {
+        for (auto& item : items) {
+            collected_.push_back(std::move(item));
+        }
+        return;
+    }
+    if (token_.is_cancelled()) {
+        return;
+    }
+
+    json params = json::object();
+    params["progressToken"] = progress_token_;
+    params["content"] = std::move(items);
+    server_.send_jsonrpc(session_id_, request::create_notification("tools/partial", params).to_json());
+}
+
+json tool_stream::finish(json content) {
+    if (collected_.empty()) {
+        return content;
+    }
+    if (content.is_array()) {
+        for (auto& item : content) {
+            collected_.push_back(std::move(item));
+        }
+    } else if (!content.is_null()) {
+        collected_.push_back(std::move(content));
+    }
+    return std::move(collected_);
+}
+
+void server::register_streaming_tool(const tool& tool, streaming_tool_handler handler) {
+    // The plain handler collects the content, tools/call uses the streaming one
+    register_tool(tool, [this, handler](const json& args, const std::string& session_id) -> json {
+        tool_stream stream(*this, session_id, json());
+        return stream.finish(handler(args, stream, session_id));
+    });
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    streaming_tools_[tool.name] = std::move(handler);
+}
+
 void server::register_tool(const tool& tool, tool_handler handler) {
     std::lock_guard<std::mutex> lock(mutex_);
     tools_[tool.name] = std::make_pair(tool, handler);
+    tool_memos_.erase(tool.name);
+    streaming_tools_.erase(tool.name);
     
     // Register methods for tool listing and calling
     if (method_handlers_.find("tools/list") == method_handlers_.end()) {
@@ -380,11 +492,15 @@ void server::register_tool(const tool& tool, tool_handler handler) {
                 throw mcp_exception(error_code::invalid_params, "Tool not found: " + tool_name);
             }
             
-            json tool_args = params.contains("arguments") ? params["arguments"] : json::array();
+            // Pass the arguments by reference, only arguments sent as a string need a new value
+            static const json no_args = json::array();
+            const json* tool_args = params.contains("arguments") ? &params["arguments"] : &no_args;
+            json parsed_args;
 
-            if (tool_args.is_string()) {
+            if (tool_args->is_string()) {
                 try {
-                    tool_args = json::parse(tool_args.get<std::string>());
+                    parsed_args = json::parse(tool_args->get_ref<const std::string&>());
+                    tool_args = &parsed_args;
                 } catch (const json::exception& e) {
                     throw mcp_exception(error_code::invalid_params, "Invalid JSON arguments: " + std::string(e.what()));
                 }
@@ -395,8 +511,24 @@ void server::register_tool(const tool& tool, tool_handler handler) {
             };
 
             try {
-                tool_result["content"] = it->second.second(tool_args, session_id);
+                auto streaming = streaming_tools_.find(tool_name);
+                if (streaming != streaming_tools_.end()) {
+                    // Progress and partial content go to the caller if it sent a progress token
+                    json progress_token;
+                    auto meta = params.find("_meta");
+                    if (meta != params.end() && meta->is_object() && meta->contains("progressToken")) {
+                        progress_token = (*meta)["progressToken"];
+                    }
+                    tool_stream stream(*this, session_id, std::move(progress_token));
+                    tool_result["content"] = stream.finish(streaming->second(*tool_args, stream, session_id));
+                } else {
+                    tool_result["content"] = it->second.second(*tool_args, session_id);
+                }
             } catch (const std::exception& e) {
+                // A tool stopped by the request's deadline fails the request, not the tool
+                if (cancellation_token::current().is_expired()) {
+                    throw mcp_exception(error_code::request_timeout, "Request deadline exceeded");
+                }
                 tool_result["isError"] = true;
                 tool_result["content"] = json::array({
                     {
@@ -433,80 +565,123 @@ void server::set_auth_handler(auth_handler handler) {
 }
 
 void server::handle_sse(const httplib::Request& req, httplib::Response& res) {
-    std::string session_id = generate_session_id();
-    std::string session_uri = msg_endpoint_ + "?session_id=" + session_id;
-    
     // Setup SSE response headers
     res.set_header("Content-Type", "text/event-stream");
     res.set_header("Cache-Control", "no-cache");
     res.set_header("Connection", "keep-alive");
     res.set_header("Access-Control-Allow-Origin", "*");
     
-    // Create session-specific event dispatcher
-    auto session_dispatcher = std::make_shared<event_dispatcher>();
-    
-    // Initialize activity time
-    session_dispatcher->update_activity();
-    
-    // Add session dispatcher to mapping table
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        session_dispatchers_[session_id] = session_dispatcher;
-    }
+    std::string session_id;
+    std::shared_ptr<event_dispatcher> session_dispatcher;
+    uint64_t stream = 0;
     
-    // Create session thread
-    auto thread = std::make_unique<std::thread>([this, res, session_id, session_uri, session_dispatcher]() {
-        try {
-            // Send initial session URI
-            std::this_thread::sleep_for(std::chrono::milliseconds(500));
-            std::stringstream ss;
-            ss << "event: endpoint\r\ndata: " << session_uri << "\r\n\r\n";
-            session_dispatcher->send_event(ss.str());
-            
-            // Update activity time (after sending message)
-            session_dispatcher->update_activity();
+    // A client reconnecting after a dropped stream resumes its session after the last event it received
+    if (sse_replay_buffer_size_ > 0 && req.has_header("Last-Event-ID")) {
+        std::string last_event_id = req.get_header_value("Last-Event-ID");
+        size_t colon = last_event_id.rfind(':');
+        if (colon != std::string::npos && colon + 1 < last_event_id.size() &&
+            last_event_id.find_first_not_of("0123456789", colon + 1) == std::string::npos) {
+            std::string resume_id = last_event_id.substr(0, colon);
+            uint64_t last_event_seq = std::strtoull(last_event_id.c_str() + colon + 1, nullptr, 10);
             
-            // Send periodic heartbeats to detect connection status
-            int heartbeat_count = 0;
-            while (running_ && !session_dispatcher->is_closed()) {
-               std::this_thread::sleep_for(std::chrono::seconds(5) + std::chrono::milliseconds(rand() % 500)); // NOTE: DO NOT set it the same as the timeout of wait_event
-                
-                if (session_dispatcher->is_closed() || !running_) {
-                    break;
+            std::shared_ptr<event_dispatcher> dispatcher;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = session_dispatchers_.find(resume_id);
+                if (it != session_dispatchers_.end()) {
+                    dispatcher = it->second;
                 }
+            }
+            
+            if (dispatcher && (stream = dispatcher->attach(last_event_seq)) != 0) {
+                session_id = resume_id;
+                session_dispatcher = dispatcher;
+                session_dispatcher->update_activity();
+                LOG_INFO("Resumed SSE session ", session_id, " after event ", last_event_seq);
+            } else {
+                LOG_WARNING("Cannot resume SSE session ", resume_id, ", starting a new session");
+            }
+        }
+    }
+    
+    if (!session_dispatcher) {
+        session_id = generate_session_id();
+        std::string session_uri = msg_endpoint_ + "?session_id=" + session_id;
+        
+        // Create session-specific event dispatcher
+        session_dispatcher = std::make_shared<event_dispatcher>(session_id, sse_replay_buffer_size_);
+        stream = session_dispatcher->attach();
+        
+        // Initialize activity time
+        session_dispatcher->update_activity();
+        
+        // Add session dispatcher to mapping table
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            session_dispatchers_[session_id] = session_dispatcher;
+        }
+        
+        // Create session thread
+        auto thread = std::make_unique<std::thread>([this, session_id, session_uri, session_dispatcher]() {
+            try {
+                // Send initial session URI (resumable, so a client missing it gets it on reconnection)
+                session_dispatcher->wait_closed(std::chrono::milliseconds(500));
+                std::stringstream ss;
+                ss << "event: endpoint\r\ndata: " << session_uri << "\r\n\r\n";
+                session_dispatcher->send_event(ss.str(), true);
                 
-                std::stringstream heartbeat;
-                heartbeat << "event: heartbeat\r\ndata: " << heartbeat_count++ << "\r\n\r\n";
+                // Update activity time (after sending message)
+                session_dispatcher->update_activity();
                 
-                try {
-                    bool sent = session_dispatcher->send_event(heartbeat.str());
-                    if (!sent) {
-                        LOG_WARNING("Failed to send heartbeat, client may have closed connection: ", session_id);
+                // Send periodic heartbeats to detect connection status
+                int heartbeat_count = 0;
+                while (running_ && !session_dispatcher->is_closed()) {
+                    // Woken early when the session is closed, so that stop() can join this thread
+                    session_dispatcher->wait_closed(std::chrono::seconds(5) + std::chrono::milliseconds(rand() % 500)); // NOTE: DO NOT set it the same as the timeout of wait_event
+                    
+                    if (session_dispatcher->is_closed() || !running_) {
                         break;
                     }
                     
-                    // Update activity time (heartbeat successful)
-                    session_dispatcher->update_activity();
-                } catch (const std::exception& e) {
-                    LOG_ERROR("Failed to send heartbeat: ", e.what());
-                    break;
+                    // Give up on a dropped stream the client did not resume in time
+                    if (session_dispatcher->detached_for() > sse_resume_timeout_) {
+                        LOG_INFO("SSE session not resumed in time, closing: ", session_id);
+                        break;
+                    }
+                    
+                    std::stringstream heartbeat;
+                    heartbeat << "event: heartbeat\r\ndata: " << heartbeat_count++ << "\r\n\r\n";
+                    
+                    try {
+                        bool sent = session_dispatcher->send_event(heartbeat.str());
+                        if (!sent) {
+                            LOG_WARNING("Failed to send heartbeat, client may have closed connection: ", session_id);
+                            break;
+                        }
+                        
+                        // Update activity time (heartbeat successful)
+                        session_dispatcher->update_activity();
+                    } catch (const std::exception& e) {
+                        LOG_ERROR("Failed to send heartbeat: ", e.what());
+                        break;
+                    }
                 }
+            } catch (const std::exception& e) {
+                LOG_ERROR("SSE session thread exception: ", session_id, ", ", e.what());
             }
-        } catch (const std::exception& e) {
-            LOG_ERROR("SSE session thread exception: ", session_id, ", ", e.what());
-        }
+            
+            close_session(session_id);
+        });
         
-        close_session(session_id);
-    });
-    
-    // Store thread
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        sse_threads_[session_id] = std::move(thread);
+        // Store thread
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            sse_threads_[session_id] = std::move(thread);
+        }
     }
     
     // Setup chunked content provider
-    res.set_chunked_content_provider("text/event-stream", [this, session_id, session_dispatcher](size_t /* offset */, httplib::DataSink& sink) {
+    res.set_chunked_content_provider("text/event-stream", [this, session_id, session_dispatcher, stream](size_t /* offset */, httplib::DataSink& sink) {
         try {
             // Check if session is closed - directly get status from dispatcher, reduce lock contention
             if (session_dispatcher->is_closed()) {
@@ -517,11 +692,20 @@ void server::handle_sse(const httplib::Request& req, httplib::Response& res) {
             session_dispatcher->update_activity();
             
             // Wait for event
-            bool result = session_dispatcher->wait_event(&sink);
+            bool result = session_dispatcher->wait_event(&sink, stream);
             if (!result) {
-                LOG_WARNING("Failed to wait for event, closing connection: ", session_id);
+                if (session_dispatcher->is_closed()) {
+                    return false;
+                }
                 
-                close_session(session_id);
+                if (sse_replay_buffer_size_ > 0) {
+                    // Keep the session and its events for the client to resume
+                    LOG_WARNING("SSE stream ended, session kept for resumption: ", session_id);
+                    session_dispatcher->detach(stream);
+                } else {
+                    LOG_WARNING("Failed to wait for event, closing connection: ", session_id);
+                    close_session(session_id);
+                }
                 
                 return false;
             }
@@ -622,12 +806,27 @@ void server::handle_jsonrpc(const httplib::Request& req, httplib::Response& res)
         return;
     }
     
+    // Cancellations are handled at once, not queued behind the requests they cancel
+    if (mcp_req.is_notification() && mcp_req.method == "notifications/cancelled") {
+        process_request(mcp_req, session_id);
+        res.status = 202;
+        res.set_content("Accepted", "text/plain");
+        return;
+    }
+    
     // If it is a notification (no ID), process it directly and return 202 status code
     if (mcp_req.is_notification()) {
         // Process it asynchronously in the thread pool
-        thread_pool_.enqueue([this, mcp_req, session_id]() {
+        bool queued = queue_request(session_id, mcp_req, [this, mcp_req, session_id]() {
             process_request(mcp_req, session_id);
         });
+        if (!queued) {
+            LOG_WARNING("Request queue full, rejecting notification: ", mcp_req.method);
+            res.status = 503;
+            res.set_header("Retry-After", std::to_string(retry_after_.count()));
+            res.set_content("{\"error\":\"Server busy\"}", "application/json");
+            return;
+        }
         
         // Return 202 Accepted
         res.status = 202;
@@ -636,19 +835,60 @@ void server::handle_jsonrpc(const httplib::Request& req, httplib::Response& res)
     }
     
     // For requests with ID, process it asynchronously in the thread pool and return the result via SSE
-    thread_pool_.enqueue([this, mcp_req, session_id, dispatcher]() {
-        // Process the request
-        json response_json = process_request(mcp_req, session_id);
+    // Requests beyond the session's or the server's limits are refused at once, the client retries later
+    std::optional<cancellation_token> token;
+    try {
+        token = begin_request(session_id, mcp_req);
+    } catch (const mcp_exception& e) {
+        LOG_WARNING("Invalid request ", mcp_req.method, ": ", e.what());
+        res.status = 400;
+        std::string body;
+        dump_to(body, response::create_error(mcp_req.id, e.code(), e.what()).to_json());
+        res.set_content(std::move(body), "application/json");
+        return;
+    }
+    if (!token) {
+        LOG_WARNING("Too many requests in flight for session ", session_id, ", rejecting: ", mcp_req.method);
+        res.status = 429;
+        res.set_header("Retry-After", std::to_string(retry_after_.count()));
+        std::string body;
+        dump_to(body, busy_response(mcp_req, "Too many requests in flight"));
+        res.set_content(std::move(body), "application/json");
+        return;
+    }
+    
+    bool queued = queue_request(session_id, mcp_req, [this, mcp_req, session_id, dispatcher, token = *token]() {
+        // Process the request, serializing the response straight into the SSE frame
+        const std::string header = "event: message\r\ndata: ";
+        std::string frame = header;
+        try {
+            if (!write_tracked_response(mcp_req, session_id, token, frame)) {
+                return;
+            }
+        } catch (const std::exception& e) {
+            LOG_ERROR("Failed to serialize response: ", e.what());
+            frame = header;
+            dump_to(frame, response::create_error(mcp_req.id, error_code::internal_error, "Internal error: " + std::string(e.what())).to_json());
+        }
+        frame += "\r\n\r\n";
         
-        // Send response via SSE
-        std::stringstream ss;
-        ss << "event: message\r\ndata: " << response_json.dump() << "\r\n\r\n";
-        bool result = dispatcher->send_event(ss.str());
+        // Send response via SSE (kept for replay if the stream drops before the client gets it)
+        bool result = dispatcher->send_event(std::move(frame), true);
         
         if (!result) {
             LOG_ERROR("Failed to send response via SSE: session_id=", session_id);
         }
     });
+    if (!queued) {
+        end_request(session_id, mcp_req.id);
+        LOG_WARNING("Request queue full, rejecting: ", mcp_req.method);
+        res.status = 503;
+        res.set_header("Retry-After", std::to_string(retry_after_.count()));
+        std::string body;
+        dump_to(body, busy_response(mcp_req, "Server busy"));
+        res.set_content(std::move(body), "application/json");
+        return;
+    }
     
     // Return 202 Accepted
     res.status = 202;
@@ -660,6 +900,8 @@ json server::process_request(const request& req, const std::string& session_id)
     if (req.is_notification()) {
         if (req.method == "notifications/initialized") {
             set_session_initialized(session_id, true);
+        } else if (req.method == "notifications/cancelled" && req.params.contains("requestId")) {
+            cancel_request(session_id, req.params["requestId"]);
         }
         return json::object();
     }
@@ -701,7 +943,7 @@ json server::process_request(const request& req, const std::string& session_id)
             
             // Create success response
             LOG_INFO("Method call successful: ", req.method);
-            return response::create_success(req.id, result).to_json();
+            return response::create_success(req.id, std::move(result)).to_json();
         }
         
         // Method not found
@@ -738,6 +980,161 @@ json server::process_request(const request& req, const std::string& session_id)
     }
 }
 
+void server::write_response(const request& req, const std::string& session_id, std::string& out) {
+    if (req.method == "resources/read" && write_resource_read(req, session_id, out)) {
+        return;
+    }
+    dump_to(out, process_request(req, session_id));
+}
+
+bool server::write_tracked_response(const request& req, const std::string& session_id,
+    const cancellation_token& token, std::string& out) {
+    // Requests the client cancelled are dropped without running, those whose deadline passed
+    // while queued are answered with an error
+    bool cancelled = token.is_cancel_requested();
+    if (!cancelled && token.is_expired()) {
+        timed_out_requests_.fetch_add(1, std::memory_order_relaxed);
+        LOG_INFO("Request deadline passed before it ran: ", req.method);
+        dump_to(out, response::create_error(req.id, error_code::request_timeout, "Request deadline exceeded").to_json());
+    } else if (!cancelled) {
+        try {
+            cancellation_token::scope current(token);
+            write_response(req, session_id, out);
+        } catch (...) {
+            end_request(session_id, req.id);
+            throw;
+        }
+        // A result completed after the deadline is still sent, only a cancellation discards it
+        cancelled = token.is_cancel_requested();
+    }
+    end_request(session_id, req.id);
+    
+    if (cancelled) {
+        dropped_requests_.fetch_add(1, std::memory_order_relaxed);
+        LOG_INFO("Request cancelled, no response sent: ", req.method);
+    }
+    return !cancelled;
+}
+
+std::optional<cancellation_token> server::begin_request(const std::string& session_id, const request& req) {
+    // The deadline counts from the arrival of the request, bounded by the server's own limit
+    std::optional<std::chrono::milliseconds> timeout = req.timeout();
+    if (request_timeout_.count() > 0 && (!timeout || *timeout > request_timeout_)) {
+        timeout = std::min(request_timeout_, request::max_timeout);
+    }
+    cancellation_token token = timeout ? cancellation_token(std::chrono::steady_clock::now() + *timeout) : cancellation_token();
+    
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+    auto& requests = in_flight_requests_[session_id];
+    if (max_session_requests_ > 0 && requests.size() >= max_session_requests_) {
+        rejected_session_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    // A second request with the same ID would take over the first one's cancellation entry
+    auto [it, inserted] = requests.emplace(req.id.dump(), token);
+    if (!inserted) {
+        throw mcp_exception(error_code::invalid_request, "Request ID already in use: " + it->first);
+    }
+    return token;
+}
+
+json server::busy_response(const request& req, const std::string& message) const {
+    return response::create_error(req.id, error_code::server_busy, message,
+        {{"retryAfter", retry_after_.count()}}).to_json();
+}
+
+bool server::queue_request(const std::string& session_id, const request& req, std::function<void()> task) {
+    bool priority = std::find(priority_methods_.begin(), priority_methods_.end(), req.method) != priority_methods_.end();
+    return thread_pool_.try_enqueue(session_id, std::move(task), priority);
+}
+
+server::load_statistics server::get_load_stats() {
+    thread_pool::statistics pool = thread_pool_.stats();
+    
+    load_statistics stats;
+    stats.queued = pool.queued;
+    stats.active = pool.active;
+    stats.peak_queued = pool.peak_queued;
+    stats.rejected_overload = pool.rejected;
+    stats.rejected_session = rejected_session_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_requests_.load(std::memory_order_relaxed);
+    stats.timed_out = timed_out_requests_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void server::end_request(const std::string& session_id, const json& id) {
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+    auto session_it = in_flight_requests_.find(session_id);
+    if (session_it == in_flight_requests_.end()) {
+        return;
+    }
+    session_it->second.erase(id.dump());
+    if (session_it->second.empty()) {
+        in_flight_requests_.erase(session_it);
+    }
+}
+
+void server::cancel_request(const std::string& session_id, const json& id) {
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+    auto session_it = in_flight_requests_.find(session_id);
+    if (session_it == in_flight_requests_.end()) {
+        return;
+    }
+    auto it = session_it->second.find(id.dump());
+    if (it != session_it->second.end()) {
+        LOG_INFO("Cancelling request ", id.dump(), " of session ", session_id);
+        it->second.cancel();
+    }
+}
+
+void server::cancel_session_requests(const std::string& session_id) {
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+    auto session_it = in_flight_requests_.find(session_id);
+    if (session_it == in_flight_requests_.end()) {
+        return;
+    }
+    for (auto& [id, token] : session_it->second) {
+        token.cancel();
+    }
+}
+
+bool server::write_resource_read(const request& req, const std::string& session_id, std::string& out) {
+    if (!req.params.contains("uri") || !req.params["uri"].is_string() || !is_session_initialized(session_id)) {
+        return false;
+    }
+    
+    if (!builtin_resource_read_) {
+        return false;
+    }
+    
+    std::shared_ptr<resource> res = resources_.get_resource(req.params["uri"].get_ref<const std::string&>());
+    if (!res) {
+        return false;
+    }
+    
+    // Same layout as response::to_json() with a single entry in "contents"
+    const std::string::size_type start = out.size();
+    try {
+        auto range = resource_range::from_params(req.params);
+        
+        out += "{\"jsonrpc\":\"2.0\",\"id\":";
+        dump_to(out, req.id);
+        out += ",\"result\":{\"contents\":[";
+        if (range) {
+            res->write_content(out, *range);
+        } else {
+            res->write_content(out);
+        }
+        out += "]}}";
+        return true;
+    } catch (const std::exception& e) {
+        // Let the generic path produce the error response
+        LOG_WARNING("Failed to serialize resource: ", e.what());
+        out.resize(start);
+        return false;
+    }
+}
+
 json server::handle_initialize(const request& req, const std::string& session_id) {
     const json& params = req.params;
 
@@ -807,16 +1204,29 @@ void server::send_jsonrpc(const std::string& session_id, const json& message) {
         return;
     }
 
-    // Get session dispatcher
+    // Get session dispatcher (or the writer of a stream session)
     std::shared_ptr<event_dispatcher> dispatcher;
+    stream_writer writer;
     {
         std::lock_guard<std::mutex> lock(mutex_);
+        auto stream_it = stream_sessions_.find(session_id);
+        if (stream_it != stream_sessions_.end()) {
+            writer = stream_it->second;
+        }
         auto it = session_dispatchers_.find(session_id);
-        if (it == session_dispatchers_.end()) {
+        if (it != session_dispatchers_.end()) {
+            dispatcher = it->second;
+        } else if (!writer) {
             LOG_ERROR("Session not found: ", session_id);
             return;
         }
-        dispatcher = it->second;
+    }
+    
+    if (writer) {
+        if (!writer(message)) {
+            LOG_ERROR("Failed to send message to session: ", session_id);
+        }
+        return;
     }
     
     // Confirm dispatcher is still valid
@@ -826,9 +1236,7 @@ void server::send_jsonrpc(const std::string& session_id, const json& message) {
     }
     
     // Send message
-    std::stringstream ss;
-    ss << "event: message\r\ndata: " << message.dump() << "\r\n\r\n";
-    bool result = dispatcher->send_event(ss.str());
+    bool result = dispatcher->send_event(make_message_event(message), true);
     
     if (!result) {
         LOG_ERROR("Failed to send message to session: ", session_id);
@@ -865,8 +1273,8 @@ void server::set_session_initialized(const std::string& session_id, bool initial
     try {
         std::lock_guard<std::mutex> lock(mutex_);
         // Check if session still exists
-        auto it = session_dispatchers_.find(session_id);
-        if (it == session_dispatchers_.end()) {
+        if (session_dispatchers_.find(session_id) == session_dispatchers_.end() &&
+            stream_sessions_.find(session_id) == stream_sessions_.end()) {
             LOG_WARNING("Cannot set initialization state for non-existent session: ", session_id);
             return;
         }
@@ -943,6 +1351,9 @@ bool server::set_mount_point(const std::string& mount_point, const std::string&
 }
 
 void server::close_session(const std::string& session_id) {
+    // Nobody will receive the responses of the session's requests
+    cancel_session_requests(session_id);
+    
      // Clean up resources safely
     try {
         for (const auto& [key, handler] : session_cleanup_handler_) {
@@ -990,4 +1401,17 @@ void server::close_session(const std::string& session_id) {
     }
 }
 
+void server::open_stream_session(const std::string& session_id, stream_writer writer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stream_sessions_[session_id] = std::move(writer);
+}
+
+void server::close_stream_session(const std::string& session_id) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stream_sessions_.erase(session_id);
+    }
+    close_session(session_id);
+}
+
 } // namespace mcp
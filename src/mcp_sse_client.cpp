@@ -23,21 +23,19 @@ sse_client::~sse_client() {
 
 
 void sse_client::init_client(const std::string& scheme_host_port, bool validate_certificates, const std::string& ca_cert_path) {
-    http_client_ = std::make_unique<httplib::Client>(scheme_host_port.c_str());
+    http_connection_pool::configuration pool_conf;
+    pool_conf.timeout_seconds = timeout_seconds_;
+    pool_conf.validate_certificates = validate_certificates;
+    pool_conf.ca_cert_path = ca_cert_path;
+    post_pool_ = std::make_unique<http_connection_pool>(scheme_host_port, pool_conf);
     sse_client_ = std::make_unique<httplib::Client>(scheme_host_port.c_str());
-
-    http_client_->set_connection_timeout(timeout_seconds_, 0);
-    http_client_->set_read_timeout(timeout_seconds_, 0);
-    http_client_->set_write_timeout(timeout_seconds_, 0);
     
     sse_client_->set_connection_timeout(timeout_seconds_ * 2, 0);
     sse_client_->set_write_timeout(timeout_seconds_, 0);
 
     #ifdef MCP_SSL
-    http_client_->enable_server_certificate_verification(validate_certificates);
     sse_client_->enable_server_certificate_verification(validate_certificates);
     if (!ca_cert_path.empty()) {
-        http_client_->set_ca_cert_path(ca_cert_path.c_str());
         sse_client_->set_ca_cert_path(ca_cert_path.c_str());
     }
     #endif
@@ -129,9 +127,7 @@ void sse_client::set_header(const std::string& key, const std::string& value) {
     std::lock_guard<std::mutex> lock(mutex_);
     default_headers_[key] = value;
     
-    if (http_client_) {
-        http_client_->set_default_headers({{key, value}});
-    }
+    // Messages are posted with default_headers_, see post_message()
     if (sse_client_) {
         sse_client_->set_default_headers({{key, value}});
     }
@@ -141,9 +137,8 @@ void sse_client::set_timeout(int timeout_seconds) {
     std::lock_guard<std::mutex> lock(mutex_);
     timeout_seconds_ = timeout_seconds;
     
-    if (http_client_) {
-        http_client_->set_connection_timeout(timeout_seconds_, 0);
-        http_client_->set_write_timeout(timeout_seconds_, 0);
+    if (post_pool_) {
+        post_pool_->set_timeout(timeout_seconds_);
     }
     
     if (sse_client_) {
@@ -152,13 +147,28 @@ void sse_client::set_timeout(int timeout_seconds) {
     }
 }
 
+void sse_client::set_max_connections(size_t max_connections) {
+    post_pool_->set_max_connections(max_connections);
+}
+
+http_connection_pool::statistics sse_client::connection_stats() const {
+    return post_pool_->stats();
+}
+
 void sse_client::set_capabilities(const json& capabilities) {
     std::lock_guard<std::mutex> lock(mutex_);
     capabilities_ = capabilities;
 }
 
 response sse_client::send_request(const std::string& method, const json& params) {
-    request req = request::create(method, params);
+    return send_prepared_request(request::create(method, params));
+}
+
+response sse_client::send_prepared_request(const request& req) {
+    if (req.is_notification()) {
+        throw mcp_exception(error_code::invalid_request, "Request has no ID: " + req.method);
+    }
+    
     json result = send_jsonrpc(req);
     
     response res;
@@ -179,10 +189,12 @@ json sse_client::get_server_capabilities() {
 }
 
 json sse_client::call_tool(const std::string& tool_name, const json& arguments) {
-    return send_request("tools/call", {
-        {"name", tool_name},
-        {"arguments", arguments}
-    }).result;
+    return cached_tool_call(tool_name, arguments, [&]() {
+        return send_request("tools/call", {
+            {"name", tool_name},
+            {"arguments", arguments}
+        }).result;
+    });
 }
 
 std::vector<tool> sse_client::get_tools() {
@@ -206,10 +218,15 @@ std::vector<tool> sse_client::get_tools() {
         if (tool_json.contains("inputSchema")) {
             t.parameters_schema = tool_json["inputSchema"];
         }
+
+        if (tool_json.contains("annotations") && tool_json["annotations"].is_object()) {
+            t.annotations = tool_json["annotations"];
+        }
         
         tools.push_back(t);
     }
     
+    remember_tools(tools);
     return tools;
 }
 
@@ -258,35 +275,26 @@ void sse_client::open_sse_connection() {
         const int max_retries = 5;
         const int retry_delay_base = 1000;
         
+        // Kept across reconnections: the last event ID resumes the session where the stream dropped
+        sse_parser parser([this](const sse_event& event) {
+            if (!handle_sse_event(event)) {
+                LOG_ERROR("SSE thread: Failed to handle event");
+            }
+            return true;
+        });
+        
         while (sse_running_) {
             try {
                 LOG_INFO("SSE thread: Attempting to connect to ", sse_endpoint_);
                 
-                std::string buffer;
-                auto res = sse_client_->Get(sse_endpoint_, 
+                httplib::Headers headers;
+                parser.reset();
+                if (!parser.last_event_id().empty()) {
+                    headers.emplace("Last-Event-ID", parser.last_event_id());
+                }
+                auto res = sse_client_->Get(sse_endpoint_, headers,
                     [&,this](const char *data, size_t data_length) {
-                        buffer.append(data, data_length);
-                        
-                        // Normalize CRLF to LF
-                        size_t crlf_pos = buffer.find("\r\n");
-                        while (crlf_pos != std::string::npos) {
-                            buffer.replace(crlf_pos, 2, "\n");
-                            crlf_pos = buffer.find("\r\n", crlf_pos + 1);
-                        }
-                        
-                        // Process complete events in buffer
-                        size_t start_pos = 0;
-                        while ((start_pos = buffer.find("\n\n", start_pos)) != std::string::npos) {
-                            size_t end_pos = start_pos + 2;
-                            std::string event = buffer.substr(0, start_pos);
-                            buffer.erase(0, end_pos);
-                            start_pos = 0;
-                            
-                            if (!parse_sse_data(event.data(), event.size())) {
-                                LOG_ERROR("SSE thread: Failed to parse event");
-                            }
-                        }
-                        
+                        parser.feed(data, data_length);
                         return sse_running_.load();
                     });
                 
@@ -330,50 +338,56 @@ void sse_client::open_sse_connection() {
     });
 }
 
-bool sse_client::parse_sse_data(const char* data, size_t length) {
+bool sse_client::handle_sse_event(const sse_event& event) {
     try {
-        // Split into lines and process event fields
-        std::istringstream stream(std::string(data, length));
-        std::string line;
-        std::string event_type = "message";
-        std::vector<std::string> data_lines;
-        
-        while (std::getline(stream, line)) {
-            // Trim trailing CR if present
-            if (!line.empty() && line.back() == '\r') {
-                line.pop_back();
+        if (event.type == "heartbeat") {
+            return true;
+        } else if (event.type == "endpoint") {
+            std::string endpoint(event.data);
+            bool session_lost = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                session_lost = !msg_endpoint_.empty() && msg_endpoint_ != endpoint;
+                msg_endpoint_ = endpoint;
+                endpoint_cv_.notify_all();
             }
             
-            if (line.substr(0, 7) == "event: ") {
-                event_type = line.substr(7);
-            } else if (line.substr(0, 6) == "data: ") {
-                data_lines.push_back(line.substr(6));
-            } else if (line.empty()) {
-                break; // End of event
+            if (session_lost) {
+                // Responses to requests sent on the old session will not arrive
+                LOG_WARNING("SSE session could not be resumed, the server started a new session: ", endpoint);
+                json error_result = {
+                    {"isError", true},
+                    {"error", {
+                        {"code", static_cast<int>(error_code::internal_error)},
+                        {"message", "SSE session lost"}
+                    }}
+                };
+                
+                std::lock_guard<std::mutex> lock(response_mutex_);
+                for (auto& [id, promise] : pending_requests_) {
+                    promise.set_value(error_result);
+                }
+                pending_requests_.clear();
             }
-        }
-        
-        if (data_lines.empty()) {
             return true;
-        }
-        
-        // Join data lines with newlines
-        std::string data_content;
-        for (size_t i = 0; i < data_lines.size(); ++i) {
-            if (i > 0) data_content += '\n';
-            data_content += data_lines[i];
-        }
-        
-        if (event_type == "heartbeat") {
-            return true;
-        } else if (event_type == "endpoint") {
-            std::lock_guard<std::mutex> lock(mutex_);
-            msg_endpoint_ = data_content;
-            endpoint_cv_.notify_all();
-            return true;
-        } else if (event_type == "message") {
+        } else if (event.type == "message") {
             try {
-                json response = json::parse(data_content);
+                json response = json::parse(event.data.begin(), event.data.end());
+                
+                // Progress of streaming calls is queued for their listeners before the responses that follow it
+                if (deliver_tool_stream(response, dispatcher_)) {
+                    return true;
+                }
+                
+                // Requests and notifications from the server run on the dispatcher's executor
+                if (response.contains("jsonrpc") && dispatcher_.dispatch(response, [this](const json& message) {
+                        auto result = post_message(message.dump());
+                        if (!result) {
+                            throw mcp_exception(error_code::internal_error, httplib::to_string(result.error()));
+                        }
+                    })) {
+                    return true;
+                }
                 
                 if (response.contains("jsonrpc") && response.contains("id") && !response["id"].is_null()) {
                     json id = response["id"];
@@ -382,7 +396,7 @@ bool sse_client::parse_sse_data(const char* data, size_t length) {
                     auto it = pending_requests_.find(id);
                     if (it != pending_requests_.end()) {
                         if (response.contains("result")) {
-                            it->second.set_value(response["result"]);
+                            it->second.set_value(std::move(response["result"]));
                         } else if (response.contains("error")) {
                             json error_result = {
                                 {"isError", true},
@@ -405,7 +419,7 @@ bool sse_client::parse_sse_data(const char* data, size_t length) {
             }
             return true;
         } else {
-            LOG_WARNING("Received unknown event type: ", event_type);
+            LOG_WARNING("Received unknown event type: ", event.type);
             return true;
         }
     } catch (const std::exception& e) {
@@ -459,25 +473,33 @@ void sse_client::close_sse_connection() {
     LOG_INFO("SSE connection successfully closed (normal exit flow)");
 }
 
-json sse_client::send_jsonrpc(const request& req) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    if (msg_endpoint_.empty()) {
-        throw mcp_exception(error_code::internal_error, "Message endpoint not set, SSE connection may not be established");
+httplib::Result sse_client::post_message(const std::string& body) {
+    std::string endpoint;
+    httplib::Headers headers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        if (msg_endpoint_.empty()) {
+            throw mcp_exception(error_code::internal_error, "Message endpoint not set, SSE connection may not be established");
+        }
+        
+        endpoint = msg_endpoint_;
+        
+        for (const auto& [key, value] : default_headers_) {
+            headers.emplace(key, value);
+        }
     }
     
+    // The response arrives on the SSE stream, the connection is only taken for the POST itself
+    return post_pool_->post(endpoint, headers, body, "application/json");
+}
+
+json sse_client::send_jsonrpc(const request& req) {
     json req_json = req.to_json();
     std::string req_body = req_json.dump();
     
-    httplib::Headers headers;
-    headers.emplace("Content-Type", "application/json");
-    
-    for (const auto& [key, value] : default_headers_) {
-        headers.emplace(key, value);
-    }
-    
     if (req.is_notification()) {
-        auto result = http_client_->Post(msg_endpoint_, headers, req_body, "application/json");
+        auto result = post_message(req_body);
         
         if (!result) {
             auto err = result.error();
@@ -494,10 +516,19 @@ json sse_client::send_jsonrpc(const request& req) {
     
     {
         std::lock_guard<std::mutex> response_lock(response_mutex_);
-        pending_requests_[req.id] = std::move(response_promise);
+        if (!pending_requests_.emplace(req.id, std::move(response_promise)).second) {
+            throw mcp_exception(error_code::invalid_request, "Request ID already in use: " + req.id.dump());
+        }
     }
     
-    auto result = http_client_->Post(msg_endpoint_, headers, req_body, "application/json");
+    httplib::Result result;
+    try {
+        result = post_message(req_body);
+    } catch (...) {
+        std::lock_guard<std::mutex> response_lock(response_mutex_);
+        pending_requests_.erase(req.id);
+        throw;
+    }
     
     if (!result) {
         auto err = result.error();
@@ -543,7 +574,10 @@ json sse_client::send_jsonrpc(const request& req) {
                             "Failed to parse JSON-RPC response: " + std::string(e.what()));
         }
     } else {
-        const auto timeout = std::chrono::seconds(timeout_seconds_);
+        std::chrono::milliseconds timeout = std::chrono::seconds(timeout_seconds_);
+        if (auto call_timeout = req.timeout()) {
+            timeout = std::min(timeout, *call_timeout);
+        }
         
         auto status = response_future.wait_for(timeout);
         
@@ -562,9 +596,15 @@ json sse_client::send_jsonrpc(const request& req) {
             
             return response;
         } else {
+            bool abandoned;
             {
                 std::lock_guard<std::mutex> response_lock(response_mutex_);
-                pending_requests_.erase(req.id);
+                abandoned = pending_requests_.erase(req.id) > 0;
+            }
+            
+            // Let the server stop working on a request nobody waits for
+            if (abandoned) {
+                send_cancelled(req.id, "Timeout waiting for response");
             }
             
             throw mcp_exception(error_code::internal_error, "Timeout waiting for SSE response");
@@ -572,8 +612,73 @@ json sse_client::send_jsonrpc(const request& req) {
     }
 }
 
+bool sse_client::cancel_request(const json& id, const std::string& reason) {
+    {
+        std::lock_guard<std::mutex> lock(response_mutex_);
+        auto it = pending_requests_.find(id);
+        if (it == pending_requests_.end()) {
+            return false;
+        }
+        it->second.set_value(cancelled_result());
+        pending_requests_.erase(it);
+    }
+    
+    send_cancelled(id, reason);
+    return true;
+}
+
+void sse_client::cancel_pending_requests(const std::string& reason) {
+    std::vector<json> ids;
+    {
+        std::lock_guard<std::mutex> lock(response_mutex_);
+        for (auto& [id, promise] : pending_requests_) {
+            promise.set_value(cancelled_result());
+            ids.push_back(id);
+        }
+        pending_requests_.clear();
+    }
+    
+    for (const auto& id : ids) {
+        send_cancelled(id, reason);
+    }
+}
+
+json sse_client::cancelled_result() {
+    return {
+        {"isError", true},
+        {"error", {
+            {"code", static_cast<int>(error_code::internal_error)},
+            {"message", "Request cancelled"}
+        }}
+    };
+}
+
+void sse_client::send_cancelled(const json& id, const std::string& reason) {
+    json params = {{"requestId", id}};
+    if (!reason.empty()) {
+        params["reason"] = reason;
+    }
+    try {
+        send_jsonrpc(request::create_notification("cancelled", params));
+    } catch (const std::exception& e) {
+        LOG_WARNING("Failed to send cancellation of request ", id.dump(), ": ", e.what());
+    }
+}
+
 bool sse_client::is_running() const {
     return sse_running_;
 }
 
+void sse_client::register_request_handler(const std::string& method, client_request_handler handler) {
+    dispatcher_.register_request_handler(method, std::move(handler));
+}
+
+void sse_client::register_notification_handler(const std::string& method, client_notification_handler handler) {
+    dispatcher_.register_notification_handler(method, std::move(handler));
+}
+
+void sse_client::set_executor(std::shared_ptr<thread_pool> executor) {
+    dispatcher_.set_executor(std::move(executor));
+}
+
 } // namespace mcp
@@ -18,13 +18,21 @@
 #include <sys/wait.h>
 #include <fcntl.h>
 #include <signal.h>
+#include <poll.h>
+#include <spawn.h>
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#endif
 #endif
 
 #include <cstring>
-#include <sstream>
 #include <iostream>
 #include <chrono>
 
+#if !defined(_WIN32)
+extern char** environ;
+#endif
+
 namespace mcp {
 
 stdio_client::stdio_client(const std::string& command, const json& env_vars, const json& capabilities)
@@ -88,17 +96,27 @@ bool stdio_client::ping() {
     }
 }
 
+void stdio_client::set_timeout(int timeout_seconds) {
+    timeout_seconds_ = timeout_seconds;
+}
+
 void stdio_client::set_capabilities(const json& capabilities) {
     std::lock_guard<std::mutex> lock(mutex_);
     capabilities_ = capabilities;
 }
 
 response stdio_client::send_request(const std::string& method, const json& params) {
+    return send_prepared_request(request::create(method, params));
+}
+
+response stdio_client::send_prepared_request(const request& req) {
     if (!running_) {
         throw mcp_exception(error_code::internal_error, "Server process not running");
     }
+    if (req.is_notification()) {
+        throw mcp_exception(error_code::invalid_request, "Request has no ID: " + req.method);
+    }
     
-    request req = request::create(method, params);
     json result = send_jsonrpc(req);
     
     response res;
@@ -109,6 +127,21 @@ response stdio_client::send_request(const std::string& method, const json& param
     return res;
 }
 
+bool stdio_client::cancel_request(const json& id, const std::string& reason) {
+    {
+        std::lock_guard<std::mutex> lock(response_mutex_);
+        auto it = pending_requests_.find(id);
+        if (it == pending_requests_.end()) {
+            return false;
+        }
+        it->second.set_exception(std::make_exception_ptr(mcp_exception(error_code::internal_error, "Request cancelled")));
+        pending_requests_.erase(it);
+    }
+    
+    send_cancelled(id, reason);
+    return true;
+}
+
 void stdio_client::send_notification(const std::string& method, const json& params) {
     if (!running_) {
         throw mcp_exception(error_code::internal_error, "Server process not running");
@@ -123,10 +156,12 @@ json stdio_client::get_server_capabilities() {
 }
 
 json stdio_client::call_tool(const std::string& tool_name, const json& arguments) {
-    return send_request("tools/call", {
-        {"name", tool_name},
-        {"arguments", arguments}
-    }).result;
+    return cached_tool_call(tool_name, arguments, [&]() {
+        return send_request("tools/call", {
+            {"name", tool_name},
+            {"arguments", arguments}
+        }).result;
+    });
 }
 
 std::vector<tool> stdio_client::get_tools() {
@@ -150,10 +185,15 @@ std::vector<tool> stdio_client::get_tools() {
         if (tool_json.contains("inputSchema")) {
             t.parameters_schema = tool_json["inputSchema"];
         }
+
+        if (tool_json.contains("annotations") && tool_json["annotations"].is_object()) {
+            t.annotations = tool_json["annotations"];
+        }
         
         tools.push_back(t);
     }
     
+    remember_tools(tools);
     return tools;
 }
 
@@ -186,9 +226,35 @@ json stdio_client::list_resource_templates() {
 }
 
 bool stdio_client::is_running() const {
-    return running_;
+    return running_ && !output_closed_;
+}
+
+void stdio_client::stop() {
+    stop_server_process();
+}
+
+void stdio_client::register_request_handler(const std::string& method, client_request_handler handler) {
+    dispatcher_.register_request_handler(method, std::move(handler));
 }
 
+void stdio_client::register_notification_handler(const std::string& method, client_notification_handler handler) {
+    dispatcher_.register_notification_handler(method, std::move(handler));
+}
+
+void stdio_client::set_executor(std::shared_ptr<thread_pool> executor) {
+    dispatcher_.set_executor(std::move(executor));
+}
+
+#if !defined(_WIN32)
+void stdio_client::set_io_reactor(std::shared_ptr<io_reactor> reactor) {
+    if (running_) {
+        LOG_WARNING("Cannot set I/O reactor while server is running");
+        return;
+    }
+    reactor_ = std::move(reactor);
+}
+#endif
+
 void stdio_client::set_environment_variables(const json& env_vars) {
     if (running_) {
         LOG_WARNING("Cannot set environment variables while server is running");
@@ -197,6 +263,58 @@ void stdio_client::set_environment_variables(const json& env_vars) {
     env_vars_ = env_vars;
 }
 
+std::vector<std::string> stdio_client::split_command(const std::string& command) {
+    std::vector<std::string> args;
+    std::string current;
+    bool in_arg = false;
+    
+    for (size_t i = 0; i < command.size(); ++i) {
+        char c = command[i];
+        
+        if (c == ' ' || c == '\t' || c == '\n') {
+            if (in_arg) {
+                args.push_back(std::move(current));
+                current.clear();
+                in_arg = false;
+            }
+            continue;
+        }
+        
+        in_arg = true;
+        
+        if (c == '\'') {
+            // Single quotes: everything up to the closing quote is literal
+            size_t end = command.find('\'', i + 1);
+            if (end == std::string::npos) {
+                throw mcp_exception(error_code::invalid_params, "Unterminated single quote in command: " + command);
+            }
+            current.append(command, i + 1, end - i - 1);
+            i = end;
+        } else if (c == '"') {
+            // Double quotes: backslash escapes only ", \, $ and `
+            for (++i; i < command.size() && command[i] != '"'; ++i) {
+                if (command[i] == '\\' && i + 1 < command.size() && strchr("\"\\$`", command[i + 1]) != nullptr) {
+                    ++i;
+                }
+                current += command[i];
+            }
+            if (i >= command.size()) {
+                throw mcp_exception(error_code::invalid_params, "Unterminated double quote in command: " + command);
+            }
+        } else if (c == '\\' && i + 1 < command.size()) {
+            current += command[++i];
+        } else {
+            current += c;
+        }
+    }
+    
+    if (in_arg) {
+        args.push_back(std::move(current));
+    }
+    
+    return args;
+}
+
 bool stdio_client::start_server_process() {
     if (running_) {
         LOG_INFO("Server process already running");
@@ -330,98 +448,129 @@ bool stdio_client::start_server_process() {
 #else
     // POSIX implementation
     // Create pipes
-    if (pipe(stdin_pipe_) == -1) {
-        LOG_ERROR("Failed to create stdin pipe: ", strerror(errno));
+    // Everything is prepared before spawning, the child only has to exec
+    std::vector<std::string> args;
+    try {
+        args = split_command(command_);
+    } catch (const mcp_exception& e) {
+        LOG_ERROR("Invalid command: ", e.what());
         return false;
     }
     
-    if (pipe(stdout_pipe_) == -1) {
-        LOG_ERROR("Failed to create stdout pipe: ", strerror(errno));
-        close(stdin_pipe_[0]);
-        close(stdin_pipe_[1]);
+    if (args.empty()) {
+        LOG_ERROR("Empty command");
         return false;
     }
     
-    // Create child process
-    process_id_ = fork();
-    
-    if (process_id_ == -1) {
-        LOG_ERROR("Failed to fork process: ", strerror(errno));
-        close(stdin_pipe_[0]);
-        close(stdin_pipe_[1]);
-        close(stdout_pipe_[0]);
-        close(stdout_pipe_[1]);
-        return false;
+    // Inherited environment, with the configured variables replacing inherited ones
+    std::vector<std::string> env;
+    for (char** entry = environ; entry != nullptr && *entry != nullptr; ++entry) {
+        const char* separator = strchr(*entry, '=');
+        std::string key = separator ? std::string(*entry, separator - *entry) : std::string(*entry);
+        if (!env_vars_.is_object() || !env_vars_.contains(key)) {
+            env.emplace_back(*entry);
+        }
     }
     
-    if (process_id_ == 0) {
-        // Child process
-        
-        // Set environment variables
-        if (!env_vars_.empty()) {
-            for (const auto& [key, value] : env_vars_.items()) {
-                std::string env_var = key + "=" + convert_to_string(value);
-                if (putenv(const_cast<char*>(env_var.c_str())) != 0) {
-                    LOG_ERROR("Failed to set environment variable: ", key);
-                }
+    if (env_vars_.is_object()) {
+        for (const auto& [key, value] : env_vars_.items()) {
+            try {
+                env.push_back(key + "=" + convert_to_string(value));
+            } catch (const std::exception&) {
+                LOG_ERROR("Unsupported value for environment variable: ", key);
             }
         }
-        
-        // Close unnecessary pipe ends
-        close(stdin_pipe_[1]);  // Close write end
-        close(stdout_pipe_[0]); // Close read end
-        
-        // Redirect standard input/output
-        if (dup2(stdin_pipe_[0], STDIN_FILENO) == -1) {
-            LOG_ERROR("Failed to redirect stdin: ", strerror(errno));
-            exit(EXIT_FAILURE);
-        }
-        
-        if (dup2(stdout_pipe_[1], STDOUT_FILENO) == -1) {
-            LOG_ERROR("Failed to redirect stdout: ", strerror(errno));
-            exit(EXIT_FAILURE);
+    }
+    
+    std::vector<char*> c_args;
+    for (auto& a : args) {
+        c_args.push_back(a.data());
+    }
+    c_args.push_back(nullptr);
+    
+    std::vector<char*> c_env;
+    for (auto& e : env) {
+        c_env.push_back(e.data());
+    }
+    c_env.push_back(nullptr);
+    
+    // Pipes are close-on-exec, only the ends duplicated onto stdin/stdout survive in the child
+    auto create_pipe = [](int fds[2]) {
+#if defined(__linux__)
+        return pipe2(fds, O_CLOEXEC) == 0;
+#else
+        if (pipe(fds) == -1) {
+            return false;
         }
-        
-        // Close already redirected file descriptors
+        fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+        fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+        return true;
+#endif
+    };
+    
+    if (!create_pipe(stdin_pipe_)) {
+        LOG_ERROR("Failed to create stdin pipe: ", strerror(errno));
+        return false;
+    }
+    
+    if (!create_pipe(stdout_pipe_)) {
+        LOG_ERROR("Failed to create stdout pipe: ", strerror(errno));
         close(stdin_pipe_[0]);
-        close(stdout_pipe_[1]);
-        
-        // Set non-blocking mode
-        // int flags = fcntl(STDIN_FILENO, F_GETFL, 0);
-        // fcntl(STDIN_FILENO, F_SETFL, flags | O_NONBLOCK);
-        
-        // Execute command
-        std::vector<std::string> args;
-        std::istringstream iss(command_);
-        std::string arg;
-        
-        while (iss >> arg) {
-            args.push_back(arg);
-        }
-        
-        std::vector<char*> c_args;
-        for (auto& a : args) {
-            c_args.push_back(const_cast<char*>(a.c_str()));
-        }
-        c_args.push_back(nullptr);
-        
-        execvp(c_args[0], c_args.data());
-        
-        // If execvp returns, it means an error occurred
-        LOG_ERROR("Failed to execute command: ", strerror(errno));
-        exit(EXIT_FAILURE);
+        close(stdin_pipe_[1]);
+        return false;
     }
     
-    // Parent process
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, stdin_pipe_[0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, stdout_pipe_[1], STDOUT_FILENO);
+    
+    // The child starts with an empty signal mask and default SIGPIPE handling, whatever the parent uses
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    
+    sigset_t signals;
+    sigemptyset(&signals);
+    posix_spawnattr_setsigmask(&attr, &signals);
+    sigaddset(&signals, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attr, &signals);
+    
+    short spawn_flags = POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF;
+#if defined(POSIX_SPAWN_USEVFORK)
+    // Older glibc only avoids copying the page tables when asked to
+    spawn_flags |= POSIX_SPAWN_USEVFORK;
+#endif
+    posix_spawnattr_setflags(&attr, spawn_flags);
+    
+    // Create child process (vfork-like: the cost does not grow with the size of this process)
+    pid_t pid = -1;
+    int spawn_error = posix_spawnp(&pid, c_args[0], &actions, &attr, c_args.data(), c_env.data());
+    
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
     
     // Close unnecessary pipe ends
     close(stdin_pipe_[0]);  // Close read end
     close(stdout_pipe_[1]); // Close write end
     
+    if (spawn_error != 0) {
+        LOG_ERROR("Failed to start process ", args[0], ": ", strerror(spawn_error));
+        close(stdin_pipe_[1]);
+        close(stdout_pipe_[0]);
+        stdin_pipe_[1] = stdout_pipe_[0] = -1;
+        return false;
+    }
+    
+    process_id_ = pid;
+    
     // Set non-blocking mode
     int flags = fcntl(stdout_pipe_[0], F_GETFL, 0);
     fcntl(stdout_pipe_[0], F_SETFL, flags | O_NONBLOCK);
     
+    // Writes go through the write queue and must never block the caller
+    flags = fcntl(stdin_pipe_[1], F_GETFL, 0);
+    fcntl(stdin_pipe_[1], F_SETFL, flags | O_NONBLOCK);
+    
     // Check if process is still running
     int status;
     pid_t result = waitpid(process_id_, &status, WNOHANG);
@@ -451,17 +600,87 @@ bool stdio_client::start_server_process() {
         
         return false;
     }
+    
+    read_buffer_.clear();
+    
+    // Descriptor used to wake the read thread up on shutdown (not needed with a reactor)
+    if (!reactor_) {
+#if defined(__linux__)
+        wakeup_fd_[0] = wakeup_fd_[1] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (wakeup_fd_[0] == -1) {
+#else
+        if (pipe(wakeup_fd_) == -1) {
+#endif
+            LOG_ERROR("Failed to create wakeup descriptor: ", strerror(errno));
+            wakeup_fd_[0] = wakeup_fd_[1] = -1;
+            close(stdin_pipe_[1]);
+            close(stdout_pipe_[0]);
+            kill(process_id_, SIGKILL);
+            waitpid(process_id_, &status, 0);
+            return false;
+        }
+#if !defined(__linux__)
+        for (int fd : wakeup_fd_) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+#endif
+    }
 #endif
     
     running_ = true;
+    output_closed_ = false;
+    
+#if defined(_WIN32)
+    read_buffer_.clear();
     
     // Start read thread
     read_thread_ = std::make_unique<std::thread>(&stdio_client::read_thread_func, this);
+#else
+    if (reactor_) {
+        // Reads and queued writes are driven by the shared reactor instead of a dedicated thread
+        write_queue_.open(stdin_pipe_[1], [this](bool pending) {
+            reactor_->modify(stdin_pipe_[1], pending ? static_cast<uint32_t>(io_reactor::writable) : 0u);
+        });
+        
+        try {
+            reactor_->add(stdout_pipe_[0], io_reactor::readable, [this](uint32_t) {
+                if (!read_available()) {
+                    reactor_->remove(stdout_pipe_[0]);
+                    output_closed_ = true;
+                    fail_pending_requests("Server process closed the connection");
+                }
+            });
+            
+            reactor_->add(stdin_pipe_[1], 0, [this](uint32_t events) {
+                if (write_queue_.flush() == write_queue::result::failed || (events & (io_reactor::error | io_reactor::hangup))) {
+                    // The server stopped reading, nothing more can be written
+                    reactor_->remove(stdin_pipe_[1]);
+                    write_queue_.close();
+                }
+            });
+        } catch (const std::exception& e) {
+            LOG_ERROR("Failed to register with I/O reactor: ", e.what());
+            stop_server_process();
+            return false;
+        }
+    } else {
+        // The read thread also writes queued data when the pipe becomes writable
+        write_queue_.open(stdin_pipe_[1], [this](bool pending) {
+            if (pending) {
+                wake_read_thread();
+            }
+        });
+        
+        // Start read thread
+        read_thread_ = std::make_unique<std::thread>(&stdio_client::read_thread_func, this);
+    }
+#endif
     
+#if defined(_WIN32)
     // Wait for a while to ensure process starts
     std::this_thread::sleep_for(std::chrono::milliseconds(500));
     
-#if defined(_WIN32)
     // Check if process is still running
     DWORD exit_code;
     if (GetExitCodeProcess(process_handle_, &exit_code) && exit_code != STILL_ACTIVE) {
@@ -496,9 +715,12 @@ void stdio_client::stop_server_process() {
 #if defined(_WIN32)
     // Windows implementation
     // Close pipes
-    if (stdin_pipe_[1] != NULL) {
-        CloseHandle(stdin_pipe_[1]);
-        stdin_pipe_[1] = NULL;
+    {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        if (stdin_pipe_[1] != NULL) {
+            CloseHandle(stdin_pipe_[1]);
+            stdin_pipe_[1] = NULL;
+        }
     }
     
     if (stdout_pipe_[0] != NULL) {
@@ -533,7 +755,29 @@ void stdio_client::stop_server_process() {
     }
 #else
     // POSIX implementation
-    // Close pipes
+    // Stop reading and wait for the reader before closing the descriptors it polls
+    write_queue_.close();
+    
+    if (reactor_) {
+        if (stdout_pipe_[0] != -1) {
+            reactor_->remove(stdout_pipe_[0]);
+        }
+        if (stdin_pipe_[1] != -1) {
+            reactor_->remove(stdin_pipe_[1]);
+        }
+        
+        // Without a read thread to do it on exit, nobody else answers the requests still waiting
+        output_closed_ = true;
+        fail_pending_requests("Server process stopped");
+    }
+    
+    wake_read_thread();
+    
+    if (read_thread_ && read_thread_->joinable()) {
+        read_thread_->join();
+    }
+    
+    // Close pipes (the write queue no longer uses the descriptor)
     if (stdin_pipe_[1] != -1) {
         close(stdin_pipe_[1]);
         stdin_pipe_[1] = -1;
@@ -544,9 +788,12 @@ void stdio_client::stop_server_process() {
         stdout_pipe_[0] = -1;
     }
     
-    // Wait for read thread to finish
-    if (read_thread_ && read_thread_->joinable()) {
-        read_thread_->join();
+    if (wakeup_fd_[0] != -1) {
+        close(wakeup_fd_[0]);
+        if (wakeup_fd_[1] != wakeup_fd_[0]) {
+            close(wakeup_fd_[1]);
+        }
+        wakeup_fd_[0] = wakeup_fd_[1] = -1;
     }
     
     // Terminate process
@@ -558,18 +805,17 @@ void stdio_client::stop_server_process() {
         int status;
         pid_t result = waitpid(process_id_, &status, WNOHANG);
         
-        if (result == 0) {
-            // Process is still running, wait for a while
-            std::this_thread::sleep_for(std::chrono::seconds(2));
-            
+        // Process is still running, give it up to 2 seconds to exit
+        for (int waited = 0; result == 0 && waited < 2000; waited += 10) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
             result = waitpid(process_id_, &status, WNOHANG);
-            
-            if (result == 0) {
-                // Process is still running, force termination
-                LOG_WARNING("Process did not terminate, sending SIGKILL");
-                kill(process_id_, SIGKILL);
-                waitpid(process_id_, &status, 0);
-            }
+        }
+        
+        if (result == 0) {
+            // Process is still running, force termination
+            LOG_WARNING("Process did not terminate, sending SIGKILL");
+            kill(process_id_, SIGKILL);
+            waitpid(process_id_, &status, 0);
         }
         
         process_id_ = -1;
@@ -582,12 +828,9 @@ void stdio_client::stop_server_process() {
 void stdio_client::read_thread_func() {
     LOG_INFO("Read thread started");
     
-    const int buffer_size = 4096;
-    char buffer[buffer_size];
-    std::string data_buffer;
-    
 #if defined(_WIN32)
     // Windows implementation
+    std::string_view line;
     DWORD bytes_read;
     int retry_count = 0;
     
@@ -596,58 +839,18 @@ void stdio_client::read_thread_func() {
     
     while (running_) {
         // Read data
-        BOOL success = ReadFile(stdout_pipe_[0], buffer, buffer_size - 1, &bytes_read, NULL);
+        auto [space, capacity] = read_buffer_.prepare();
+        BOOL success = ReadFile(stdout_pipe_[0], space, static_cast<DWORD>(capacity), &bytes_read, NULL);
         
         if (success && bytes_read > 0) {
             // Successfully read data
             retry_count = 0;  // Reset retry count
-            buffer[bytes_read] = '\0';
-            data_buffer.append(buffer, bytes_read);
+            read_buffer_.commit(bytes_read);
             
             // Process complete JSON-RPC message
-            size_t pos = 0;
-            while ((pos = data_buffer.find('\n')) != std::string::npos) {
-                std::string line = data_buffer.substr(0, pos);
-                data_buffer.erase(0, pos + 1);
-                
+            while (read_buffer_.next_line(line)) {
                 if (!line.empty()) {
-                    try {
-                        json message = json::parse(line);
-                        
-                        if (message.contains("jsonrpc") && message["jsonrpc"] == "2.0") {
-                            if (message.contains("id") && !message["id"].is_null()) {
-                                // This is a response
-                                json id = message["id"];
-                                
-                                std::lock_guard<std::mutex> lock(response_mutex_);
-                                auto it = pending_requests_.find(id);
-                                
-                                if (it != pending_requests_.end()) {
-                                    if (message.contains("result")) {
-                                        it->second.set_value(message["result"]);
-                                    } else if (message.contains("error")) {
-                                        json error_result = {
-                                            {"isError", true},
-                                            {"error", message["error"]}
-                                        };
-                                        it->second.set_value(error_result);
-                                    } else {
-                                        it->second.set_value(json::object());
-                                    }
-                                    
-                                    pending_requests_.erase(it);
-                                } else {
-                                    LOG_WARNING("Received response for unknown request ID: ", id);
-                                }
-                            } else if (message.contains("method")) {
-                                // This is a request or notification
-                                LOG_INFO("Received request/notification: ", message["method"]);
-                                // Currently not handling requests from the server
-                            }
-                        }
-                    } catch (const json::exception& e) {
-                        LOG_INFO("message: ", line);
-                    }
+                    handle_line(line);
                 }
             }
         } else if (!success) {
@@ -704,123 +907,235 @@ void stdio_client::read_thread_func() {
         }
     }
 #else
-    // POSIX implementation
+    // POSIX implementation: block in poll() on the pipes and the wakeup descriptor
+    struct pollfd fds[3];
+    fds[0].fd = stdout_pipe_[0];
+    fds[0].events = POLLIN;
+    fds[1].fd = wakeup_fd_[0];
+    fds[1].events = POLLIN;
+    fds[2].fd = stdin_pipe_[1];
+    fds[2].events = POLLOUT;
+    
+    bool writable = true;
     while (running_) {
-        // Read data
-        ssize_t bytes_read = read(stdout_pipe_[0], buffer, buffer_size - 1);
+        fds[0].revents = 0;
+        fds[1].revents = 0;
+        fds[2].revents = 0;
+        
+        // Watch the input pipe only while queued data waits for it
+        nfds_t count = (writable && write_queue_.pending_bytes() > 0) ? 3 : 2;
+        
+        int ready = poll(fds, count, -1);
+        if (ready == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("Error polling pipe: ", strerror(errno));
+            break;
+        }
+        
+        if (fds[1].revents != 0) {
+            // Woken up by stop_server_process() or by a write that left data queued
+            uint64_t drain[8];
+            while (read(wakeup_fd_[0], drain, sizeof(drain)) > 0) {
+            }
+            if (!running_) {
+                break;
+            }
+        }
+        
+        if (fds[2].revents != 0) {
+            if (write_queue_.flush() == write_queue::result::failed || (fds[2].revents & (POLLERR | POLLHUP))) {
+                // The server stopped reading, nothing more can be written
+                write_queue_.close();
+                writable = false;
+            }
+        }
+        
+        if (fds[0].revents != 0 && !read_available()) {
+            break;
+        }
+    }
+#endif
+    
+    // Nobody will answer the requests still waiting
+    output_closed_ = true;
+    fail_pending_requests("Server process closed the connection");
+    
+    LOG_INFO("Read thread stopped");
+}
+
+#if !defined(_WIN32)
+bool stdio_client::read_available() {
+    bool open = true;
+    std::string_view line;
+    
+    // Drain everything that is available, reading straight into the line buffer
+    for (;;) {
+        auto [space, capacity] = read_buffer_.prepare();
+        ssize_t bytes_read = read(stdout_pipe_[0], space, capacity);
         
         if (bytes_read > 0) {
-            buffer[bytes_read] = '\0';
-            data_buffer.append(buffer, bytes_read);
+            read_buffer_.commit(static_cast<size_t>(bytes_read));
             
-            // Process complete JSON-RPC message
-            size_t pos = 0;
-            while ((pos = data_buffer.find('\n')) != std::string::npos) {
-                std::string line = data_buffer.substr(0, pos);
-                data_buffer.erase(0, pos + 1);
-                
+            // Process complete JSON-RPC messages
+            while (read_buffer_.next_line(line)) {
                 if (!line.empty()) {
-                    try {
-                        json message = json::parse(line);
-                        
-                        if (message.contains("jsonrpc") && message["jsonrpc"] == "2.0") {
-                            if (message.contains("id") && !message["id"].is_null()) {
-                                // This is a response
-                                json id = message["id"];
-                                
-                                std::lock_guard<std::mutex> lock(response_mutex_);
-                                auto it = pending_requests_.find(id);
-                                
-                                if (it != pending_requests_.end()) {
-                                    if (message.contains("result")) {
-                                        it->second.set_value(message["result"]);
-                                    } else if (message.contains("error")) {
-                                        json error_result = {
-                                            {"isError", true},
-                                            {"error", message["error"]}
-                                        };
-                                        it->second.set_value(error_result);
-                                    } else {
-                                        it->second.set_value(json::object());
-                                    }
-                                    
-                                    pending_requests_.erase(it);
-                                } else {
-                                    LOG_WARNING("Received response for unknown request ID: ", id);
-                                }
-                            } else if (message.contains("method")) {
-                                // This is a request or notification
-                                LOG_INFO("Received request/notification: ", message["method"]);
-                                // Currently not handling requests from the server
-                            }
-                        }
-                    } catch (const json::exception& e) {
-                        LOG_INFO("message: ", line);
-                    }
+                    handle_line(line);
                 }
             }
-        } else if (bytes_read == 0) {
+            continue;
+        }
+        
+        if (bytes_read == 0) {
             // Pipe is closed
             LOG_WARNING("Pipe closed by server");
-            break;
-        } else if (bytes_read == -1) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // No data to read in non-blocking mode
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            } else {
-                LOG_ERROR("Error reading from pipe: ", strerror(errno));
-                break;
-            }
+            open = false;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            LOG_ERROR("Error reading from pipe: ", strerror(errno));
+            open = false;
         }
+        break;
     }
+    
+    return open;
+}
 #endif
+
+void stdio_client::handle_line(std::string_view line) {
+    try {
+        json message = json::parse(line.data(), line.data() + line.size());
+        
+        if (message.contains("jsonrpc") && message["jsonrpc"] == "2.0") {
+            // Progress of streaming calls is queued for their listeners before the responses that follow it
+            if (deliver_tool_stream(message, dispatcher_)) {
+                return;
+            }
+            
+            // Requests and notifications from the server run on the dispatcher's executor
+            bool dispatched = dispatcher_.dispatch(message, [this](const json& response) {
+                std::string data;
+                dump_to(data, response);
+                data += '\n';
+                if (!write_message(std::move(data))) {
+                    throw mcp_exception(error_code::internal_error, "Failed to write to pipe");
+                }
+            });
+            
+            if (!dispatched && message.contains("id") && !message["id"].is_null()) {
+                // This is a response
+                json id = message["id"];
+                
+                std::lock_guard<std::mutex> lock(response_mutex_);
+                auto it = pending_requests_.find(id);
+                
+                if (it != pending_requests_.end()) {
+                    if (message.contains("result")) {
+                        it->second.set_value(message["result"]);
+                    } else if (message.contains("error")) {
+                        json error_result = {
+                            {"isError", true},
+                            {"error", message["error"]}
+                        };
+                        it->second.set_value(error_result);
+                    } else {
+                        it->second.set_value(json::object());
+                    }
+                    
+                    pending_requests_.erase(it);
+                } else {
+                    LOG_WARNING("Received response for unknown request ID: ", id);
+                }
+            }
+        }
+    } catch (const json::exception& e) {
+        LOG_INFO("message: ", line);
+    }
+}
+
+void stdio_client::fail_pending_requests(const std::string& reason) {
+    std::lock_guard<std::mutex> lock(response_mutex_);
+    for (auto& [id, promise] : pending_requests_) {
+        promise.set_exception(std::make_exception_ptr(mcp_exception(error_code::internal_error, reason)));
+    }
+    pending_requests_.clear();
+}
+
+bool stdio_client::write_message(std::string data) {
+#if defined(_WIN32)
+    // Windows implementation
+    std::lock_guard<std::mutex> lock(write_mutex_);
     
-    LOG_INFO("Read thread stopped");
+    if (stdin_pipe_[1] == NULL) {
+        return false;
+    }
+    
+    DWORD bytes_written;
+    BOOL success = WriteFile(stdin_pipe_[1], data.c_str(), static_cast<DWORD>(data.size()), &bytes_written, NULL);
+    
+    if (!success || bytes_written != static_cast<DWORD>(data.size())) {
+        LOG_ERROR("Failed to write complete message: ", GetLastError());
+        return false;
+    }
+    
+    return true;
+#else
+    // POSIX implementation: never blocks, what the pipe does not accept now is written later
+    return write_queue_.push(std::move(data)) != write_queue::result::failed;
+#endif
 }
 
+#if !defined(_WIN32)
+void stdio_client::wake_read_thread() {
+    if (wakeup_fd_[1] != -1) {
+        uint64_t one = 1;
+        if (write(wakeup_fd_[1], &one, sizeof(one)) == -1 && errno != EAGAIN) {
+            LOG_WARNING("Failed to wake up read thread: ", strerror(errno));
+        }
+    }
+}
+#endif
+
 json stdio_client::send_jsonrpc(const request& req) {
     if (!running_) {
         throw mcp_exception(error_code::internal_error, "Server process not running");
     }
     
-    json req_json = req.to_json();
-    std::string req_str = req_json.dump() + "\n";
-    
-#if defined(_WIN32)
-    // Windows implementation
-    DWORD bytes_written;
-    BOOL success = WriteFile(stdin_pipe_[1], req_str.c_str(), static_cast<DWORD>(req_str.size()), &bytes_written, NULL);
+    std::string req_str;
+    dump_to(req_str, req.to_json());
+    req_str += '\n';
     
-    if (!success || bytes_written != static_cast<DWORD>(req_str.size())) {
-        LOG_ERROR("Failed to write complete request: ", GetLastError());
-        throw mcp_exception(error_code::internal_error, "Failed to write to pipe");
+    // Register the request before writing it, the response may arrive immediately
+    std::future<json> response_future;
+    if (!req.is_notification()) {
+        std::lock_guard<std::mutex> lock(response_mutex_);
+        auto [it, inserted] = pending_requests_.try_emplace(req.id);
+        if (!inserted) {
+            throw mcp_exception(error_code::invalid_request, "Request ID already in use: " + req.id.dump());
+        }
+        response_future = it->second.get_future();
     }
-#else
-    // POSIX implementation
-    ssize_t bytes_written = write(stdin_pipe_[1], req_str.c_str(), req_str.size());
     
-    if (bytes_written != static_cast<ssize_t>(req_str.size())) {
-        LOG_ERROR("Failed to write complete request: ", strerror(errno));
+    if (!write_message(std::move(req_str))) {
+        if (!req.is_notification()) {
+            std::lock_guard<std::mutex> lock(response_mutex_);
+            pending_requests_.erase(req.id);
+        }
         throw mcp_exception(error_code::internal_error, "Failed to write to pipe");
     }
-#endif
     
     // If this is a notification, no need to wait for a response
     if (req.is_notification()) {
         return json::object();
     }
     
-    // Create Promise and Future
-    std::promise<json> response_promise;
-    std::future<json> response_future = response_promise.get_future();
-    
-    {
-        std::lock_guard<std::mutex> lock(response_mutex_);
-        pending_requests_[req.id] = std::move(response_promise);
-    }
-    
     // Wait for response, set timeout
-    const auto timeout = std::chrono::seconds(60);
+    std::chrono::milliseconds timeout = std::chrono::seconds(timeout_seconds_.load());
+    if (auto call_timeout = req.timeout()) {
+        timeout = std::min(timeout, *call_timeout);
+    }
     auto status = response_future.wait_for(timeout);
     
     if (status == std::future_status::ready) {
@@ -838,13 +1153,31 @@ json stdio_client::send_jsonrpc(const request& req) {
         
         return response;
     } else {
+        bool abandoned;
         {
             std::lock_guard<std::mutex> lock(response_mutex_);
-            pending_requests_.erase(req.id);
+            abandoned = pending_requests_.erase(req.id) > 0;
+        }
+        
+        // Let the server stop working on a request nobody waits for
+        if (abandoned) {
+            send_cancelled(req.id, "Timeout waiting for response");
         }
         
         throw mcp_exception(error_code::internal_error, "Timeout waiting for response");
     }
 }
 
+void stdio_client::send_cancelled(const json& id, const std::string& reason) {
+    json params = {{"requestId", id}};
+    if (!reason.empty()) {
+        params["reason"] = reason;
+    }
+    try {
+        send_jsonrpc(request::create_notification("cancelled", params));
+    } catch (const std::exception& e) {
+        LOG_WARNING("Failed to send cancellation of request ", id.dump(), ": ", e.what());
+    }
+}
+
 } // namespace mcp 
@@ -0,0 +1,292 @@
+/**
+ * @file mcp_stdio_pool.cpp
+ * @brief Implementation of the pool of warm stdio MCP server processes
+ */
+
+#include "mcp_stdio_pool.h"
+
+#include <algorithm>
+
+namespace mcp {
+
+namespace {
+
+// Upper bound for waits of the maintenance thread
+constexpr std::chrono::seconds max_wait(60);
+
+} // namespace
+
+stdio_client_pool::lease::lease(lease&& other) noexcept
+    : owner_(std::move(other.owner_)), entry_(std::move(other.entry_)), invalid_(other.invalid_) {
+}
+
+stdio_client_pool::lease& stdio_client_pool::lease::operator=(lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        owner_ = std::move(other.owner_);
+        entry_ = std::move(other.entry_);
+        invalid_ = other.invalid_;
+    }
+    return *this;
+}
+
+stdio_client_pool::lease::~lease() {
+    release();
+}
+
+void stdio_client_pool::lease::release() {
+    if (entry_) {
+        std::unique_lock<std::mutex> lock(owner_->mutex);
+        if (owner_->pool) {
+            owner_->pool->give_back(std::move(entry_), invalid_);
+        } else {
+            // The pool is gone, stop the process here (outside the lock)
+            std::unique_ptr<entry> orphan = std::move(entry_);
+            lock.unlock();
+            orphan.reset();
+        }
+    }
+    owner_.reset();
+    invalid_ = false;
+}
+
+stdio_client_pool::stdio_client_pool(const std::string& command, const configuration& conf)
+    : command_(command), conf_(conf), owner_(std::make_shared<owner>()) {
+    owner_->pool = this;
+    if (conf_.max_idle == 0) {
+        conf_.max_idle = 2 * conf_.size;
+    }
+    conf_.max_idle = std::max(conf_.max_idle, conf_.size);
+
+    LOG_INFO("Creating stdio client pool of ", conf_.size, " processes for command: ", command);
+    maintainer_ = std::thread(&stdio_client_pool::maintain, this);
+}
+
+stdio_client_pool::~stdio_client_pool() {
+    // Leases released from now on no longer reach the pool; one returning a client right now is waited for
+    {
+        std::lock_guard<std::mutex> lock(owner_->mutex);
+        owner_->pool = nullptr;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    available_cv_.notify_all();
+
+    if (maintainer_.joinable()) {
+        maintainer_.join();
+    }
+
+    if (leased_ > 0) {
+        LOG_WARNING("Destroying stdio client pool with ", leased_, " leased clients, they are stopped when released");
+    }
+
+    // Stopping a process may take a while, stop them in parallel
+    std::vector<std::unique_ptr<entry>> remaining = std::move(retired_);
+    for (auto& e : idle_) {
+        remaining.push_back(std::move(e));
+    }
+    idle_.clear();
+
+    std::vector<std::thread> stoppers;
+    for (auto& e : remaining) {
+        stoppers.emplace_back([e = std::move(e)]() mutable { e.reset(); });
+    }
+    for (auto& thread : stoppers) {
+        thread.join();
+    }
+}
+
+stdio_client_pool::lease stdio_client_pool::acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const auto deadline = std::chrono::steady_clock::now() + conf_.acquire_timeout;
+
+    for (;;) {
+        if (stopping_) {
+            throw mcp_exception(error_code::internal_error, "stdio client pool is stopping");
+        }
+
+        while (!idle_.empty()) {
+            // Most recently returned first, its process is the warmest
+            std::unique_ptr<entry> e = std::move(idle_.back());
+            idle_.pop_back();
+            work_cv_.notify_one();
+
+            if (!e->client->is_running()) {
+                LOG_WARNING("Discarding pooled server process that exited");
+                retired_.push_back(std::move(e));
+                continue;
+            }
+
+            ++e->uses;
+            ++leased_;
+            return lease(owner_, std::move(e));
+        }
+
+        if (!available_cv_.wait_until(lock, deadline, [this]() { return stopping_ || !idle_.empty(); })) {
+            throw mcp_exception(error_code::internal_error, "Timeout waiting for a pooled server process");
+        }
+    }
+}
+
+size_t stdio_client_pool::idle_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_.size();
+}
+
+size_t stdio_client_pool::leased_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return leased_;
+}
+
+bool stdio_client_pool::wait_ready(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return available_cv_.wait_for(lock, timeout, [this]() { return stopping_ || idle_.size() >= conf_.size; }) && !stopping_;
+}
+
+void stdio_client_pool::give_back(std::unique_ptr<entry> e, bool invalid) {
+    bool reusable = !invalid && e->client->is_running() && (conf_.max_uses == 0 || e->uses < conf_.max_uses);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --leased_;
+
+        if (reusable && !stopping_ && idle_.size() < conf_.max_idle) {
+            idle_.push_back(std::move(e));
+            available_cv_.notify_one();
+        } else {
+            retired_.push_back(std::move(e));
+        }
+    }
+
+    work_cv_.notify_one();
+}
+
+void stdio_client_pool::maintain() {
+    const bool health_checks = conf_.health_check_interval.count() > 0;
+    std::chrono::milliseconds backoff(0);
+    auto next_spawn = std::chrono::steady_clock::now();
+    auto next_check = next_spawn + conf_.health_check_interval;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        // Stop retired processes outside the lock
+        if (!retired_.empty()) {
+            std::vector<std::unique_ptr<entry>> retired = std::move(retired_);
+            retired_.clear();
+            lock.unlock();
+            retired.clear();
+            lock.lock();
+            continue;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+
+        // Refill, backing off while processes fail to start
+        if (idle_.size() < conf_.size && now >= next_spawn) {
+            lock.unlock();
+            std::unique_ptr<entry> e = spawn();
+            lock.lock();
+
+            if (e) {
+                backoff = std::chrono::milliseconds(0);
+                idle_.push_back(std::move(e));
+                available_cv_.notify_all();
+            } else {
+                backoff = std::min<std::chrono::milliseconds>(std::max<std::chrono::milliseconds>(backoff * 2, std::chrono::milliseconds(100)), std::chrono::seconds(10));
+                next_spawn = std::chrono::steady_clock::now() + backoff;
+            }
+            continue;
+        }
+
+        if (health_checks && now >= next_check) {
+            lock.unlock();
+            check_health();
+            lock.lock();
+            next_check = std::chrono::steady_clock::now() + conf_.health_check_interval;
+            continue;
+        }
+
+        auto wake = now + max_wait;
+        if (health_checks) {
+            wake = std::min(wake, next_check);
+        }
+        if (idle_.size() < conf_.size) {
+            wake = std::min(wake, next_spawn);
+        }
+
+        work_cv_.wait_until(lock, wake, [this, &next_spawn]() {
+            return stopping_ || !retired_.empty() ||
+                (idle_.size() < conf_.size && std::chrono::steady_clock::now() >= next_spawn);
+        });
+    }
+}
+
+std::unique_ptr<stdio_client_pool::entry> stdio_client_pool::spawn() {
+    auto client = std::make_unique<stdio_client>(command_, conf_.env_vars, conf_.capabilities);
+#if !defined(_WIN32)
+    if (conf_.reactor) {
+        client->set_io_reactor(conf_.reactor);
+    }
+#endif
+
+    if (!client->initialize(conf_.client_name, conf_.client_version)) {
+        LOG_ERROR("Failed to start pooled server process: ", command_);
+        return nullptr;
+    }
+
+    auto e = std::make_unique<entry>();
+    e->client = std::move(client);
+    e->last_checked = std::chrono::steady_clock::now();
+    return e;
+}
+
+void stdio_client_pool::check_health() {
+    const auto started = std::chrono::steady_clock::now();
+    const json params = {{"_meta", {{"timeoutMs", conf_.health_check_timeout.count()}}}};
+
+    // Only the client being pinged is out of the pool, the others stay available to acquire()
+    for (;;) {
+        std::unique_ptr<entry> e;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) {
+                return;
+            }
+            auto it = std::find_if(idle_.begin(), idle_.end(), [this, started](const std::unique_ptr<entry>& candidate) {
+                return started - candidate->last_checked >= conf_.health_check_interval;
+            });
+            if (it == idle_.end()) {
+                return;
+            }
+            e = std::move(*it);
+            idle_.erase(it);
+        }
+
+        bool healthy = false;
+        if (e->client->is_running()) {
+            try {
+                e->client->send_request("ping", params);
+                healthy = true;
+            } catch (const mcp_exception& ex) {
+                LOG_WARNING("Health check ping failed: ", ex.what());
+            }
+        }
+        e->last_checked = std::chrono::steady_clock::now();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (healthy && !stopping_) {
+            idle_.push_back(std::move(e));
+            available_cv_.notify_one();
+        } else {
+            if (!healthy) {
+                LOG_WARNING("Pooled server process failed health check, replacing it");
+            }
+            retired_.push_back(std::move(e));
+        }
+    }
+}
+
+} // namespace mcp
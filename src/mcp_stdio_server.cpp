@@ -0,0 +1,423 @@
+/**
+ * @file mcp_stdio_server.cpp
+ * @brief Implementation of the MCP stdio server transport
+ */
+
+#include "mcp_stdio_server.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <io.h>
+#else
+#include "mcp_write_queue.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include <vector>
+
+namespace mcp {
+
+namespace {
+
+// Serialize a message followed by the newline delimiter
+std::string make_line(const json& message) {
+    std::string data;
+    dump_to(data, message);
+    data += '\n';
+    return data;
+}
+
+} // namespace
+
+stdio_server::stdio_server(std::shared_ptr<server> mcp_server, const configuration& conf)
+    : server_(std::move(mcp_server)), conf_(conf) {
+#if !defined(_WIN32)
+    if (pipe(wakeup_fd_) == -1) {
+        LOG_ERROR("Failed to create wakeup pipe: ", strerror(errno));
+        wakeup_fd_[0] = wakeup_fd_[1] = -1;
+    } else {
+        for (int fd : wakeup_fd_) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+    }
+#endif
+}
+
+stdio_server::~stdio_server() {
+    stop();
+
+#if !defined(_WIN32)
+    for (int fd : wakeup_fd_) {
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+#endif
+}
+
+bool stdio_server::start(bool blocking) {
+    if (running_) {
+        return true;  // Already running
+    }
+
+    if (!server_) {
+        LOG_ERROR("No MCP server to serve over stdio");
+        return false;
+    }
+
+#if !defined(_WIN32)
+    if (wakeup_fd_[0] == -1) {
+        return false;
+    }
+#endif
+
+    // A previous run must be fully finished before the state is reset
+    if (reader_.joinable()) {
+        reader_.join();
+    }
+    finish();
+
+    session_id_ = server_->generate_session_id();
+    read_buffer_.clear();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        output_.clear();
+        output_done_ = false;
+        output_failed_ = false;
+        finished_ = false;
+    }
+
+    server_->open_stream_session(session_id_, [this](const json& message) {
+        return enqueue_output(make_line(message));
+    });
+
+    writer_ = std::thread(&stdio_server::write_loop, this);
+    running_ = true;
+
+    LOG_INFO("Serving MCP over stdio, session_id: ", session_id_);
+
+    if (blocking) {
+        read_loop();
+        finish();
+    } else {
+        reader_ = std::thread(&stdio_server::read_loop, this);
+    }
+    return true;
+}
+
+void stdio_server::stop() {
+    running_ = false;
+
+#if defined(_WIN32)
+    // Interrupt a ReadFile() that is waiting for input
+    if (reader_.joinable()) {
+        CancelSynchronousIo(reader_.native_handle());
+    }
+#else
+    if (wakeup_fd_[1] != -1) {
+        char one = 1;
+        if (write(wakeup_fd_[1], &one, sizeof(one)) == -1 && errno != EAGAIN) {
+            LOG_WARNING("Failed to wake up stdio reader: ", strerror(errno));
+        }
+    }
+#endif
+
+    if (reader_.joinable() && reader_.get_id() != std::this_thread::get_id()) {
+        reader_.join();
+    }
+
+    finish();
+}
+
+bool stdio_server::is_running() const {
+    return running_;
+}
+
+size_t stdio_server::pending_requests() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return in_flight_;
+}
+
+void stdio_server::read_loop() {
+    std::string_view line;
+
+#if defined(_WIN32)
+    HANDLE input = reinterpret_cast<HANDLE>(_get_osfhandle(conf_.input_fd));
+
+    while (running_) {
+        auto [space, capacity] = read_buffer_.prepare();
+        DWORD bytes_read = 0;
+        if (!ReadFile(input, space, static_cast<DWORD>(capacity), &bytes_read, nullptr) || bytes_read == 0) {
+            break;
+        }
+        read_buffer_.commit(bytes_read);
+
+        while (read_buffer_.next_line(line)) {
+            if (!line.empty()) {
+                handle_line(line);
+            }
+        }
+    }
+#else
+    struct pollfd fds[2];
+    fds[0].fd = conf_.input_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = wakeup_fd_[0];
+    fds[1].events = POLLIN;
+
+    while (running_) {
+        fds[0].revents = 0;
+        fds[1].revents = 0;
+
+        // The input descriptor is left blocking, it may be shared with other processes
+        if (poll(fds, 2, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("Error polling input: ", strerror(errno));
+            break;
+        }
+
+        if (fds[1].revents != 0) {
+            // Woken up by stop()
+            char drain[16];
+            while (read(wakeup_fd_[0], drain, sizeof(drain)) > 0) {
+            }
+            continue;
+        }
+
+        if (fds[0].revents == 0) {
+            continue;
+        }
+
+        auto [space, capacity] = read_buffer_.prepare();
+        ssize_t bytes_read = read(conf_.input_fd, space, capacity);
+
+        if (bytes_read > 0) {
+            read_buffer_.commit(static_cast<size_t>(bytes_read));
+
+            while (read_buffer_.next_line(line)) {
+                if (!line.empty()) {
+                    handle_line(line);
+                }
+            }
+            continue;
+        }
+
+        if (bytes_read == 0) {
+            LOG_INFO("Input closed by client");
+            break;
+        }
+        if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) {
+            continue;
+        }
+        LOG_ERROR("Error reading input: ", strerror(errno));
+        break;
+    }
+#endif
+
+    running_ = false;
+}
+
+void stdio_server::handle_line(std::string_view line) {
+    json message;
+    try {
+        message = json::parse(line.data(), line.data() + line.size());
+    } catch (const json::exception& e) {
+        LOG_ERROR("Failed to parse JSON request: ", e.what());
+        enqueue_output(make_line(response::create_error(nullptr, error_code::parse_error, "Parse error").to_json()));
+        return;
+    }
+
+    // Responses to server-initiated requests are not tracked
+    if (message.is_object() && !message.contains("method") && (message.contains("result") || message.contains("error"))) {
+        return;
+    }
+
+    request mcp_req;
+    try {
+        mcp_req.jsonrpc = message["jsonrpc"].get<std::string>();
+        if (message.contains("id") && !message["id"].is_null()) {
+            mcp_req.id = message["id"];
+        }
+        mcp_req.method = message["method"].get<std::string>();
+        if (message.contains("params")) {
+            mcp_req.params = std::move(message["params"]);
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR("Failed to create request object: ", e.what());
+        enqueue_output(make_line(response::create_error(mcp_req.id, error_code::invalid_request, "Invalid request format").to_json()));
+        return;
+    }
+
+    // Notifications are handled in order, so a request following notifications/initialized sees the session initialized
+    if (mcp_req.is_notification()) {
+        server_->process_request(mcp_req, session_id_);
+        return;
+    }
+
+    // Requests beyond the server's limits, or with an invalid timeout, are answered with an error at once
+    std::optional<cancellation_token> token;
+    try {
+        token = server_->begin_request(session_id_, mcp_req);
+    } catch (const mcp_exception& e) {
+        LOG_WARNING("Invalid request ", mcp_req.method, ": ", e.what());
+        enqueue_output(make_line(response::create_error(mcp_req.id, e.code(), e.what()).to_json()));
+        return;
+    }
+    if (!token) {
+        LOG_WARNING("Too many requests in flight, rejecting: ", mcp_req.method);
+        enqueue_output(make_line(server_->busy_response(mcp_req, "Too many requests in flight")));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++in_flight_;
+    }
+
+    request queued_req = mcp_req;
+    bool queued = server_->queue_request(session_id_, mcp_req, [this, mcp_req = std::move(queued_req), token = *token]() {
+        // Serialize the response straight into the output line, cancelled requests get none
+        std::string data;
+        try {
+            if (server_->write_tracked_response(mcp_req, session_id_, token, data)) {
+                data += '\n';
+            } else {
+                data.clear();
+            }
+        } catch (const std::exception& e) {
+            LOG_ERROR("Failed to serialize response: ", e.what());
+            data = make_line(response::create_error(mcp_req.id, error_code::internal_error, "Internal error: " + std::string(e.what())).to_json());
+        }
+        if (!data.empty()) {
+            enqueue_output(std::move(data));
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--in_flight_ == 0) {
+            cv_.notify_all();
+        }
+    });
+    if (!queued) {
+        server_->end_request(session_id_, mcp_req.id);
+        LOG_WARNING("Request queue full, rejecting: ", mcp_req.method);
+        enqueue_output(make_line(server_->busy_response(mcp_req, "Server busy")));
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--in_flight_ == 0) {
+            cv_.notify_all();
+        }
+    }
+}
+
+bool stdio_server::enqueue_output(std::string data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (output_done_ || output_failed_) {
+        return false;
+    }
+    output_.push_back(std::move(data));
+    cv_.notify_all();
+    return true;
+}
+
+void stdio_server::write_loop() {
+#if !defined(_WIN32)
+    // A client that closed its end must not kill the process with SIGPIPE
+    sigset_t pipe_set;
+    sigemptyset(&pipe_set);
+    sigaddset(&pipe_set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipe_set, nullptr);
+#else
+    HANDLE output = reinterpret_cast<HANDLE>(_get_osfhandle(conf_.output_fd));
+#endif
+
+    std::deque<std::string> batch;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait(lock, [this]() { return !output_.empty() || output_done_; });
+        if (output_.empty()) {
+            break;
+        }
+
+        // Everything queued so far goes out together
+        batch.swap(output_);
+        lock.unlock();
+
+        bool ok = true;
+#if defined(_WIN32)
+        std::string data;
+        for (const auto& message : batch) {
+            data += message;
+        }
+        size_t offset = 0;
+        while (ok && offset < data.size()) {
+            DWORD written = 0;
+            ok = WriteFile(output, data.data() + offset, static_cast<DWORD>(data.size() - offset), &written, nullptr) != 0;
+            offset += written;
+        }
+#else
+        // A short write continues inside a message
+        size_t offset = 0;
+        while (!batch.empty()) {
+            if (write_messages(conf_.output_fd, batch, offset) == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                LOG_ERROR("Failed to write output: ", strerror(errno));
+                ok = false;
+                break;
+            }
+        }
+#endif
+        batch.clear();
+
+        lock.lock();
+        if (!ok) {
+            // Nobody reads the responses anymore, stop reading requests as well
+            output_failed_ = true;
+            output_.clear();
+            running_ = false;
+#if !defined(_WIN32)
+            char one = 1;
+            if (write(wakeup_fd_[1], &one, sizeof(one)) == -1 && errno != EAGAIN) {
+                LOG_WARNING("Failed to wake up stdio reader: ", strerror(errno));
+            }
+#endif
+            break;
+        }
+    }
+}
+
+void stdio_server::finish() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (finished_) {
+            return;
+        }
+        finished_ = true;
+
+        // Responses of requests in progress are still written
+        cv_.wait(lock, [this]() { return in_flight_ == 0; });
+        output_done_ = true;
+        cv_.notify_all();
+    }
+
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+
+    server_->close_stream_session(session_id_);
+    LOG_INFO("Stdio session closed: ", session_id_);
+}
+
+} // namespace mcp
@@ -98,6 +98,21 @@ tool_builder& tool_builder::with_object_param(const std::string& name,
     return *this;
 }
 
+tool_builder& tool_builder::with_read_only_hint(bool read_only) {
+    annotations_["readOnlyHint"] = read_only;
+    return *this;
+}
+
+tool_builder& tool_builder::with_idempotent_hint(bool idempotent) {
+    annotations_["idempotentHint"] = idempotent;
+    return *this;
+}
+
+tool_builder& tool_builder::with_destructive_hint(bool destructive) {
+    annotations_["destructiveHint"] = destructive;
+    return *this;
+}
+
 tool tool_builder::build() const {
     tool t;
     t.name = name_;
@@ -112,6 +127,7 @@ tool tool_builder::build() const {
     }
     
     t.parameters_schema = schema;
+    t.annotations = annotations_;
     
     return t;
 }
@@ -0,0 +1,169 @@
+/**
+ * @file mcp_tool_cache.cpp
+ * @brief Implementation of the client-side cache of tool call results
+ */
+
+#include "mcp_tool_cache.h"
+
+#include <optional>
+
+namespace mcp {
+
+tool_result_cache::tool_result_cache(const configuration& conf)
+    : conf_(conf) {
+}
+
+std::shared_ptr<tool_result_cache> tool_result_cache::shared() {
+    static std::shared_ptr<tool_result_cache> cache = std::make_shared<tool_result_cache>();
+    return cache;
+}
+
+void tool_result_cache::set_policy(const std::string& scope, const std::string& tool_name, const policy& p) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    policies_[{scope, tool_name}] = p;
+}
+
+void tool_result_cache::set_tools(const std::string& scope, const std::vector<tool>& tools) {
+    std::set<std::string> cacheable;
+    for (const auto& t : tools) {
+        // Read-only tools, and idempotent ones explicitly marked as not destructive
+        bool not_destructive = t.annotations.contains("destructiveHint") &&
+            t.annotations["destructiveHint"].is_boolean() && !t.annotations["destructiveHint"].get<bool>();
+        if (t.has_hint("readOnlyHint") || (t.has_hint("idempotentHint") && not_destructive)) {
+            cacheable.insert(t.name);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    cacheable_tools_[scope] = std::move(cacheable);
+}
+
+json tool_result_cache::call(const std::string& scope, const std::string& tool_name, const json& arguments,
+    const std::function<json()>& call) {
+    std::optional<policy> p;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (const policy* found = find_policy(scope, tool_name)) {
+            p = *found;
+        }
+    }
+    if (!p) {
+        return call();
+    }
+
+    // Scope and tool name are followed by a NUL, they cannot run into each other
+    std::string key = scope;
+    key += '\0';
+    key += tool_name;
+    key += '\0';
+    dump_canonical_to(key, arguments);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            if (it->second->expires > std::chrono::steady_clock::now()) {
+                entries_.splice(entries_.begin(), entries_, it->second);
+                ++stats_.hits;
+                return it->second->result;
+            }
+            erase(it->second);
+        }
+        ++stats_.misses;
+    }
+
+    json result = call();
+
+    auto is_error = result.find("isError");
+    if (is_error != result.end() && is_error->is_boolean() && is_error->get<bool>()) {
+        return result;
+    }
+
+    size_t bytes = key.size() + result.dump().size();
+    if (bytes > conf_.max_bytes) {
+        return result;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // A concurrent call of the same tool may have stored its result meanwhile
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        erase(it->second);
+    }
+
+    // Make room: the tool's least recently used results first, then the cache's
+    if (p->max_entries > 0) {
+        auto count = tool_entries_.find({scope, tool_name});
+        size_t held = count != tool_entries_.end() ? count->second : 0;
+        for (auto victim = entries_.end(); held >= p->max_entries && victim != entries_.begin();) {
+            --victim;
+            if (victim->scope == scope && victim->tool_name == tool_name) {
+                auto oldest = victim++;
+                erase(oldest);
+                --held;
+                ++stats_.evictions;
+            }
+        }
+    }
+    while (stats_.bytes + bytes > conf_.max_bytes && !entries_.empty()) {
+        erase(std::prev(entries_.end()));
+        ++stats_.evictions;
+    }
+
+    entries_.push_front(entry{key, scope, tool_name, result, bytes, std::chrono::steady_clock::now() + p->ttl});
+    index_[std::move(key)] = entries_.begin();
+    ++tool_entries_[{scope, tool_name}];
+    stats_.bytes += bytes;
+
+    return result;
+}
+
+void tool_result_cache::invalidate(const std::string& scope, const std::string& tool_name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        auto next = std::next(it);
+        if ((scope.empty() || it->scope == scope) && (tool_name.empty() || it->tool_name == tool_name)) {
+            erase(it);
+        }
+        it = next;
+    }
+}
+
+tool_result_cache::statistics tool_result_cache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    statistics stats = stats_;
+    stats.entries = entries_.size();
+    return stats;
+}
+
+const tool_result_cache::policy* tool_result_cache::find_policy(const std::string& scope, const std::string& tool_name) const {
+    // A policy for the tool on this server takes precedence over one for every server
+    auto policy_it = policies_.find({scope, tool_name});
+    if (policy_it == policies_.end()) {
+        policy_it = policies_.find({any_scope, tool_name});
+    }
+    if (policy_it != policies_.end()) {
+        return policy_it->second.ttl.count() > 0 ? &policy_it->second : nullptr;
+    }
+
+    auto scope_it = cacheable_tools_.find(scope);
+    if (scope_it != cacheable_tools_.end() && scope_it->second.count(tool_name) && conf_.annotated.ttl.count() > 0) {
+        return &conf_.annotated;
+    }
+    return nullptr;
+}
+
+void tool_result_cache::erase(std::list<entry>::iterator it) {
+    stats_.bytes -= it->bytes;
+
+    auto count = tool_entries_.find({it->scope, it->tool_name});
+    if (count != tool_entries_.end() && --count->second == 0) {
+        tool_entries_.erase(count);
+    }
+
+    index_.erase(it->key);
+    entries_.erase(it);
+}
+
+} // namespace mcp
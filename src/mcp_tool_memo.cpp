@@ -0,0 +1,107 @@
+/**
+ * @file mcp_tool_memo.cpp
+ * @brief Implementation of the memoization of pure tools
+ */
+
+#include "mcp_tool_memo.h"
+#include "mcp_cancellation.h"
+
+#include <algorithm>
+
+namespace mcp {
+
+tool_memo::tool_memo(std::function<json(const json&, const std::string&)> handler, const configuration& conf)
+    : handler_(std::move(handler)), conf_(conf) {
+    conf_.max_entries = std::max<size_t>(conf_.max_entries, 1);
+}
+
+json tool_memo::call(const json& arguments, const std::string& session_id) {
+    std::string key;
+    dump_canonical_to(key, arguments);
+
+    // The request this call belongs to
+    const cancellation_token& token = cancellation_token::current();
+
+    std::promise<std::optional<json>> promise;
+    uint64_t generation;
+    for (;;) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            entries_.splice(entries_.begin(), entries_, it->second);
+            ++stats_.hits;
+            return it->second->result;
+        }
+
+        // Wait for a call with the same arguments instead of running the handler again
+        auto flight = in_flight_.find(key);
+        if (flight != in_flight_.end()) {
+            std::shared_future<std::optional<json>> result = flight->second;
+            ++stats_.coalesced;
+            lock.unlock();
+
+            // The token cannot be waited on, it is polled while the result is not ready
+            while (result.wait_for(std::chrono::milliseconds(10)) != std::future_status::ready) {
+                token.throw_if_cancelled();
+            }
+            std::optional<json> shared = result.get();
+            if (shared) {
+                return std::move(*shared);
+            }
+            continue;
+        }
+
+        in_flight_.emplace(key, promise.get_future().share());
+        generation = generation_;
+        ++stats_.misses;
+        break;
+    }
+
+    json result;
+    try {
+        result = handler_(arguments, session_id);
+    } catch (...) {
+        // The waiters of a cancelled call retry rather than fail with it
+        if (token.is_cancelled()) {
+            promise.set_value(std::nullopt);
+        } else {
+            promise.set_exception(std::current_exception());
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        in_flight_.erase(key);
+        throw;
+    }
+
+    // A handler may have stopped early because the request was cancelled or its deadline passed
+    bool complete = !token.is_cancelled();
+    promise.set_value(complete ? std::optional<json>(result) : std::nullopt);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    in_flight_.erase(key);
+    if (complete && generation == generation_) {
+        if (entries_.size() >= conf_.max_entries) {
+            index_.erase(entries_.back().key);
+            entries_.pop_back();
+            ++stats_.evictions;
+        }
+        entries_.push_front(entry{key, result});
+        index_.emplace(std::move(key), entries_.begin());
+    }
+    return result;
+}
+
+void tool_memo::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    index_.clear();
+    ++generation_;
+}
+
+tool_memo::statistics tool_memo::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    statistics stats = stats_;
+    stats.entries = entries_.size();
+    return stats;
+}
+
+} // namespace mcp
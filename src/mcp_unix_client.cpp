@@ -0,0 +1,567 @@
+/**
+ * @file mcp_unix_client.cpp
+ * @brief Implementation of the MCP Unix domain socket client
+ */
+
+#if !defined(_WIN32)
+
+#include "mcp_unix_client.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace mcp {
+
+unix_client::unix_client(const std::string& socket_path, const json& capabilities)
+    : socket_path_(socket_path), capabilities_(capabilities) {
+
+    LOG_INFO("Creating MCP Unix domain socket client for: ", socket_path);
+}
+
+unix_client::~unix_client() {
+    disconnect();
+}
+
+bool unix_client::initialize(const std::string& client_name, const std::string& client_version) {
+    LOG_INFO("Initializing MCP Unix domain socket client...");
+
+    if (!connect_socket()) {
+        LOG_ERROR("Failed to connect to server socket");
+        return false;
+    }
+
+    request req = request::create("initialize", {
+        {"protocolVersion", MCP_VERSION},
+        {"capabilities", capabilities_},
+        {"clientInfo", {
+            {"name", client_name},
+            {"version", client_version}
+        }}
+    });
+
+    try {
+        json result = send_jsonrpc(req);
+
+        server_capabilities_ = result["capabilities"];
+
+        request notification = request::create_notification("initialized");
+        send_jsonrpc(notification);
+
+        return true;
+    } catch (const std::exception& e) {
+        LOG_ERROR("Initialization failed: ", e.what());
+        disconnect();
+        return false;
+    }
+}
+
+bool unix_client::ping() {
+    if (!running_) {
+        return false;
+    }
+
+    request req = request::create("ping", {});
+
+    try {
+        json result = send_jsonrpc(req);
+        return result.empty();
+    } catch (...) {
+        return false;
+    }
+}
+
+void unix_client::set_timeout(int timeout_seconds) {
+    timeout_seconds_ = timeout_seconds;
+}
+
+void unix_client::set_capabilities(const json& capabilities) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capabilities_ = capabilities;
+}
+
+response unix_client::send_request(const std::string& method, const json& params) {
+    return send_prepared_request(request::create(method, params));
+}
+
+response unix_client::send_prepared_request(const request& req) {
+    if (!running_) {
+        throw mcp_exception(error_code::internal_error, "Not connected");
+    }
+    if (req.is_notification()) {
+        throw mcp_exception(error_code::invalid_request, "Request has no ID: " + req.method);
+    }
+
+    json result = send_jsonrpc(req);
+
+    response res;
+    res.jsonrpc = "2.0";
+    res.id = req.id;
+    res.result = result;
+
+    return res;
+}
+
+bool unix_client::cancel_request(const json& id, const std::string& reason) {
+    {
+        std::lock_guard<std::mutex> lock(response_mutex_);
+        auto it = pending_requests_.find(id);
+        if (it == pending_requests_.end()) {
+            return false;
+        }
+        it->second.set_exception(std::make_exception_ptr(mcp_exception(error_code::internal_error, "Request cancelled")));
+        pending_requests_.erase(it);
+    }
+
+    send_cancelled(id, reason);
+    return true;
+}
+
+void unix_client::send_notification(const std::string& method, const json& params) {
+    if (!running_) {
+        throw mcp_exception(error_code::internal_error, "Not connected");
+    }
+
+    request req = request::create_notification(method, params);
+    send_jsonrpc(req);
+}
+
+json unix_client::get_server_capabilities() {
+    return server_capabilities_;
+}
+
+json unix_client::call_tool(const std::string& tool_name, const json& arguments) {
+    return cached_tool_call(tool_name, arguments, [&]() {
+        return send_request("tools/call", {
+            {"name", tool_name},
+            {"arguments", arguments}
+        }).result;
+    });
+}
+
+std::vector<tool> unix_client::get_tools() {
+    json response_json = send_request("tools/list", {}).result;
+    std::vector<tool> tools;
+
+    json tools_json;
+    if (response_json.contains("tools") && response_json["tools"].is_array()) {
+        tools_json = response_json["tools"];
+    } else if (response_json.is_array()) {
+        tools_json = response_json;
+    } else {
+        return tools;
+    }
+
+    for (const auto& tool_json : tools_json) {
+        tool t;
+        t.name = tool_json["name"];
+        t.description = tool_json["description"];
+
+        if (tool_json.contains("inputSchema")) {
+            t.parameters_schema = tool_json["inputSchema"];
+        }
+
+        if (tool_json.contains("annotations") && tool_json["annotations"].is_object()) {
+            t.annotations = tool_json["annotations"];
+        }
+
+        tools.push_back(t);
+    }
+
+    remember_tools(tools);
+    return tools;
+}
+
+json unix_client::get_capabilities() {
+    return capabilities_;
+}
+
+json unix_client::list_resources(const std::string& cursor) {
+    json params = json::object();
+    if (!cursor.empty()) {
+        params["cursor"] = cursor;
+    }
+    return send_request("resources/list", params).result;
+}
+
+json unix_client::read_resource(const std::string& resource_uri) {
+    return send_request("resources/read", {
+        {"uri", resource_uri}
+    }).result;
+}
+
+json unix_client::subscribe_to_resource(const std::string& resource_uri) {
+    return send_request("resources/subscribe", {
+        {"uri", resource_uri}
+    }).result;
+}
+
+json unix_client::list_resource_templates() {
+    return send_request("resources/templates/list").result;
+}
+
+bool unix_client::is_running() const {
+    return running_ && !connection_closed_;
+}
+
+void unix_client::register_request_handler(const std::string& method, client_request_handler handler) {
+    dispatcher_.register_request_handler(method, std::move(handler));
+}
+
+void unix_client::register_notification_handler(const std::string& method, client_notification_handler handler) {
+    dispatcher_.register_notification_handler(method, std::move(handler));
+}
+
+void unix_client::set_executor(std::shared_ptr<thread_pool> executor) {
+    dispatcher_.set_executor(std::move(executor));
+}
+
+bool unix_client::connect_socket() {
+    if (running_) {
+        LOG_INFO("Already connected");
+        return true;
+    }
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socket_path_.empty() || socket_path_.size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR("Invalid Unix domain socket path: ", socket_path_);
+        return false;
+    }
+    std::memcpy(addr.sun_path, socket_path_.c_str(), socket_path_.size() + 1);
+
+    socket_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socket_fd_ == -1) {
+        LOG_ERROR("Failed to create socket: ", strerror(errno));
+        return false;
+    }
+    fcntl(socket_fd_, F_SETFD, FD_CLOEXEC);
+
+    int result;
+    do {
+        result = connect(socket_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    } while (result == -1 && errno == EINTR);
+
+    if (result == -1) {
+        LOG_ERROR("Failed to connect to ", socket_path_, ": ", strerror(errno));
+        close(socket_fd_);
+        socket_fd_ = -1;
+        return false;
+    }
+
+    if (pipe(wakeup_fd_) == -1) {
+        LOG_ERROR("Failed to create wakeup pipe: ", strerror(errno));
+        wakeup_fd_[0] = wakeup_fd_[1] = -1;
+        close(socket_fd_);
+        socket_fd_ = -1;
+        return false;
+    }
+    for (int fd : wakeup_fd_) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+
+    // Reads drain the socket and writes go through the write queue, neither may block
+    fcntl(socket_fd_, F_SETFL, fcntl(socket_fd_, F_GETFL, 0) | O_NONBLOCK);
+
+    read_buffer_.clear();
+    connection_closed_ = false;
+
+    // Data left in the queue is written by the read thread once the socket accepts it
+    write_queue_.open(socket_fd_, [this](bool pending) {
+        if (pending) {
+            wake_read_thread();
+        }
+    });
+
+    running_ = true;
+
+    read_thread_ = std::make_unique<std::thread>(&unix_client::read_thread_func, this);
+
+    LOG_INFO("Connected to ", socket_path_);
+    return true;
+}
+
+void unix_client::disconnect() {
+    running_ = false;
+
+    // Stop writing and wait for the reader before closing the descriptors it polls
+    write_queue_.close();
+
+    wake_read_thread();
+
+    if (read_thread_ && read_thread_->joinable()) {
+        read_thread_->join();
+    }
+    read_thread_.reset();
+
+    if (socket_fd_ != -1) {
+        close(socket_fd_);
+        socket_fd_ = -1;
+        LOG_INFO("Disconnected from ", socket_path_);
+    }
+
+    for (int& fd : wakeup_fd_) {
+        if (fd != -1) {
+            close(fd);
+            fd = -1;
+        }
+    }
+}
+
+void unix_client::read_thread_func() {
+    LOG_INFO("Read thread started");
+
+    struct pollfd fds[2];
+    fds[0].fd = socket_fd_;
+    fds[1].fd = wakeup_fd_[0];
+    fds[1].events = POLLIN;
+
+    bool writable = true;
+    while (running_) {
+        fds[0].revents = 0;
+        fds[1].revents = 0;
+
+        // Watch for writability only while queued data waits for the socket
+        fds[0].events = POLLIN;
+        if (writable && write_queue_.pending_bytes() > 0) {
+            fds[0].events |= POLLOUT;
+        }
+
+        int ready = poll(fds, 2, -1);
+        if (ready == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("Error polling socket: ", strerror(errno));
+            break;
+        }
+
+        if (fds[1].revents != 0) {
+            // Woken up by disconnect() or by a write that left data queued
+            char drain[16];
+            while (read(wakeup_fd_[0], drain, sizeof(drain)) > 0) {
+            }
+            if (!running_) {
+                break;
+            }
+        }
+
+        if ((fds[0].revents & POLLOUT) != 0) {
+            if (write_queue_.flush() == write_queue::result::failed) {
+                write_queue_.close();
+                writable = false;
+            }
+        }
+
+        if ((fds[0].revents & (POLLIN | POLLHUP | POLLERR)) != 0 && !read_available()) {
+            break;
+        }
+    }
+
+    // Nobody will answer the requests still waiting
+    connection_closed_ = true;
+    fail_pending_requests("Server closed the connection");
+
+    LOG_INFO("Read thread stopped");
+}
+
+bool unix_client::read_available() {
+    bool open = true;
+    std::string_view line;
+
+    // Drain everything that is available, reading straight into the line buffer
+    for (;;) {
+        auto [space, capacity] = read_buffer_.prepare();
+        ssize_t bytes_read = read(socket_fd_, space, capacity);
+
+        if (bytes_read > 0) {
+            read_buffer_.commit(static_cast<size_t>(bytes_read));
+
+            // Process complete JSON-RPC messages
+            while (read_buffer_.next_line(line)) {
+                if (!line.empty()) {
+                    handle_line(line);
+                }
+            }
+            continue;
+        }
+
+        if (bytes_read == 0) {
+            LOG_WARNING("Connection closed by server");
+            open = false;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            LOG_ERROR("Error reading from socket: ", strerror(errno));
+            open = false;
+        }
+        break;
+    }
+
+    return open;
+}
+
+void unix_client::handle_line(std::string_view line) {
+    try {
+        json message = json::parse(line.data(), line.data() + line.size());
+
+        if (message.contains("jsonrpc") && message["jsonrpc"] == "2.0") {
+            // Progress of streaming calls is queued for their listeners before the responses that follow it
+            if (deliver_tool_stream(message, dispatcher_)) {
+                return;
+            }
+
+            // Requests and notifications from the server run on the dispatcher's executor
+            bool dispatched = dispatcher_.dispatch(message, [this](const json& response) {
+                std::string data;
+                dump_to(data, response);
+                data += '\n';
+                if (!write_message(std::move(data))) {
+                    throw mcp_exception(error_code::internal_error, "Failed to write to socket");
+                }
+            });
+
+            if (!dispatched && message.contains("id") && !message["id"].is_null()) {
+                // This is a response
+                json id = message["id"];
+
+                std::lock_guard<std::mutex> lock(response_mutex_);
+                auto it = pending_requests_.find(id);
+
+                if (it != pending_requests_.end()) {
+                    if (message.contains("result")) {
+                        it->second.set_value(std::move(message["result"]));
+                    } else if (message.contains("error")) {
+                        json error_result = {
+                            {"isError", true},
+                            {"error", message["error"]}
+                        };
+                        it->second.set_value(error_result);
+                    } else {
+                        it->second.set_value(json::object());
+                    }
+
+                    pending_requests_.erase(it);
+                } else {
+                    LOG_WARNING("Received response for unknown request ID: ", id);
+                }
+            }
+        }
+    } catch (const json::exception& e) {
+        LOG_INFO("message: ", line);
+    }
+}
+
+void unix_client::fail_pending_requests(const std::string& reason) {
+    std::lock_guard<std::mutex> lock(response_mutex_);
+    for (auto& [id, promise] : pending_requests_) {
+        promise.set_exception(std::make_exception_ptr(mcp_exception(error_code::internal_error, reason)));
+    }
+    pending_requests_.clear();
+}
+
+bool unix_client::write_message(std::string data) {
+    // Never blocks, what the socket does not accept now is written later
+    return write_queue_.push(std::move(data)) != write_queue::result::failed;
+}
+
+void unix_client::wake_read_thread() {
+    if (wakeup_fd_[1] != -1) {
+        char one = 1;
+        if (write(wakeup_fd_[1], &one, sizeof(one)) == -1 && errno != EAGAIN) {
+            LOG_WARNING("Failed to wake up read thread: ", strerror(errno));
+        }
+    }
+}
+
+json unix_client::send_jsonrpc(const request& req) {
+    if (!running_) {
+        throw mcp_exception(error_code::internal_error, "Not connected");
+    }
+
+    std::string req_str;
+    dump_to(req_str, req.to_json());
+    req_str += '\n';
+
+    // Register the request before writing it, the response may arrive immediately
+    std::future<json> response_future;
+    if (!req.is_notification()) {
+        std::lock_guard<std::mutex> lock(response_mutex_);
+        auto [it, inserted] = pending_requests_.try_emplace(req.id);
+        if (!inserted) {
+            throw mcp_exception(error_code::invalid_request, "Request ID already in use: " + req.id.dump());
+        }
+        response_future = it->second.get_future();
+    }
+
+    if (!write_message(std::move(req_str))) {
+        if (!req.is_notification()) {
+            std::lock_guard<std::mutex> lock(response_mutex_);
+            pending_requests_.erase(req.id);
+        }
+        throw mcp_exception(error_code::internal_error, "Failed to write to socket");
+    }
+
+    // If this is a notification, no need to wait for a response
+    if (req.is_notification()) {
+        return json::object();
+    }
+
+    // Wait for response, set timeout
+    std::chrono::milliseconds timeout = std::chrono::seconds(timeout_seconds_.load());
+    if (auto call_timeout = req.timeout()) {
+        timeout = std::min(timeout, *call_timeout);
+    }
+    auto status = response_future.wait_for(timeout);
+
+    if (status == std::future_status::ready) {
+        json response = response_future.get();
+
+        if (response.contains("isError") && response["isError"].is_boolean() && response["isError"].get<bool>()) {
+            if (response.contains("error") && response["error"].is_object()) {
+                const auto& err_obj = response["error"];
+                int code = err_obj.contains("code") ? err_obj["code"].get<int>() : static_cast<int>(error_code::internal_error);
+                std::string message = err_obj.value("message", "");
+                throw mcp_exception(static_cast<error_code>(code), message);
+            }
+        }
+
+        return response;
+    } else {
+        bool abandoned;
+        {
+            std::lock_guard<std::mutex> lock(response_mutex_);
+            abandoned = pending_requests_.erase(req.id) > 0;
+        }
+
+        // Let the server stop working on a request nobody waits for
+        if (abandoned) {
+            send_cancelled(req.id, "Timeout waiting for response");
+        }
+
+        throw mcp_exception(error_code::internal_error, "Timeout waiting for response");
+    }
+}
+
+void unix_client::send_cancelled(const json& id, const std::string& reason) {
+    json params = {{"requestId", id}};
+    if (!reason.empty()) {
+        params["reason"] = reason;
+    }
+    try {
+        send_jsonrpc(request::create_notification("cancelled", params));
+    } catch (const std::exception& e) {
+        LOG_WARNING("Failed to send cancellation of request ", id.dump(), ": ", e.what());
+    }
+}
+
+} // namespace mcp
+
+#endif // !_WIN32
@@ -0,0 +1,289 @@
+/**
+ * @file mcp_unix_server.cpp
+ * @brief Implementation of the MCP Unix domain socket server transport
+ */
+
+#if !defined(_WIN32)
+
+#include "mcp_unix_server.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace mcp {
+
+namespace {
+
+// Interval at which connections closed by their clients are released
+constexpr int reap_interval_ms = 1000;
+
+// Remove a socket file left behind by a server that is gone, so that bind() can succeed.
+// Anything else at the path, including the socket of a running server, is left alone.
+bool remove_stale_socket(const std::string& path, const sockaddr_un& addr) {
+    struct stat st;
+    if (lstat(path.c_str(), &st) == -1) {
+        if (errno == ENOENT) {
+            return true;
+        }
+        LOG_ERROR("Failed to check Unix domain socket path ", path, ": ", strerror(errno));
+        return false;
+    }
+
+    if (!S_ISSOCK(st.st_mode)) {
+        LOG_ERROR("Unix domain socket path exists and is not a socket: ", path);
+        return false;
+    }
+
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe == -1) {
+        LOG_ERROR("Failed to create socket: ", strerror(errno));
+        return false;
+    }
+    int result = connect(probe, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr));
+    int error = errno;
+    close(probe);
+
+    if (result == 0) {
+        LOG_ERROR("Another server is listening on ", path);
+        return false;
+    }
+    if (error != ECONNREFUSED) {
+        LOG_ERROR("Failed to probe Unix domain socket ", path, ": ", strerror(error));
+        return false;
+    }
+
+    if (unlink(path.c_str()) == -1 && errno != ENOENT) {
+        LOG_ERROR("Failed to remove stale Unix domain socket ", path, ": ", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+unix_server::unix_server(std::shared_ptr<server> mcp_server, const configuration& conf)
+    : server_(std::move(mcp_server)), conf_(conf) {
+}
+
+unix_server::~unix_server() {
+    stop();
+}
+
+bool unix_server::start(bool blocking) {
+    if (running_) {
+        return true;  // Already running
+    }
+
+    if (!server_) {
+        LOG_ERROR("No MCP server to serve on a Unix domain socket");
+        return false;
+    }
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (conf_.path.empty() || conf_.path.size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR("Invalid Unix domain socket path: ", conf_.path);
+        return false;
+    }
+    std::memcpy(addr.sun_path, conf_.path.c_str(), conf_.path.size() + 1);
+
+    // A socket file left behind by a previous run would make bind() fail
+    if (!remove_stale_socket(conf_.path, addr)) {
+        return false;
+    }
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd_ == -1) {
+        LOG_ERROR("Failed to create socket: ", strerror(errno));
+        return false;
+    }
+    fcntl(listen_fd_, F_SETFD, FD_CLOEXEC);
+
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1 ||
+        listen(listen_fd_, conf_.backlog) == -1) {
+        LOG_ERROR("Failed to listen on ", conf_.path, ": ", strerror(errno));
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    if (pipe(wakeup_fd_) == -1) {
+        LOG_ERROR("Failed to create wakeup pipe: ", strerror(errno));
+        wakeup_fd_[0] = wakeup_fd_[1] = -1;
+        close(listen_fd_);
+        listen_fd_ = -1;
+        unlink(conf_.path.c_str());
+        return false;
+    }
+    for (int fd : wakeup_fd_) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+
+    running_ = true;
+    LOG_INFO("Serving MCP on Unix domain socket ", conf_.path);
+
+    if (blocking) {
+        accepting_ = true;
+        accept_loop();
+        accepting_ = false;
+        release();
+    } else {
+        acceptor_ = std::thread(&unix_server::accept_loop, this);
+    }
+    return true;
+}
+
+void unix_server::stop() {
+    running_ = false;
+
+    if (wakeup_fd_[1] != -1) {
+        char one = 1;
+        if (write(wakeup_fd_[1], &one, sizeof(one)) == -1 && errno != EAGAIN) {
+            LOG_WARNING("Failed to wake up accept loop: ", strerror(errno));
+        }
+    }
+
+    if (acceptor_.joinable()) {
+        if (acceptor_.get_id() == std::this_thread::get_id()) {
+            return;
+        }
+        acceptor_.join();
+    } else if (accepting_) {
+        // start() releases everything once its accept loop returned
+        return;
+    }
+
+    release();
+}
+
+bool unix_server::is_running() const {
+    return running_;
+}
+
+size_t unix_server::connection_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return connections_.size();
+}
+
+void unix_server::accept_loop() {
+    struct pollfd fds[2];
+    fds[0].fd = listen_fd_;
+    fds[0].events = POLLIN;
+    fds[1].fd = wakeup_fd_[0];
+    fds[1].events = POLLIN;
+
+    while (running_) {
+        fds[0].revents = 0;
+        fds[1].revents = 0;
+
+        int ready = poll(fds, 2, reap_interval_ms);
+        if (ready == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("Error polling listening socket: ", strerror(errno));
+            break;
+        }
+
+        reap_connections();
+
+        if (fds[1].revents != 0 || !running_) {
+            break;
+        }
+        if (fds[0].revents == 0) {
+            continue;
+        }
+
+        int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd == -1) {
+            if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK && errno != ECONNABORTED) {
+                LOG_ERROR("Failed to accept connection: ", strerror(errno));
+            }
+            continue;
+        }
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+        connection conn;
+        conn.fd = fd;
+        conn.transport = std::make_unique<stdio_server>(server_, stdio_server::configuration{fd, fd});
+        if (!conn.transport->start(false)) {
+            LOG_ERROR("Failed to serve connection");
+            close_connection(conn);
+            continue;
+        }
+
+        LOG_INFO("Accepted connection, session_id: ", conn.transport->session_id());
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        connections_.push_back(std::move(conn));
+    }
+
+    running_ = false;
+}
+
+void unix_server::release() {
+    std::list<connection> connections;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connections.swap(connections_);
+    }
+    for (auto& conn : connections) {
+        close_connection(conn);
+    }
+
+    if (listen_fd_ != -1) {
+        close(listen_fd_);
+        listen_fd_ = -1;
+        unlink(conf_.path.c_str());
+        LOG_INFO("Unix domain socket server stopped: ", conf_.path);
+    }
+
+    for (int& fd : wakeup_fd_) {
+        if (fd != -1) {
+            close(fd);
+            fd = -1;
+        }
+    }
+}
+
+void unix_server::reap_connections() {
+    std::list<connection> closed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = connections_.begin(); it != connections_.end();) {
+            auto next = std::next(it);
+            // Requests still in progress are answered before the connection is closed
+            if (!it->transport->is_running() && it->transport->pending_requests() == 0) {
+                closed.splice(closed.end(), connections_, it);
+            }
+            it = next;
+        }
+    }
+
+    for (auto& conn : closed) {
+        close_connection(conn);
+    }
+}
+
+void unix_server::close_connection(connection& conn) {
+    if (conn.transport) {
+        conn.transport->stop();
+        conn.transport.reset();
+    }
+    if (conn.fd != -1) {
+        close(conn.fd);
+        conn.fd = -1;
+    }
+}
+
+} // namespace mcp
+
+#endif // !_WIN32
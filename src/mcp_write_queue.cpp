@@ -0,0 +1,207 @@
+/**
+ * @file mcp_write_queue.cpp
+ * @brief Implementation of the non-blocking outgoing message queue
+ */
+
+#if !defined(_WIN32)
+
+#include "mcp_write_queue.h"
+#include "mcp_logger.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace mcp {
+
+namespace {
+
+// Messages gathered into one writev() call
+#if defined(IOV_MAX)
+constexpr int max_iov = IOV_MAX < 64 ? IOV_MAX : 64;
+#else
+constexpr int max_iov = 16;
+#endif
+
+// writev() that reports EPIPE without raising SIGPIPE
+ssize_t write_vector(int fd, const iovec* iov, int count) {
+#if defined(F_SETNOSIGPIPE)
+    // Suppressed per descriptor in write_queue::open()
+    return writev(fd, iov, count);
+#else
+    // Block SIGPIPE for this thread and consume the one our write raised, if any
+    sigset_t pipe_set;
+    sigset_t previous;
+    sigemptyset(&pipe_set);
+    sigaddset(&pipe_set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipe_set, &previous);
+
+    ssize_t written = writev(fd, iov, count);
+
+    if (written == -1 && errno == EPIPE && !sigismember(&previous, SIGPIPE)) {
+        int error = errno;
+        sigset_t pending;
+        sigpending(&pending);
+        if (sigismember(&pending, SIGPIPE)) {
+            const timespec no_wait{0, 0};
+            sigtimedwait(&pipe_set, nullptr, &no_wait);
+        }
+        errno = error;
+    }
+
+    pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+    return written;
+#endif
+}
+
+} // namespace
+
+ssize_t write_messages(int fd, std::deque<std::string>& messages, size_t& offset) {
+    iovec iov[max_iov];
+    int count = 0;
+    for (auto it = messages.begin(); it != messages.end() && count < max_iov; ++it, ++count) {
+        size_t skip = count == 0 ? offset : 0;
+        iov[count].iov_base = const_cast<char*>(it->data() + skip);
+        iov[count].iov_len = it->size() - skip;
+    }
+
+    ssize_t written = write_vector(fd, iov, count);
+    if (written < 0) {
+        return written;
+    }
+
+    // Drop what was written, including empty messages, the first remaining message continues at offset
+    size_t remaining = static_cast<size_t>(written);
+    while (!messages.empty()) {
+        size_t left = messages.front().size() - offset;
+        if (remaining < left) {
+            offset += remaining;
+            break;
+        }
+        remaining -= left;
+        messages.pop_front();
+        offset = 0;
+    }
+    return written;
+}
+
+write_queue::write_queue(size_t max_pending_bytes)
+    : max_pending_bytes_(max_pending_bytes) {
+}
+
+void write_queue::open(int fd, pending_callback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fd_ = fd;
+    messages_.clear();
+    offset_ = 0;
+    pending_bytes_ = 0;
+    callback_ = std::move(callback);
+
+#if defined(F_SETNOSIGPIPE)
+    fcntl(fd, F_SETNOSIGPIPE, 1);
+#endif
+}
+
+void write_queue::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fd_ = -1;
+    messages_.clear();
+    offset_ = 0;
+    pending_bytes_ = 0;
+    callback_ = nullptr;
+}
+
+write_queue::result write_queue::push(std::string data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ == -1) {
+        return result::failed;
+    }
+
+    if (!messages_.empty() && pending_bytes_ + data.size() > max_pending_bytes_) {
+        LOG_WARNING("Write queue full: ", pending_bytes_, " bytes pending");
+        return result::failed;
+    }
+
+    bool was_empty = messages_.empty();
+    pending_bytes_ += data.size();
+    messages_.push_back(std::move(data));
+
+    // Earlier data is waiting for the descriptor, this message goes after it
+    if (!was_empty) {
+        return result::pending;
+    }
+
+    result r = write_pending();
+    if (r == result::pending && callback_) {
+        callback_(true);
+    }
+    return r;
+}
+
+write_queue::result write_queue::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ == -1) {
+        return result::failed;
+    }
+    if (messages_.empty()) {
+        return result::complete;
+    }
+
+    result r = write_pending();
+    if (r == result::complete && callback_) {
+        callback_(false);
+    }
+    return r;
+}
+
+size_t write_queue::pending_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_bytes_;
+}
+
+write_queue::result write_queue::write_pending() {
+    while (!messages_.empty()) {
+        ssize_t written = write_messages(fd_, messages_, offset_);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return result::pending;
+            }
+            return fail(errno);
+        }
+
+        pending_bytes_ -= static_cast<size_t>(written);
+    }
+
+    return result::complete;
+}
+
+write_queue::result write_queue::fail(int error) {
+    LOG_ERROR("Failed to write to descriptor ", fd_, ": ", strerror(error));
+
+    bool had_pending = !messages_.empty();
+    fd_ = -1;
+    messages_.clear();
+    offset_ = 0;
+    pending_bytes_ = 0;
+
+    if (had_pending && callback_) {
+        callback_(false);
+    }
+    callback_ = nullptr;
+    return result::failed;
+}
+
+} // namespace mcp
+
+#endif // !_WIN32
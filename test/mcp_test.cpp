@@ -12,6 +12,32 @@
 #include "mcp_server.h"
 #include "mcp_tool.h"
 #include "mcp_sse_client.h"
+#include "mcp_stdio_client.h"
+#include "mcp_base64.h"
+#include "mcp_framing.h"
+#include "mcp_dispatcher.h"
+#include "mcp_stdio_server.h"
+#include "mcp_inprocess_client.h"
+#include "mcp_http_pool.h"
+#include "mcp_tool_cache.h"
+#include "base64.hpp"
+#include <filesystem>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#if !defined(_WIN32)
+#include "mcp_io_reactor.h"
+#include "mcp_write_queue.h"
+#include "mcp_unix_server.h"
+#include "mcp_unix_client.h"
+#include "mcp_stdio_pool.h"
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
 
 using namespace mcp;
 using json = nlohmann::ordered_json;
@@ -93,11 +119,1901 @@ TEST_F(MessageFormatTest, NotificationMessageFormat) {
     EXPECT_TRUE(notification.is_notification());
 }
 
+// Test parsing the caller's timeout of a request
+TEST_F(MessageFormatTest, RequestTimeout) {
+    auto with_timeout = [](const json& timeout_ms) {
+        return request::create("test_method", {{"_meta", {{"timeoutMs", timeout_ms}}}});
+    };
+
+    EXPECT_FALSE(request::create("test_method").timeout());
+    EXPECT_EQ(with_timeout(1500).timeout(), std::chrono::milliseconds(1500));
+
+    // Values beyond the limit are cut to it, so that a deadline computed from them cannot overflow
+    EXPECT_EQ(with_timeout(std::numeric_limits<uint64_t>::max()).timeout(), request::max_timeout);
+
+    for (const json& invalid : {json(0), json(-5), json(1.5), json("100"), json(nullptr)}) {
+        try {
+            with_timeout(invalid).timeout();
+            ADD_FAILURE() << "Expected mcp_exception for " << invalid.dump();
+        } catch (const mcp_exception& e) {
+            EXPECT_EQ(e.code(), error_code::invalid_params);
+        }
+    }
+}
+
+// Test base64 codec against the reference implementation
+TEST(Base64Test, MatchesReferenceImplementation) {
+    std::vector<uint8_t> data;
+    for (size_t size = 0; size < 300; ++size) {
+        std::string expected = ::base64::encode(reinterpret_cast<const char*>(data.data()), data.size());
+        
+        // One-shot encode and decode
+        EXPECT_EQ(base64_codec::encode(data.data(), data.size()), expected);
+        EXPECT_EQ(base64_codec::decode(expected), data);
+        
+        // Encode appended to existing output
+        std::string appended = "prefix:";
+        base64_codec::encode_append(data.data(), data.size(), appended);
+        EXPECT_EQ(appended, "prefix:" + expected);
+        
+        data.push_back(static_cast<uint8_t>(size * 131 + 7));
+    }
+}
+
+// Test base64 decoding of invalid input
+TEST(Base64Test, RejectsInvalidInput) {
+    EXPECT_THROW(base64_codec::decode(std::string("QUJD!EVGR0hJSktMTU5PUFFSU1RVVldYWVo=")), mcp_exception);
+    EXPECT_THROW(base64_codec::decode(std::string("QUJDR")), mcp_exception);
+}
+
+// Test shared resource buffers and direct content serialization
+TEST(ResourceTest, SharedBuffersAndDirectSerialization) {
+    text_resource text("test://text", "text", "text/plain");
+    text.set_text(std::string("line \"one\"\n\ttab \\ \x01 caf\xc3\xa9"));
+
+    // A reader keeps its snapshot while the text is replaced
+    text_buffer snapshot = text.get_text_buffer();
+    EXPECT_EQ(snapshot.get(), text.get_text_buffer().get());
+    text.set_text("replaced");
+    EXPECT_EQ(*snapshot, std::string("line \"one\"\n\ttab \\ \x01 caf\xc3\xa9"));
+    EXPECT_EQ(text.get_text(), "replaced");
+
+    text.set_text_buffer(snapshot);
+    std::string out;
+    text.write_content(out);
+    EXPECT_EQ(out, text.read().dump());
+
+    // Malformed UTF-8 is rejected like json::dump() rejects it
+    for (const char* bad : {"\xff", "caf\xc3", "\xc0\xaf", "\xed\xa0\x80", "\xf4\x90\x80\x80", "\xe2\x28\xa1"}) {
+        text.set_text(bad);
+        out.clear();
+        EXPECT_THROW(text.write_content(out), mcp_exception) << bad;
+        EXPECT_THROW(text.read().dump(), json::type_error) << bad;
+    }
+    text.set_text("\xf0\x9f\x98\x80 \xe2\x82\xac \xf4\x8f\xbf\xbf");
+    out.clear();
+    text.write_content(out);
+    EXPECT_EQ(out, text.read().dump());
+    text.set_text_buffer(snapshot);
+
+    binary_resource blob("test://blob", "blob", "application/octet-stream");
+    blob.set_data(std::vector<uint8_t>{0, 1, 2, 250, 251, 252, 253});
+    binary_buffer data = blob.get_data_buffer();
+    EXPECT_EQ(data->size(), 7u);
+    EXPECT_EQ(blob.get_data_buffer().get(), data.get());
+    EXPECT_EQ(blob.get_data(), *data);
+
+    out.clear();
+    blob.write_content(out);
+    EXPECT_EQ(out, blob.read().dump());
+    EXPECT_EQ(json::parse(out)["blob"], "AAEC+vv8/Q==");
+}
+
+// Test concurrent resource reads while the content is being replaced
+TEST(ResourceTest, ConcurrentReadsDuringUpdates) {
+    auto text = std::make_shared<text_resource>("test://text", "text", "text/plain");
+    text->set_text(std::string(1000, 'a'));
+
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&]() {
+            while (!done) {
+                // Every snapshot is a uniform run of a single letter
+                std::string content = text->read()["text"];
+                if (content.size() != 1000 || content.find_first_not_of(content[0]) != std::string::npos) {
+                    ++torn;
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < 200; ++i) {
+        text->set_text(std::string(1000, static_cast<char>('a' + i % 26)));
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(torn, 0);
+    EXPECT_EQ(text->get_text(), std::string(1000, static_cast<char>('a' + 199 % 26)));
+}
+
+// Test partial reads of text, binary and file resources
+TEST(ResourceTest, RangeReads) {
+    // "caf\xc3\xa9" ends with a two-byte character
+    text_resource text("test://text", "text", "text/plain");
+    text.set_text("hello caf\xc3\xa9 world");
+
+    json tail = text.read_range({-5, std::nullopt});
+    EXPECT_EQ(tail["text"], "world");
+    EXPECT_EQ(tail["range"]["offset"], 12);
+    EXPECT_EQ(tail["range"]["total"], 17);
+
+    // A range ending inside the two-byte character is shrunk to the boundary
+    json head = text.read_range({6, 4});
+    EXPECT_EQ(head["text"], "caf");
+    EXPECT_EQ(head["range"]["length"], 3);
+
+    std::string out;
+    text.write_content(out, {6, 5});
+    EXPECT_EQ(json::parse(out), text.read_range({6, 5}));
+    EXPECT_EQ(json::parse(out)["text"], "caf\xc3\xa9");
+
+    binary_resource blob("test://blob", "blob", "application/octet-stream");
+    blob.set_data(std::vector<uint8_t>{0, 1, 2, 3, 4, 5, 6, 7});
+    json middle = blob.read_range({2, 3});
+    EXPECT_EQ(base64_codec::decode(middle["blob"].get<std::string>()), (std::vector<uint8_t>{2, 3, 4}));
+    out.clear();
+    blob.write_content(out, {2, 3});
+    EXPECT_EQ(json::parse(out), middle);
+
+    // Out of range requests are clamped
+    EXPECT_EQ(blob.read_range({100, 10})["range"]["length"], 0);
+    EXPECT_EQ(blob.read_range({-100, std::nullopt})["range"]["length"], 8);
+
+    std::string path = ::testing::TempDir() + "mcp_range_test.txt";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "line 1\nline 2\nline 3\n";
+    }
+    file_resource file(path);
+    json file_tail = file.read_range({-7, std::nullopt});
+    EXPECT_EQ(file_tail["text"], "line 3\n");
+    EXPECT_EQ(file_tail["range"]["offset"], 14);
+    out.clear();
+    file.write_content(out, {7, 6});
+    EXPECT_EQ(json::parse(out)["text"], "line 2");
+
+    // Files written within the last mtime tick are reloaded on every read
+    EXPECT_EQ(file.read()["text"], "line 1\nline 2\nline 3\n");
+    text_buffer loaded = file.get_text_buffer();
+    EXPECT_TRUE(file.is_modified());
+    EXPECT_EQ(file.read()["text"], "line 1\nline 2\nline 3\n");
+    EXPECT_NE(file.get_text_buffer().get(), loaded.get());
+    EXPECT_TRUE(file.is_modified());
+
+    // A rewrite in the same tick after those reads keeps mtime and size, and is still seen
+    auto recent_time = std::filesystem::last_write_time(path);
+    {
+        std::ofstream rewrite(path, std::ios::binary);
+        rewrite << "line A\nline B\nline C\n";
+    }
+    std::filesystem::last_write_time(path, recent_time);
+    EXPECT_EQ(file.read()["text"], "line A\nline B\nline C\n");
+
+    // Whole reads reuse the snapshot until the file changes
+    auto settled_time = recent_time - std::chrono::seconds(10);
+    std::filesystem::last_write_time(path, settled_time);
+    EXPECT_EQ(file.read()["text"], "line A\nline B\nline C\n");
+    loaded = file.get_text_buffer();
+    out.clear();
+    file.write_content(out);
+    EXPECT_EQ(file.get_text_buffer().get(), loaded.get());
+    EXPECT_FALSE(file.is_modified());
+
+    // A rewrite that keeps the mtime is still detected by its size
+    {
+        std::ofstream rewrite(path, std::ios::binary);
+        rewrite << "changed\n";
+    }
+    std::filesystem::last_write_time(path, settled_time);
+    EXPECT_TRUE(file.is_modified());
+    EXPECT_EQ(file.read()["text"], "changed\n");
+    EXPECT_NE(file.get_text_buffer().get(), loaded.get());
+    std::remove(path.c_str());
+
+    json params = {{"uri", "test://text"}, {"offset", -4096}};
+    auto range = resource_range::from_params(params);
+    ASSERT_TRUE(range.has_value());
+    EXPECT_EQ(range->offset, -4096);
+    EXPECT_FALSE(resource_range::from_params({{"uri", "test://text"}}).has_value());
+    EXPECT_THROW(resource_range::from_params({{"length", -1}}), mcp_exception);
+}
+
+// Test independent sharded resource managers
+TEST(ResourceManagerTest, IndependentShardedInstances) {
+    resource_manager first(4);
+    resource_manager second;
+
+    for (int i = 9; i >= 0; --i) {
+        std::string uri = "test://resource/" + std::to_string(i);
+        first.register_resource(std::make_shared<text_resource>(uri, "r" + std::to_string(i), "text/plain"));
+    }
+
+    EXPECT_NE(first.get_resource("test://resource/3"), nullptr);
+    EXPECT_EQ(second.get_resource("test://resource/3"), nullptr);
+
+    // Listing is ordered by URI across shards
+    json list = first.list_resources()["resources"];
+    ASSERT_EQ(list.size(), 10u);
+    EXPECT_EQ(list[0]["uri"], "test://resource/0");
+    EXPECT_EQ(list[9]["uri"], "test://resource/9");
+
+    std::vector<std::string> notified;
+    int64_t id_a = first.subscribe("test://resource/1", [&](const std::string& uri) { notified.push_back(uri); });
+    int64_t id_b = first.subscribe("test://resource/2", [&](const std::string& uri) { notified.push_back(uri); });
+    EXPECT_NE(id_a, id_b);
+    EXPECT_THROW(second.subscribe("test://resource/1", [](const std::string&) {}), mcp_exception);
+
+    first.notify_resource_changed("test://resource/1");
+    EXPECT_EQ(notified, std::vector<std::string>{"test://resource/1"});
+
+    EXPECT_TRUE(first.unsubscribe(id_b));
+    EXPECT_FALSE(first.unsubscribe(id_b));
+    EXPECT_TRUE(first.unregister_resource("test://resource/1"));
+    EXPECT_FALSE(first.unsubscribe(id_a));
+    EXPECT_EQ(first.list_resources()["resources"].size(), 9u);
+}
+
+// Test splitting a stream into lines across reads of varying sizes
+TEST(LineBufferTest, SplitsLinesAcrossReads) {
+    std::string stream;
+    std::vector<std::string> expected;
+    for (int i = 0; i < 200; ++i) {
+        expected.push_back(std::string(i * 37 % 5000, 'a' + i % 26));
+        stream += expected.back() + (i % 3 == 0 ? "\r\n" : "\n");
+    }
+
+    line_buffer buffer(16, 4096);
+    std::vector<std::string> lines;
+    std::string_view line;
+    size_t pos = 0;
+    size_t step = 1;
+    while (pos < stream.size()) {
+        auto [space, capacity] = buffer.prepare();
+        size_t chunk = std::min({capacity, step, stream.size() - pos});
+        memcpy(space, stream.data() + pos, chunk);
+        buffer.commit(chunk);
+        pos += chunk;
+        step = step * 7 % 9973 + 1;
+
+        while (buffer.next_line(line)) {
+            lines.emplace_back(line);
+        }
+    }
+
+    EXPECT_EQ(lines, expected);
+    EXPECT_EQ(buffer.size(), 0u);
+    EXPECT_FALSE(buffer.next_line(line));
+
+    // Reads that fill the window grow it up to the maximum, draining resets it
+    buffer.append("partial", 7);
+    for (int i = 0; i < 10; ++i) {
+        auto [space, capacity] = buffer.prepare();
+        memset(space, 'x', capacity);
+        buffer.commit(capacity);
+    }
+    EXPECT_EQ(buffer.read_size(), 4096u);
+    EXPECT_FALSE(buffer.next_line(line));
+    buffer.append("\n", 1);
+    ASSERT_TRUE(buffer.next_line(line));
+    EXPECT_EQ(line.substr(0, 8), "partialx");
+    EXPECT_FALSE(buffer.next_line(line));
+    EXPECT_EQ(buffer.read_size(), 16u);
+}
+
+// Test parsing Server-Sent Events split at every position, with all line endings
+TEST(SseParserTest, ParsesEventsAcrossChunks) {
+    std::string big(100000, 'x');
+    std::string stream = std::string(": comment\r\n") +
+        "event: endpoint\r\ndata: /message?session_id=1\r\n\r\n" +
+        "data:{\"a\":1}\n\n" +
+        "id: 7\rdata: first\rdata:  second\r\r" +
+        "event: heartbeat\n\n" +
+        "retry: 1500\r\ndata\r\n\r\n" +
+        "data: " + big + "\r\n\r\n" +
+        "data: partial";
+
+    using event_list = std::vector<std::tuple<std::string, std::string, std::string>>;
+    event_list expected = {
+        {"endpoint", "/message?session_id=1", ""},
+        {"message", "{\"a\":1}", ""},
+        {"message", "first\n second", "7"},
+        {"message", "", "7"},
+        {"message", big, "7"}
+    };
+
+    for (size_t split = 0; split <= stream.size(); split += (split < 200 ? 1 : 997)) {
+        event_list events;
+        sse_parser parser([&](const sse_event& event) {
+            events.emplace_back(event.type, event.data, event.id);
+            return true;
+        });
+        EXPECT_TRUE(parser.feed(stream.data(), split));
+        EXPECT_TRUE(parser.feed(stream.data() + split, stream.size() - split));
+        ASSERT_EQ(events, expected) << "split at " << split;
+        EXPECT_EQ(parser.last_event_id(), "7");
+        EXPECT_EQ(parser.retry_ms(), 1500);
+    }
+
+    // Many short CR-only lines in one chunk, at every alignment of the terminators
+    std::string cr_stream;
+    for (int i = 0; i < 2000; ++i) {
+        cr_stream += "data: " + std::string(static_cast<size_t>(i % 11), 'y') + "\r\r";
+    }
+    size_t cr_events = 0;
+    sse_parser cr_parser([&](const sse_event& event) {
+        EXPECT_EQ(event.data, std::string(cr_events++ % 11, 'y'));
+        return true;
+    });
+    EXPECT_TRUE(cr_parser.feed(cr_stream.data(), cr_stream.size()));
+    EXPECT_EQ(cr_events, 2000u);
+
+    // The handler can stop parsing, reset() drops a partial event
+    int count = 0;
+    sse_parser parser([&](const sse_event&) {
+        return ++count < 2;
+    });
+    std::string three = "data: 1\n\ndata: 2\n\ndata: 3\n\n";
+    EXPECT_FALSE(parser.feed(three.data(), three.size()));
+    EXPECT_EQ(count, 2);
+    parser.reset();
+    std::string rest = "data: 4";
+    parser.feed(rest.data(), rest.size());
+    parser.reset();
+    parser.feed("\n\n", 2);
+    EXPECT_EQ(count, 2);
+}
+
+// Test numbered SSE events, replay after a dropped stream and detection of lost events
+TEST(EventDispatcherTest, ReplaysEventsToResumedStream) {
+    std::string written;
+    httplib::DataSink sink;
+    sink.write = [&](const char* data, size_t size) {
+        written.append(data, size);
+        return true;
+    };
+
+    event_dispatcher dispatcher("s1", 64);
+    uint64_t stream = dispatcher.attach();
+    ASSERT_NE(stream, 0u);
+
+    dispatcher.send_event("data: a\r\n\r\n", true);
+    dispatcher.send_event("data: beat\r\n\r\n");
+    ASSERT_TRUE(dispatcher.wait_event(&sink, stream));
+    EXPECT_EQ(written, "id: s1:1\r\ndata: a\r\n\r\ndata: beat\r\n\r\n");
+
+    // Resumable events sent while detached are replayed, others are dropped
+    dispatcher.detach(stream);
+    EXPECT_FALSE(dispatcher.wait_event(&sink, stream, std::chrono::milliseconds(10)));
+    dispatcher.send_event("data: b\r\n\r\n", true);
+    dispatcher.send_event("data: beat\r\n\r\n");
+    dispatcher.send_event("data: c\r\n\r\n", true);
+
+    written.clear();
+    uint64_t resumed = dispatcher.attach(1);
+    ASSERT_GT(resumed, stream);
+    ASSERT_TRUE(dispatcher.wait_event(&sink, resumed));
+    EXPECT_EQ(written, "id: s1:2\r\ndata: b\r\n\r\nid: s1:3\r\ndata: c\r\n\r\n");
+
+    // A newer stream replaces the resumed one
+    written.clear();
+    uint64_t newer = dispatcher.attach(2);
+    EXPECT_FALSE(dispatcher.wait_event(&sink, resumed, std::chrono::milliseconds(10)));
+    ASSERT_TRUE(dispatcher.wait_event(&sink, newer));
+    EXPECT_EQ(written, "id: s1:3\r\ndata: c\r\n\r\n");
+
+    // Events pushed out of the replay buffer cannot be resumed, nor can unknown ones
+    for (int i = 0; i < 10; ++i) {
+        dispatcher.send_event("data: filler\r\n\r\n", true);
+    }
+    EXPECT_EQ(dispatcher.attach(3), 0u);
+    EXPECT_EQ(dispatcher.attach(100), 0u);
+    EXPECT_NE(dispatcher.attach(13), 0u);
+}
+
+// Test splitting a server command line into arguments
+TEST(StdioClientTest, SplitsCommandLikeShell) {
+    using args = std::vector<std::string>;
+    EXPECT_EQ(stdio_client::split_command("  npx -y  server\t--port 1 "), (args{"npx", "-y", "server", "--port", "1"}));
+    EXPECT_EQ(stdio_client::split_command("python3 'my server.py' --name \"a \\\"b\\\" $c\""),
+              (args{"python3", "my server.py", "--name", "a \"b\" $c"}));
+    EXPECT_EQ(stdio_client::split_command("run a\\ b '' x\"y\"'z'"), (args{"run", "a b", "", "xyz"}));
+    EXPECT_EQ(stdio_client::split_command("'C:\\dir' \"\\n\""), (args{"C:\\dir", "\\n"}));
+    EXPECT_TRUE(stdio_client::split_command("   ").empty());
+    EXPECT_THROW(stdio_client::split_command("echo 'open"), mcp_exception);
+    EXPECT_THROW(stdio_client::split_command("echo \"open"), mcp_exception);
+}
+
+// Test dispatching server-initiated requests and notifications
+TEST(MessageDispatcherTest, RoutesRequestsAndOrderedNotifications) {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<json> replies;
+    std::vector<int> progress;
+
+    auto reply = [&](const json& message) {
+        std::lock_guard<std::mutex> lock(mutex);
+        replies.push_back(message);
+        cv.notify_all();
+    };
+
+    {
+        message_dispatcher dispatcher(std::make_shared<thread_pool>(4));
+        dispatcher.register_request_handler("sampling/createMessage", [](const json& params) {
+            if (!params.contains("messages")) {
+                throw mcp_exception(error_code::invalid_params, "Missing messages");
+            }
+            return json{{"role", "assistant"}};
+        });
+        dispatcher.register_notification_handler("notifications/progress", [&](const json& params) {
+            std::lock_guard<std::mutex> lock(mutex);
+            progress.push_back(params["progress"].get<int>());
+            cv.notify_all();
+        });
+
+        // Responses are left to the caller
+        json response = {{"jsonrpc", "2.0"}, {"id", 7}, {"result", json::object()}};
+        EXPECT_FALSE(dispatcher.dispatch(response, reply));
+
+        json messages[] = {
+            {{"jsonrpc", "2.0"}, {"id", 1}, {"method", "sampling/createMessage"}, {"params", {{"messages", json::array()}}}},
+            {{"jsonrpc", "2.0"}, {"id", 2}, {"method", "sampling/createMessage"}, {"params", json::object()}},
+            {{"jsonrpc", "2.0"}, {"id", 3}, {"method", "roots/list"}},
+            {{"jsonrpc", "2.0"}, {"id", 4}, {"method", "ping"}},
+            {{"jsonrpc", "2.0"}, {"method", "notifications/unknown"}}
+        };
+        for (json& message : messages) {
+            EXPECT_TRUE(dispatcher.dispatch(message, reply));
+        }
+        for (int i = 0; i < 100; ++i) {
+            json message = {{"jsonrpc", "2.0"}, {"method", "notifications/progress"}, {"params", {{"progress", i}}}};
+            EXPECT_TRUE(dispatcher.dispatch(message, reply));
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait_for(lock, std::chrono::seconds(5), [&]() { return replies.size() == 4 && progress.size() == 100; });
+    }
+
+    ASSERT_EQ(replies.size(), 4u);
+    std::map<int, json> by_id;
+    for (const auto& message : replies) {
+        by_id[message["id"].get<int>()] = message;
+    }
+    EXPECT_EQ(by_id[1]["result"]["role"], "assistant");
+    EXPECT_EQ(by_id[2]["error"]["code"], static_cast<int>(error_code::invalid_params));
+    EXPECT_EQ(by_id[3]["error"]["code"], static_cast<int>(error_code::method_not_found));
+    EXPECT_EQ(by_id[4]["result"], json::object());
+
+    // Notifications ran one at a time, in order, even on a multi-threaded executor
+    ASSERT_EQ(progress.size(), 100u);
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(progress[i], i);
+    }
+}
+
+// Test calling a server in-process, errors and server notifications
+TEST(InProcessClientTest, CallsServerWithoutTransport) {
+    server::configuration conf;
+    conf.port = 0;
+    auto srv = std::make_shared<server>(conf);
+    srv->set_capabilities({{"tools", json::object()}});
+    srv->register_tool(tool_builder("echo").with_string_param("text", "Text").build(),
+        [](const json& args, const std::string&) -> json {
+            return json::array({{{"type", "text"}, {"text", args["text"]}}});
+        });
+    srv->register_tool(tool_builder("fail").build(),
+        [](const json&, const std::string&) -> json {
+            throw mcp_exception(error_code::invalid_params, "bad input");
+        });
+
+    inprocess_client client(srv);
+    EXPECT_FALSE(client.is_running());
+    ASSERT_TRUE(client.initialize("TestClient", "1.0.0"));
+    EXPECT_TRUE(client.ping());
+    EXPECT_TRUE(client.get_server_capabilities().contains("tools"));
+    EXPECT_EQ(client.get_tools().size(), 2u);
+
+    EXPECT_EQ(client.call_tool("echo", {{"text", "hello"}})["content"][0]["text"], "hello");
+    EXPECT_TRUE(client.call_tool("fail")["isError"].get<bool>());
+    try {
+        client.send_request("no/such/method");
+        FAIL() << "Expected mcp_exception";
+    } catch (const mcp_exception& e) {
+        EXPECT_EQ(e.code(), error_code::method_not_found);
+    }
+
+    // Notifications from the server reach the client's handlers
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<json> messages;
+    client.register_notification_handler("notifications/message", [&](const json& params) {
+        std::lock_guard<std::mutex> lock(mutex);
+        messages.push_back(params);
+        cv.notify_all();
+    });
+    srv->send_request(client.get_session_id(), request::create_notification("message", {{"data", "hi"}}));
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait_for(lock, std::chrono::seconds(5), [&]() { return !messages.empty(); });
+    }
+    ASSERT_EQ(messages.size(), 1u);
+    EXPECT_EQ(messages[0]["data"], "hi");
+
+    // Concurrent calls run on the calling threads
+    std::atomic<int> matched{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 50; ++i) {
+                std::string text = std::to_string(t) + ":" + std::to_string(i);
+                if (client.call_tool("echo", {{"text", text}})["content"][0]["text"] == text) {
+                    ++matched;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(matched, 200);
+}
+
+// Test the defaults a client subclass inherits for the optional interface
+TEST(ClientInterfaceTest, DefaultsForOptionalMethods) {
+    struct recording_client : client {
+        std::vector<std::pair<std::string, json>> sent;
+
+        bool initialize(const std::string&, const std::string&) override { return true; }
+        bool ping() override { return true; }
+        void set_capabilities(const json&) override {}
+        response send_request(const std::string& method, const json& params) override {
+            sent.emplace_back(method, params);
+            return response::create_success(1, {{"contents", json::array()}});
+        }
+        void send_notification(const std::string&, const json&) override {}
+        json get_server_capabilities() override { return json::object(); }
+        json call_tool(const std::string&, const json&) override { return json::object(); }
+        std::vector<tool> get_tools() override { return {}; }
+        json get_capabilities() override { return json::object(); }
+        json list_resources(const std::string&) override { return json::object(); }
+        json read_resource(const std::string&) override { return json::object(); }
+        json subscribe_to_resource(const std::string&) override { return json::object(); }
+        json list_resource_templates() override { return json::object(); }
+        bool is_running() const override { return true; }
+    };
+
+    recording_client c;
+    c.read_resource_range("test://text", -10, 4);
+    c.read_resource_range("test://text", 5);
+    ASSERT_EQ(c.sent.size(), 2u);
+    EXPECT_EQ(c.sent[0].first, "resources/read");
+    EXPECT_EQ(c.sent[0].second, (json{{"uri", "test://text"}, {"offset", -10}, {"length", 4}}));
+    EXPECT_EQ(c.sent[1].second, (json{{"uri", "test://text"}, {"offset", 5}}));
+
+    EXPECT_THROW(c.register_request_handler("sampling/createMessage", [](const json&) { return json::object(); }), mcp_exception);
+    EXPECT_THROW(c.register_notification_handler("notifications/message", [](const json&) {}), mcp_exception);
+}
+
+// Test posting concurrently through a bounded pool of keep-alive connections
+TEST(HttpConnectionPoolTest, ReusesBoundedConnections) {
+    httplib::Server http;
+    http.set_tcp_nodelay(true);
+    http.Post("/message", [](const httplib::Request& req, httplib::Response& res) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        res.set_content(req.body, "text/plain");
+    });
+    int port = http.bind_to_any_port("127.0.0.1");
+    ASSERT_GT(port, 0);
+    std::thread listener([&]() { http.listen_after_bind(); });
+    http.wait_until_ready();
+
+    {
+        http_connection_pool::configuration conf;
+        conf.max_connections = 3;
+        http_connection_pool pool("http://127.0.0.1:" + std::to_string(port), conf);
+
+        std::atomic<int> matched{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 6; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < 20; ++i) {
+                    std::string body = std::to_string(t) + ":" + std::to_string(i);
+                    auto res = pool.post("/message", {}, body, "text/plain");
+                    if (res && res->status == 200 && res->body == body) {
+                        ++matched;
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        EXPECT_EQ(matched, 120);
+
+        auto stats = pool.stats();
+        EXPECT_EQ(stats.requests, 120u);
+        EXPECT_EQ(stats.connections, 3u);
+        EXPECT_EQ(stats.busy, 0u);
+        EXPECT_EQ(stats.peak_busy, 3u);
+        EXPECT_GT(stats.waits, 0u);
+        EXPECT_EQ(stats.connects, 3u);
+
+        // Lowering the maximum closes the extra free connections
+        pool.set_max_connections(1);
+        EXPECT_EQ(pool.stats().connections, 1u);
+        auto res = pool.post("/message", {}, "last", "text/plain");
+        ASSERT_TRUE(res);
+        EXPECT_EQ(res->body, "last");
+        EXPECT_EQ(pool.stats().connects, 3u);
+    }
+
+    http.stop();
+    listener.join();
+}
+
+// Test caching tool results by tool annotations and policies
+TEST(ToolResultCacheTest, CachesCacheableToolResults) {
+    server::configuration conf;
+    conf.port = 0;
+    auto srv = std::make_shared<server>(conf);
+    srv->set_capabilities({{"tools", json::object()}});
+    std::atomic<int> lookups{0};
+    srv->register_tool(tool_builder("lookup").with_read_only_hint().with_string_param("key", "Key").build(),
+        [&](const json& args, const std::string&) -> json {
+            ++lookups;
+            return json::array({{{"type", "text"}, {"text", args["key"]}}});
+        });
+    std::atomic<int> updates{0};
+    srv->register_tool(tool_builder("update").with_idempotent_hint().build(),
+        [&](const json&, const std::string&) -> json {
+            ++updates;
+            return json::array();
+        });
+    std::atomic<int> failures{0};
+    srv->register_tool(tool_builder("broken").with_read_only_hint().build(),
+        [&](const json&, const std::string&) -> json {
+            ++failures;
+            throw std::runtime_error("unavailable");
+        });
+
+    auto cache = std::make_shared<tool_result_cache>();
+    inprocess_client first(srv);
+    inprocess_client second(srv);
+    first.set_tool_cache(cache, "local");
+    second.set_tool_cache(cache, "local");
+    ASSERT_TRUE(first.initialize("TestClient", "1.0.0"));
+    ASSERT_TRUE(second.initialize("TestClient", "1.0.0"));
+    auto tools = first.get_tools();
+    ASSERT_EQ(tools.size(), 3u);
+
+    // Arguments differing only in key order share an entry, across clients of the same scope
+    EXPECT_EQ(first.call_tool("lookup", {{"key", "a"}, {"page", 1}})["content"][0]["text"], "a");
+    EXPECT_EQ(second.call_tool("lookup", {{"page", 1}, {"key", "a"}})["content"][0]["text"], "a");
+    EXPECT_EQ(lookups, 1);
+    first.call_tool("lookup", {{"key", "b"}});
+    EXPECT_EQ(lookups, 2);
+
+    // Idempotent tools that may be destructive and error results are not cached
+    first.call_tool("update");
+    first.call_tool("update");
+    EXPECT_EQ(updates, 2);
+    EXPECT_TRUE(first.call_tool("broken")["isError"].get<bool>());
+    EXPECT_TRUE(first.call_tool("broken")["isError"].get<bool>());
+    EXPECT_EQ(failures, 2);
+
+    auto stats = cache->stats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.entries, 2u);
+    EXPECT_GT(stats.bytes, 0u);
+
+    // An explicit policy overrides the annotations: short TTL and one entry per tool
+    cache->set_policy("local", "update", {std::chrono::milliseconds(50), 1});
+    first.call_tool("update", {{"n", 1}});
+    first.call_tool("update", {{"n", 1}});
+    EXPECT_EQ(updates, 3);
+    first.call_tool("update", {{"n", 2}});
+    first.call_tool("update", {{"n", 1}});
+    EXPECT_EQ(updates, 5);
+    EXPECT_EQ(cache->stats().evictions, 2u);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    first.call_tool("update", {{"n", 1}});
+    EXPECT_EQ(updates, 6);
+
+    // Invalidation drops the entries of a scope
+    cache->invalidate("local");
+    EXPECT_EQ(cache->stats().entries, 0u);
+    first.call_tool("lookup", {{"key", "a"}, {"page", 1}});
+    EXPECT_EQ(lookups, 3);
+
+    // Policies apply to their scope only, unless set for any scope
+    inprocess_client other(srv);
+    other.set_tool_cache(cache, "other");
+    ASSERT_TRUE(other.initialize("TestClient", "1.0.0"));
+    other.call_tool("update", {{"n", 1}});
+    other.call_tool("update", {{"n", 1}});
+    EXPECT_EQ(updates, 8);
+    cache->set_policy(tool_result_cache::any_scope, "update", {std::chrono::seconds(60), 0});
+    other.call_tool("update", {{"n", 1}});
+    other.call_tool("update", {{"n", 1}});
+    EXPECT_EQ(updates, 9);
+    cache->set_policy("other", "update", {});
+    other.call_tool("update", {{"n", 1}});
+    EXPECT_EQ(updates, 10);
+
+    // Clients without a cache always call the server
+    inprocess_client uncached(srv);
+    ASSERT_TRUE(uncached.initialize("TestClient", "1.0.0"));
+    uncached.call_tool("lookup", {{"key", "a"}, {"page", 1}});
+    EXPECT_EQ(lookups, 4);
+}
+
+// Test memoizing a pure tool on the server
+TEST(ToolMemoTest, CoalescesAndCachesPureToolCalls) {
+    server::configuration conf;
+    conf.port = 0;
+    auto srv = std::make_shared<server>(conf);
+    srv->set_capabilities({{"tools", json::object()}});
+    std::atomic<int> runs{0};
+    tool_memo::configuration memo;
+    memo.max_entries = 2;
+    srv->register_tool(tool_builder("square").with_number_param("x", "Value").build(),
+        [&](const json& args, const std::string&) -> json {
+            ++runs;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (args["x"].get<int>() < 0) {
+                throw std::runtime_error("negative");
+            }
+            int x = args["x"].get<int>();
+            return json::array({{{"type", "text"}, {"text", std::to_string(x * x)}}});
+        }, memo);
+
+    inprocess_client client(srv);
+    ASSERT_TRUE(client.initialize("TestClient", "1.0.0"));
+
+    // Simultaneous identical calls run the handler once
+    std::atomic<int> matched{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&]() {
+            if (client.call_tool("square", {{"x", 3}, {"unit", "m"}})["content"][0]["text"] == "9") {
+                ++matched;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(matched, 8);
+    EXPECT_EQ(runs, 1);
+
+    // Later calls with the same arguments in any key order are answered from the memo
+    EXPECT_EQ(client.call_tool("square", {{"unit", "m"}, {"x", 3}})["content"][0]["text"], "9");
+    EXPECT_EQ(runs, 1);
+
+    // Failures are not memoized, the least recently used result is evicted
+    EXPECT_TRUE(client.call_tool("square", {{"x", -1}})["isError"].get<bool>());
+    EXPECT_TRUE(client.call_tool("square", {{"x", -1}})["isError"].get<bool>());
+    EXPECT_EQ(runs, 3);
+    client.call_tool("square", {{"x", 4}});
+    client.call_tool("square", {{"x", 5}});
+    client.call_tool("square", {{"x", 3}, {"unit", "m"}});
+    EXPECT_EQ(runs, 6);
+
+    auto stats = srv->get_tool_memo("square")->stats();
+    EXPECT_GT(stats.coalesced, 0u);
+    EXPECT_EQ(stats.hits + stats.coalesced, 8u);
+    EXPECT_EQ(stats.entries, 2u);
+    EXPECT_EQ(stats.evictions, 2u);
+
+    srv->get_tool_memo("square")->clear();
+    client.call_tool("square", {{"x", 5}});
+    EXPECT_EQ(runs, 7);
+    EXPECT_EQ(srv->get_tool_memo("missing"), nullptr);
+}
+
+// Test that results of cancelled calls are not shared and that waiters keep their own deadline
+TEST(ToolMemoTest, DoesNotShareResultsOfCancelledCalls) {
+    server::configuration conf;
+    conf.port = 0;
+    auto srv = std::make_shared<server>(conf);
+    srv->set_capabilities({{"tools", json::object()}});
+    std::atomic<int> runs{0};
+    srv->register_tool(tool_builder("square").with_number_param("x", "Value").build(),
+        [&](const json& args, const std::string&) -> json {
+            ++runs;
+            // Stops early once the request is cancelled, as handlers are told to
+            for (int i = 0; i < 30; ++i) {
+                if (cancellation_token::current().is_cancelled()) {
+                    return json::array({{{"type", "text"}, {"text", "cut short"}}});
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            int x = args["x"].get<int>();
+            return json::array({{{"type", "text"}, {"text", std::to_string(x * x)}}});
+        }, tool_memo::configuration());
+
+    inprocess_client client(srv);
+    ASSERT_TRUE(client.initialize("TestClient", "1.0.0"));
+
+    // The waiter runs the handler again once the call it waited for expired
+    std::thread leader([&]() {
+        EXPECT_EQ(client.call_tool_with_timeout("square", {{"x", 2}}, std::chrono::milliseconds(50))["content"][0]["text"], "cut short");
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(client.call_tool("square", {{"x", 2}})["content"][0]["text"], "4");
+    leader.join();
+    EXPECT_EQ(runs, 2);
+    EXPECT_EQ(client.call_tool("square", {{"x", 2}})["content"][0]["text"], "4");
+    EXPECT_EQ(runs, 2);
+
+    // A waiter gives up at its own deadline while the call it waits for goes on
+    std::thread slow([&]() {
+        EXPECT_EQ(client.call_tool("square", {{"x", 3}})["content"][0]["text"], "9");
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto start = std::chrono::steady_clock::now();
+    try {
+        client.call_tool_with_timeout("square", {{"x", 3}}, std::chrono::milliseconds(50));
+        ADD_FAILURE() << "Expected mcp_exception";
+    } catch (const mcp_exception& e) {
+        EXPECT_EQ(e.code(), error_code::request_timeout);
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(200));
+    slow.join();
+    EXPECT_EQ(runs, 3);
+}
+
+// Test streaming progress and partial content of a tool call
+TEST(StreamingToolTest, DeliversProgressAndPartialContent) {
+    server::configuration conf;
+    conf.port = 0;
+    auto srv = std::make_shared<server>(conf);
+    srv->set_capabilities({{"tools", json::object()}});
+    srv->register_streaming_tool(tool_builder("tail").build(),
+        [](const json&, tool_stream& stream, const std::string&) -> json {
+            for (int i = 1; i <= 3; ++i) {
+                stream.write({{"type", "text"}, {"text", "line " + std::to_string(i)}});
+                stream.progress(i, 3, "line " + std::to_string(i));
+            }
+            return json::array({{{"type", "text"}, {"text", "done"}}});
+        });
+    std::atomic<int64_t> report_ms{-1};
+    srv->register_streaming_tool(tool_builder("report").build(),
+        [&](const json&, tool_stream& stream, const std::string&) -> json {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 1; i <= 3; ++i) {
+                stream.progress(i, 3);
+            }
+            report_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+            return json::array();
+        });
+
+    inprocess_client client(srv);
+    ASSERT_TRUE(client.initialize("TestClient", "1.0.0"));
+
+    // A streaming call receives the chunks as they are written, the result holds the rest
+    std::vector<json> chunks;
+    std::vector<double> progress;
+    tool_call_listener listener;
+    listener.on_content = [&](const json& content) {
+        chunks.push_back(content);
+    };
+    listener.on_progress = [&](const json& params) {
+        progress.push_back(params["progress"].get<double>());
+        EXPECT_EQ(params["total"], 3);
+    };
+    json result = client.call_tool_streaming("tail", json::object(), listener);
+    ASSERT_EQ(chunks.size(), 3u);
+    EXPECT_EQ(chunks[2][0]["text"], "line 3");
+    EXPECT_EQ(progress, std::vector<double>({1, 2, 3}));
+    ASSERT_EQ(result["content"].size(), 1u);
+    EXPECT_EQ(result["content"][0]["text"], "done");
+
+    // A plain call gets all the content in the result
+    result = client.call_tool("tail");
+    ASSERT_EQ(result["content"].size(), 4u);
+    EXPECT_EQ(result["content"][0]["text"], "line 1");
+    EXPECT_EQ(result["content"][3]["text"], "done");
+    EXPECT_EQ(chunks.size(), 3u);
+
+    // A slow listener does not hold up the messages it receives, the call still returns after it ran
+    std::vector<double> slow_progress;
+    tool_call_listener slow;
+    slow.on_progress = [&](const json& params) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        slow_progress.push_back(params["progress"].get<double>());
+    };
+    client.call_tool_streaming("report", json::object(), slow);
+    EXPECT_EQ(slow_progress, std::vector<double>({1, 2, 3}));
+    EXPECT_GE(report_ms, 0);
+    EXPECT_LT(report_ms, 100);
+}
+
+// Test the bounded task queue and its counters
+TEST(ThreadPoolTest, BoundsQueueAndCountsRejections) {
+    thread_pool pool(1, 2);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::promise<void> started;
+
+    ASSERT_TRUE(pool.try_enqueue([&]() {
+        started.set_value();
+        released.wait();
+    }));
+    started.get_future().wait();
+
+    // The running task does not count against the queue
+    EXPECT_TRUE(pool.try_enqueue([]() {}));
+    EXPECT_TRUE(pool.try_enqueue([]() {}));
+    EXPECT_FALSE(pool.try_enqueue([]() {}));
+
+    thread_pool::statistics stats = pool.stats();
+    EXPECT_EQ(stats.queued, 2u);
+    EXPECT_EQ(stats.active, 1u);
+    EXPECT_EQ(stats.peak_queued, 2u);
+    EXPECT_EQ(stats.rejected, 1u);
+
+    // Priority tasks are bounded separately, a full queue does not reject them
+    std::atomic<int> pings{0};
+    EXPECT_TRUE(pool.try_enqueue("control", [&]() { ++pings; }, true));
+    EXPECT_TRUE(pool.try_enqueue("control", [&]() { ++pings; }, true));
+    EXPECT_FALSE(pool.try_enqueue("control", [&]() { ++pings; }, true));
+    EXPECT_FALSE(pool.try_enqueue([]() {}));
+    stats = pool.stats();
+    EXPECT_EQ(stats.queued, 4u);
+    EXPECT_EQ(stats.rejected, 3u);
+
+    release.set_value();
+    pool.enqueue([]() {}).get();
+    EXPECT_EQ(pings, 2);
+    stats = pool.stats();
+    EXPECT_EQ(stats.queued, 0u);
+    EXPECT_EQ(stats.rejected, 3u);
+
+    // A throwing task leaves the worker running
+    ASSERT_TRUE(pool.try_enqueue([]() { throw std::runtime_error("task failed"); }));
+    EXPECT_EQ(pool.enqueue([]() { return 42; }).get(), 42);
+}
+
+// Test that keys take turns and priority tasks go first
+TEST(ThreadPoolTest, TakesTurnsBetweenKeys) {
+    // Only the worker appends, the order is read after the pool finished
+    std::vector<std::string> order;
+    auto record = [&order](std::string name) {
+        return [&order, name]() { order.push_back(name); };
+    };
+
+    {
+        // Declared before the pool so they outlive its worker
+        std::promise<void> release;
+        std::shared_future<void> released = release.get_future().share();
+        std::promise<void> started;
+        thread_pool pool(1);
+        pool.try_enqueue([&]() {
+            started.set_value();
+            released.wait();
+        });
+        started.get_future().wait();
+
+        pool.try_enqueue("noisy", record("noisy 1"));
+        pool.try_enqueue("noisy", record("noisy 2"));
+        pool.try_enqueue("noisy", record("noisy 3"));
+        pool.try_enqueue("quiet", record("quiet 1"));
+        pool.try_enqueue("quiet", record("quiet 2"));
+        pool.try_enqueue("control", record("ping"), true);
+        release.set_value();
+    }
+
+    EXPECT_THAT(order, ::testing::ElementsAre("ping", "noisy 1", "quiet 1", "noisy 2", "quiet 2", "noisy 3"));
+}
+
+#if !defined(_WIN32)
+// Test the shared I/O reactor with a pipe
+TEST(IoReactorTest, DispatchesReadinessAndRemoves) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL, 0) | O_NONBLOCK);
+
+    io_reactor reactor(2);
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::string received;
+
+    reactor.add(fds[0], io_reactor::readable, [&](uint32_t /* events */) {
+        char buffer[64];
+        ssize_t n;
+        while ((n = read(fds[0], buffer, sizeof(buffer))) > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            received.append(buffer, n);
+        }
+        cv.notify_all();
+    });
+    EXPECT_EQ(reactor.size(), 1u);
+    EXPECT_THROW(reactor.add(fds[0], io_reactor::readable, [](uint32_t) {}), mcp_exception);
+
+    // Readiness is reported again after each handler run
+    for (const char* chunk : {"hello ", "world"}) {
+        ASSERT_EQ(write(fds[1], chunk, strlen(chunk)), static_cast<ssize_t>(strlen(chunk)));
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait_for(lock, std::chrono::seconds(5), [&]() { return received.find(chunk) != std::string::npos; });
+    }
+    EXPECT_EQ(received, "hello world");
+
+    // No more calls after remove()
+    reactor.remove(fds[0]);
+    EXPECT_EQ(reactor.size(), 0u);
+    ASSERT_EQ(write(fds[1], "!", 1), 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(received, "hello world");
+
+    close(fds[0]);
+    close(fds[1]);
+}
+// Test concurrent, non-blocking writes through a small pipe
+TEST(WriteQueueTest, ConcurrentWritersWithPartialWrites) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL, 0) | O_NONBLOCK);
+#if defined(F_SETPIPE_SZ)
+    fcntl(fds[1], F_SETPIPE_SZ, 4096);
+#endif
+
+    io_reactor reactor(1);
+    write_queue queue;
+    queue.open(fds[1], [&](bool pending) {
+        reactor.modify(fds[1], pending ? static_cast<uint32_t>(io_reactor::writable) : 0u);
+    });
+    reactor.add(fds[1], 0, [&](uint32_t) {
+        queue.flush();
+    });
+
+    const int writer_count = 4;
+    const int message_count = 200;
+
+    // Blocking reader: every line must arrive whole and in order per writer
+    std::vector<int> next(writer_count, 0);
+    bool intact = true;
+    std::thread reader([&]() {
+        line_buffer buffer;
+        std::string_view line;
+        int received = 0;
+        while (received < writer_count * message_count) {
+            auto [space, capacity] = buffer.prepare();
+            ssize_t n = read(fds[0], space, capacity);
+            if (n <= 0) {
+                break;
+            }
+            buffer.commit(n);
+            while (buffer.next_line(line)) {
+                int writer = line[0] - '0';
+                int index = std::stoi(std::string(line.substr(2, line.find(':', 2) - 2)));
+                size_t payload = line.size() - line.find(':', 2) - 1;
+                intact = intact && index == next[writer]++ && payload == static_cast<size_t>(index * 97 % 20000);
+                ++received;
+            }
+        }
+    });
+
+    std::vector<std::thread> writers;
+    for (int w = 0; w < writer_count; ++w) {
+        writers.emplace_back([&, w]() {
+            for (int i = 0; i < message_count; ++i) {
+                std::string message = std::to_string(w) + ":" + std::to_string(i) + ":" + std::string(i * 97 % 20000, 'x') + "\n";
+                EXPECT_NE(queue.push(std::move(message)), write_queue::result::failed);
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    reader.join();
+
+    EXPECT_TRUE(intact);
+    EXPECT_EQ(next, std::vector<int>(writer_count, message_count));
+    EXPECT_EQ(queue.pending_bytes(), 0u);
+
+    // Writing to a pipe without reader fails instead of raising SIGPIPE
+    reactor.remove(fds[1]);
+    close(fds[0]);
+    EXPECT_EQ(queue.push("lost\n"), write_queue::result::failed);
+    EXPECT_EQ(queue.push("closed\n"), write_queue::result::failed);
+    close(fds[1]);
+}
+
+// Test that empty messages are dropped instead of being retried forever
+TEST(WriteQueueTest, EmptyMessages) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL, 0) | O_NONBLOCK);
+
+    write_queue queue;
+    queue.open(fds[1], nullptr);
+    EXPECT_EQ(queue.push(""), write_queue::result::complete);
+    EXPECT_EQ(queue.push("one\n"), write_queue::result::complete);
+    EXPECT_EQ(queue.pending_bytes(), 0u);
+
+    std::deque<std::string> messages = {"", "two\n", "", "", "three\n", ""};
+    size_t offset = 0;
+    EXPECT_EQ(write_messages(fds[1], messages, offset), 10);
+    EXPECT_TRUE(messages.empty());
+    EXPECT_EQ(offset, 0u);
+
+    char buffer[32];
+    ssize_t n = read(fds[0], buffer, sizeof(buffer));
+    EXPECT_EQ(std::string(buffer, n > 0 ? n : 0), "one\ntwo\nthree\n");
+    close(fds[0]);
+    close(fds[1]);
+}
+
+// Test that the stdio transport runs requests concurrently and writes whole lines
+TEST(StdioServerTest, ServesConcurrentRequestsOverPipes) {
+    int input[2];
+    int output[2];
+    ASSERT_EQ(pipe(input), 0);
+    ASSERT_EQ(pipe(output), 0);
+
+    server::configuration conf;
+    conf.threadpool_size = 4;
+    auto srv = std::make_shared<server>(conf);
+    srv->register_tool(tool_builder("sleep").build(), [](const json& args, const std::string&) -> json {
+        std::this_thread::sleep_for(std::chrono::milliseconds(args["ms"].get<int>()));
+        return json::array({{{"type", "text"}, {"text", "slept"}}});
+    });
+
+    stdio_server transport(srv, {input[0], output[1]});
+    ASSERT_TRUE(transport.start(false));
+
+    json init = request::create_with_id(1, "initialize", {{"protocolVersion", MCP_VERSION}}).to_json();
+    std::string requests = init.dump() + "\n"
+        R"({"jsonrpc":"2.0","method":"notifications/initialized"})" "\n"
+        R"({"jsonrpc":"2.0","id":2,"method":"tools/call","params":{"name":"sleep","arguments":{"ms":300}}})" "\n"
+        R"({"jsonrpc":"2.0","id":3,"method":"tools/call","params":{"name":"sleep","arguments":{"ms":0}}})" "\n"
+        "not json\n";
+    ASSERT_EQ(write(input[1], requests.data(), requests.size()), static_cast<ssize_t>(requests.size()));
+
+    line_buffer buffer;
+    std::string_view line;
+    auto read_message = [&]() {
+        while (!buffer.next_line(line)) {
+            auto [space, capacity] = buffer.prepare();
+            ssize_t n = read(output[0], space, capacity);
+            if (n <= 0) {
+                return json();
+            }
+            buffer.commit(n);
+        }
+        return json::parse(line.data(), line.data() + line.size());
+    };
+
+    std::vector<json> responses;
+    for (int i = 0; i < 4; ++i) {
+        responses.push_back(read_message());
+    }
+
+    // The slow call does not hold up the ones behind it
+    EXPECT_EQ(responses.back()["id"], 2);
+    for (const auto& response : responses) {
+        if (response["id"] == 3) {
+            EXPECT_EQ(response["result"]["content"][0]["text"], "slept");
+        } else if (response["id"].is_null()) {
+            EXPECT_EQ(response["error"]["code"], static_cast<int>(error_code::parse_error));
+        }
+    }
+
+    // Server-initiated messages reach the session
+    srv->send_request(transport.session_id(), request::create_notification("tools/list_changed"));
+    EXPECT_EQ(read_message()["method"], "notifications/tools/list_changed");
+
+    close(input[1]);
+    transport.stop();
+    EXPECT_FALSE(transport.is_running());
+    close(input[0]);
+    close(output[0]);
+    close(output[1]);
+}
+
+// Test cancelling running and queued requests with notifications/cancelled
+TEST(StdioServerTest, CancelsRunningAndQueuedRequests) {
+    int input[2];
+    int output[2];
+    ASSERT_EQ(pipe(input), 0);
+    ASSERT_EQ(pipe(output), 0);
+
+    server::configuration conf;
+    conf.threadpool_size = 1;
+    auto srv = std::make_shared<server>(conf);
+    std::atomic<bool> started{false};
+    std::atomic<bool> saw_cancel{false};
+    srv->register_tool(tool_builder("wait").build(), [&](const json&, const std::string&) -> json {
+        started = true;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (cancellation_token::current().is_cancelled()) {
+                saw_cancel = true;
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        cancellation_token::current().throw_if_cancelled();
+        return json::array();
+    });
+    std::atomic<int> runs{0};
+    srv->register_tool(tool_builder("count").build(), [&](const json&, const std::string&) -> json {
+        ++runs;
+        return json::array();
+    });
+
+    stdio_server transport(srv, {input[0], output[1]});
+    ASSERT_TRUE(transport.start(false));
+
+    // The single worker runs request 2 while 3 waits in the queue; both are cancelled
+    json init = request::create_with_id(1, "initialize", {{"protocolVersion", MCP_VERSION}}).to_json();
+    std::string requests = init.dump() + "\n"
+        R"({"jsonrpc":"2.0","method":"notifications/initialized"})" "\n"
+        R"({"jsonrpc":"2.0","id":2,"method":"tools/call","params":{"name":"wait"}})" "\n"
+        R"({"jsonrpc":"2.0","id":3,"method":"tools/call","params":{"name":"count"}})" "\n";
+    ASSERT_EQ(write(input[1], requests.data(), requests.size()), static_cast<ssize_t>(requests.size()));
+
+    line_buffer buffer;
+    std::string_view line;
+    auto read_message = [&]() {
+        while (!buffer.next_line(line)) {
+            auto [space, capacity] = buffer.prepare();
+            ssize_t n = read(output[0], space, capacity);
+            if (n <= 0) {
+                return json();
+            }
+            buffer.commit(n);
+        }
+        return json::parse(line.data(), line.data() + line.size());
+    };
+
+    EXPECT_EQ(read_message()["id"], 1);
+    for (int i = 0; i < 500 && !started; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(started);
+
+    // A second request with the ID of one in flight is refused and does not take over its cancellation
+    requests = R"({"jsonrpc":"2.0","id":2,"method":"tools/call","params":{"name":"count"}})" "\n";
+    ASSERT_EQ(write(input[1], requests.data(), requests.size()), static_cast<ssize_t>(requests.size()));
+    json duplicate = read_message();
+    EXPECT_EQ(duplicate["id"], 2);
+    EXPECT_EQ(duplicate["error"]["code"], static_cast<int>(error_code::invalid_request));
+
+    requests =
+        R"({"jsonrpc":"2.0","method":"notifications/cancelled","params":{"requestId":3}})" "\n"
+        R"({"jsonrpc":"2.0","method":"notifications/cancelled","params":{"requestId":2,"reason":"test"}})" "\n"
+        R"({"jsonrpc":"2.0","id":4,"method":"tools/call","params":{"name":"count"}})" "\n";
+    ASSERT_EQ(write(input[1], requests.data(), requests.size()), static_cast<ssize_t>(requests.size()));
+
+    // Only the request that was not cancelled is answered
+    EXPECT_EQ(read_message()["id"], 4);
+    EXPECT_TRUE(saw_cancel);
+    EXPECT_EQ(runs, 1);
+
+    // Outside a request the current token is never cancelled
+    EXPECT_FALSE(cancellation_token::current().is_cancelled());
+
+    close(input[1]);
+    transport.stop();
+    close(input[0]);
+    close(output[0]);
+    close(output[1]);
+}
+
+// Test deadlines: requests whose deadline passed while queued get an error, late results are still sent
+TEST(StdioServerTest, AnswersRequestsPastTheirDeadline) {
+    int input[2];
+    int output[2];
+    ASSERT_EQ(pipe(input), 0);
+    ASSERT_EQ(pipe(output), 0);
+
+    server::configuration conf;
+    conf.threadpool_size = 1;
+    conf.request_timeout = std::chrono::seconds(10);
+    auto srv = std::make_shared<server>(conf);
+    std::vector<int64_t> budgets;
+    srv->register_tool(tool_builder("work").build(), [&](const json&, const std::string&) -> json {
+        auto remaining = cancellation_token::current().remaining();
+        budgets.push_back(remaining ? remaining->count() : -1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        return json::array();
+    });
+    srv->register_tool(tool_builder("slow").build(), [](const json&, const std::string&) -> json {
+        std::this_thread::sleep_for(std::chrono::milliseconds(400));
+        return json::array({{{"type", "text"}, {"text", "done"}}});
+    });
+
+    stdio_server transport(srv, {input[0], output[1]});
+    ASSERT_TRUE(transport.start(false));
+
+    // Request 3 expires while waiting for the single worker, 2 is bounded by the server's limit,
+    // 5 starts in time but finishes after its deadline
+    json init = request::create_with_id(1, "initialize", {{"protocolVersion", MCP_VERSION}}).to_json();
+    std::string requests = init.dump() + "\n"
+        R"({"jsonrpc":"2.0","method":"notifications/initialized"})" "\n"
+        R"({"jsonrpc":"2.0","id":2,"method":"tools/call","params":{"name":"work","_meta":{"timeoutMs":60000}}})" "\n"
+        R"({"jsonrpc":"2.0","id":3,"method":"tools/call","params":{"name":"work","_meta":{"timeoutMs":50}}})" "\n"
+        R"({"jsonrpc":"2.0","id":4,"method":"tools/list"})" "\n"
+        R"({"jsonrpc":"2.0","id":5,"method":"tools/call","params":{"name":"slow","_meta":{"timeoutMs":500}}})" "\n";
+    ASSERT_EQ(write(input[1], requests.data(), requests.size()), static_cast<ssize_t>(requests.size()));
+
+    line_buffer buffer;
+    std::string_view line;
+    auto read_message = [&]() {
+        while (!buffer.next_line(line)) {
+            auto [space, capacity] = buffer.prepare();
+            ssize_t n = read(output[0], space, capacity);
+            if (n <= 0) {
+                return json();
+            }
+            buffer.commit(n);
+        }
+        return json::parse(line.data(), line.data() + line.size());
+    };
+
+    EXPECT_EQ(read_message()["id"], 1);
+    EXPECT_EQ(read_message()["id"], 2);
+    json expired = read_message();
+    EXPECT_EQ(expired["id"], 3);
+    EXPECT_EQ(expired["error"]["code"], static_cast<int>(error_code::request_timeout));
+    EXPECT_EQ(read_message()["id"], 4);
+    json late = read_message();
+    EXPECT_EQ(late["id"], 5);
+    EXPECT_EQ(late["result"]["content"][0]["text"], "done");
+    ASSERT_EQ(budgets.size(), 1u);
+    EXPECT_GT(budgets[0], 9000);
+    EXPECT_LE(budgets[0], 10000);
+
+    // Invalid timeouts are rejected at once
+    requests = R"({"jsonrpc":"2.0","id":6,"method":"tools/call","params":{"name":"work","_meta":{"timeoutMs":0}}})" "\n"
+        R"({"jsonrpc":"2.0","id":7,"method":"tools/call","params":{"name":"work","_meta":{"timeoutMs":-1}}})" "\n";
+    ASSERT_EQ(write(input[1], requests.data(), requests.size()), static_cast<ssize_t>(requests.size()));
+    for (int id : {6, 7}) {
+        json invalid = read_message();
+        EXPECT_EQ(invalid["id"], id);
+        EXPECT_EQ(invalid["error"]["code"], static_cast<int>(error_code::invalid_params));
+    }
+    EXPECT_EQ(budgets.size(), 1u);
+
+    server::load_statistics stats = srv->get_load_stats();
+    EXPECT_EQ(stats.timed_out, 1u);
+    EXPECT_EQ(stats.dropped, 0u);
+
+    close(input[1]);
+    transport.stop();
+    close(input[0]);
+    close(output[0]);
+    close(output[1]);
+}
+
+// Test that a session over its limit of requests in flight gets an error at once
+TEST(StdioServerTest, RejectsRequestsBeyondSessionLimit) {
+    int input[2];
+    int output[2];
+    ASSERT_EQ(pipe(input), 0);
+    ASSERT_EQ(pipe(output), 0);
+
+    server::configuration conf;
+    conf.threadpool_size = 1;
+    conf.max_session_requests = 2;
+    conf.retry_after = std::chrono::seconds(3);
+    auto srv = std::make_shared<server>(conf);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<bool> started{false};
+    srv->register_tool(tool_builder("work").build(), [&](const json&, const std::string&) -> json {
+        started = true;
+        released.wait();
+        return json::array();
+    });
+
+    stdio_server transport(srv, {input[0], output[1]});
+    ASSERT_TRUE(transport.start(false));
+
+    line_buffer buffer;
+    std::string_view line;
+    auto read_message = [&]() {
+        while (!buffer.next_line(line)) {
+            auto [space, capacity] = buffer.prepare();
+            ssize_t n = read(output[0], space, capacity);
+            if (n <= 0) {
+                return json();
+            }
+            buffer.commit(n);
+        }
+        return json::parse(line.data(), line.data() + line.size());
+    };
+
+    json init = request::create_with_id(1, "initialize", {{"protocolVersion", MCP_VERSION}}).to_json();
+    std::string requests = init.dump() + "\n"
+        R"({"jsonrpc":"2.0","method":"notifications/initialized"})" "\n"
+        R"({"jsonrpc":"2.0","id":2,"method":"tools/call","params":{"name":"work"}})" "\n";
+    ASSERT_EQ(write(input[1], requests.data(), requests.size()), static_cast<ssize_t>(requests.size()));
+    EXPECT_EQ(read_message()["id"], 1);
+    while (!started) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // Request 3 waits for the worker, 4 is one too many
+    requests = R"({"jsonrpc":"2.0","id":3,"method":"tools/call","params":{"name":"work"}})" "\n"
+        R"({"jsonrpc":"2.0","id":4,"method":"tools/call","params":{"name":"work"}})" "\n";
+    ASSERT_EQ(write(input[1], requests.data(), requests.size()), static_cast<ssize_t>(requests.size()));
+
+    json rejected = read_message();
+    EXPECT_EQ(rejected["id"], 4);
+    EXPECT_EQ(rejected["error"]["code"], static_cast<int>(error_code::server_busy));
+    EXPECT_EQ(rejected["error"]["data"]["retryAfter"], 3);
+
+    release.set_value();
+    EXPECT_EQ(read_message()["id"], 2);
+    EXPECT_EQ(read_message()["id"], 3);
+
+    server::load_statistics stats = srv->get_load_stats();
+    EXPECT_EQ(stats.rejected_session, 1u);
+    EXPECT_EQ(stats.rejected_overload, 0u);
+    EXPECT_EQ(stats.dropped, 0u);
+
+    close(input[1]);
+    transport.stop();
+    close(input[0]);
+    close(output[0]);
+    close(output[1]);
+}
+
+// Test that priority methods are answered while the request queue is full
+TEST(StdioServerTest, AnswersPingsWithFullQueue) {
+    int input[2];
+    int output[2];
+    ASSERT_EQ(pipe(input), 0);
+    ASSERT_EQ(pipe(output), 0);
+
+    server::configuration conf;
+    conf.threadpool_size = 1;
+    conf.max_queued_requests = 1;
+    auto srv = std::make_shared<server>(conf);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<bool> started{false};
+    srv->register_tool(tool_builder("work").build(), [&](const json&, const std::string&) -> json {
+        started = true;
+        released.wait();
+        return json::array();
+    });
+
+    stdio_server transport(srv, {input[0], output[1]});
+    ASSERT_TRUE(transport.start(false));
+
+    line_buffer buffer;
+    std::string_view line;
+    auto read_message = [&]() {
+        while (!buffer.next_line(line)) {
+            auto [space, capacity] = buffer.prepare();
+            ssize_t n = read(output[0], space, capacity);
+            if (n <= 0) {
+                return json();
+            }
+            buffer.commit(n);
+        }
+        return json::parse(line.data(), line.data() + line.size());
+    };
+
+    json init = request::create_with_id(1, "initialize", {{"protocolVersion", MCP_VERSION}}).to_json();
+    std::string requests = init.dump() + "\n"
+        R"({"jsonrpc":"2.0","method":"notifications/initialized"})" "\n"
+        R"({"jsonrpc":"2.0","id":2,"method":"tools/call","params":{"name":"work"}})" "\n";
+    ASSERT_EQ(write(input[1], requests.data(), requests.size()), static_cast<ssize_t>(requests.size()));
+    EXPECT_EQ(read_message()["id"], 1);
+    while (!started) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // Request 3 fills the queue and 4 is rejected, the ping still gets in
+    requests = R"({"jsonrpc":"2.0","id":3,"method":"tools/call","params":{"name":"work"}})" "\n"
+        R"({"jsonrpc":"2.0","id":4,"method":"tools/call","params":{"name":"work"}})" "\n"
+        R"({"jsonrpc":"2.0","id":5,"method":"ping"})" "\n";
+    ASSERT_EQ(write(input[1], requests.data(), requests.size()), static_cast<ssize_t>(requests.size()));
+
+    json rejected = read_message();
+    EXPECT_EQ(rejected["id"], 4);
+    EXPECT_EQ(rejected["error"]["code"], static_cast<int>(error_code::server_busy));
+
+    // The ping runs ahead of the queued call once the reader queued it
+    for (int i = 0; i < 1000 && srv->get_load_stats().queued < 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(srv->get_load_stats().queued, 2u);
+    release.set_value();
+    EXPECT_EQ(read_message()["id"], 2);
+    json pong = read_message();
+    EXPECT_EQ(pong["id"], 5);
+    EXPECT_FALSE(pong.contains("error"));
+    EXPECT_EQ(read_message()["id"], 3);
+
+    server::load_statistics stats = srv->get_load_stats();
+    EXPECT_EQ(stats.rejected_overload, 1u);
+    EXPECT_EQ(stats.rejected_session, 0u);
+
+    close(input[1]);
+    transport.stop();
+    close(input[0]);
+    close(output[0]);
+    close(output[1]);
+}
+
+// Test calls over a Unix domain socket, concurrent clients and connection cleanup
+TEST(UnixSocketTest, ServesClientsOnSocket) {
+    auto srv = std::make_shared<server>(server::configuration{});
+    srv->register_tool(tool_builder("echo").with_string_param("text", "Text").build(), [](const json& args, const std::string&) -> json {
+        return json::array({{{"type", "text"}, {"text", args["text"]}}});
+    });
+
+    std::string path = "/tmp/mcp_test_" + std::to_string(getpid()) + ".sock";
+    unix_server socket_server(srv, {path});
+    ASSERT_TRUE(socket_server.start(false));
+
+    {
+        unix_client first(path);
+        unix_client second(path);
+        ASSERT_TRUE(first.initialize("first", "1.0.0"));
+        ASSERT_TRUE(second.initialize("second", "1.0.0"));
+        EXPECT_EQ(socket_server.connection_count(), 2u);
+
+        ASSERT_EQ(first.get_tools().size(), 1u);
+        EXPECT_THROW(first.call_tool("missing"), mcp_exception);
+
+        std::vector<std::thread> callers;
+        std::atomic<int> matched{0};
+        for (int i = 0; i < 8; ++i) {
+            callers.emplace_back([&, i]() {
+                unix_client& c = i % 2 ? first : second;
+                for (int j = 0; j < 50; ++j) {
+                    std::string text = std::to_string(i) + ":" + std::to_string(j);
+                    if (c.call_tool("echo", {{"text", text}})["content"][0]["text"] == text) {
+                        ++matched;
+                    }
+                }
+            });
+        }
+        for (auto& caller : callers) {
+            caller.join();
+        }
+        EXPECT_EQ(matched, 400);
+    }
+
+    // Connections of disconnected clients are released
+    for (int i = 0; i < 50 && socket_server.connection_count() > 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    EXPECT_EQ(socket_server.connection_count(), 0u);
+
+    socket_server.stop();
+    EXPECT_FALSE(socket_server.is_running());
+
+    unix_client late(path);
+    EXPECT_FALSE(late.initialize("late", "1.0.0"));
+}
+
+// Test that clients cancel a single waiting request and the server stops working on it
+TEST(UnixSocketTest, CancelsSingleRequest) {
+    auto srv = std::make_shared<server>(server::configuration{});
+    std::atomic<int> started{0};
+    std::atomic<int> stopped{0};
+    srv->register_tool(tool_builder("wait").build(), [&](const json&, const std::string&) -> json {
+        ++started;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (cancellation_token::current().is_cancelled()) {
+                ++stopped;
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return json::array();
+    });
+
+    // The waiting call fails at once, other requests of the client are not affected
+    auto cancel_call = [&](client& c) {
+        request req = request::create("tools/call", {{"name", "wait"}});
+        int before = started;
+        std::thread caller([&]() {
+            EXPECT_THROW(c.send_prepared_request(req), mcp_exception);
+        });
+        for (int i = 0; i < 500 && started == before; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        auto cancelled_at = std::chrono::steady_clock::now();
+        EXPECT_TRUE(c.cancel_request(req.id, "test"));
+        caller.join();
+        EXPECT_LT(std::chrono::steady_clock::now() - cancelled_at, std::chrono::seconds(2));
+        EXPECT_FALSE(c.cancel_request(req.id));
+        EXPECT_TRUE(c.ping());
+    };
+
+    inprocess_client local(srv);
+    ASSERT_TRUE(local.initialize("local", "1.0.0"));
+    cancel_call(local);
+
+    std::string path = "/tmp/mcp_cancel_test_" + std::to_string(getpid()) + ".sock";
+    unix_server socket_server(srv, {path});
+    ASSERT_TRUE(socket_server.start(false));
+    {
+        unix_client remote(path);
+        ASSERT_TRUE(remote.initialize("remote", "1.0.0"));
+        cancel_call(remote);
+        for (int i = 0; i < 500 && stopped < 2; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    EXPECT_EQ(started, 2);
+    EXPECT_EQ(stopped, 2);
+    socket_server.stop();
+}
+
+// Test that only stale socket files are replaced when binding
+TEST(UnixSocketTest, ReplacesOnlyStaleSocketFiles) {
+    auto srv = std::make_shared<server>(server::configuration{});
+    std::string path = "/tmp/mcp_test_bind_" + std::to_string(getpid()) + ".sock";
+
+    // A regular file is left alone
+    {
+        std::ofstream file(path);
+        file << "keep";
+    }
+    {
+        unix_server socket_server(srv, {path});
+        EXPECT_FALSE(socket_server.start(false));
+    }
+    std::string content;
+    std::getline(std::ifstream(path), content);
+    EXPECT_EQ(content, "keep");
+    std::remove(path.c_str());
+
+    // A socket nobody listens on any more is replaced
+    int stale = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    ASSERT_EQ(bind(stale, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+    close(stale);
+
+    unix_server first(srv, {path});
+    ASSERT_TRUE(first.start(false));
+
+    // The socket of a running server is not taken over
+    {
+        unix_server second(srv, {path});
+        EXPECT_FALSE(second.start(false));
+    }
+    unix_client client(path);
+    EXPECT_TRUE(client.initialize("client", "1.0.0"));
+
+    first.stop();
+}
+
+#if defined(MCP_STDIO_SERVER_EXAMPLE)
+// Test that responses complete calls as soon as they arrive
+TEST(StdioClientTest, CompletesCallsWithoutPolling) {
+    stdio_client client(MCP_STDIO_SERVER_EXAMPLE);
+    ASSERT_TRUE(client.initialize("test", "1.0.0"));
+
+    // A reader sleeping between polls would add its interval to every call
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 50; ++i) {
+        std::string text = "call " + std::to_string(i);
+        EXPECT_EQ(client.call_tool("echo", {{"text", text}})["content"][0]["text"], text);
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(250));
+}
+
+// Test that pending calls fail as soon as the server process exits
+TEST(StdioClientTest, FailsPendingCallsWhenServerExits) {
+    // The server is killed after a second, while the call below waits for a 10 s tool
+    stdio_client client("sh -c 'exec 3<&0; " MCP_STDIO_SERVER_EXAMPLE " <&3 & sleep 1; kill $!; wait'");
+    client.set_timeout(30);
+    ASSERT_TRUE(client.initialize("test", "1.0.0"));
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_THROW(client.call_tool("sleep", {{"ms", 10000}}), mcp_exception);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    EXPECT_FALSE(client.is_running());
+}
+
+// Test clients sharing the threads of one reactor: concurrent calls, server exit and stop with a call pending
+TEST(StdioClientTest, SharesReactorBetweenClients) {
+    auto reactor = std::make_shared<io_reactor>(2);
+    std::vector<std::unique_ptr<stdio_client>> clients;
+    for (int i = 0; i < 4; ++i) {
+        clients.push_back(std::make_unique<stdio_client>(MCP_STDIO_SERVER_EXAMPLE));
+        clients.back()->set_io_reactor(reactor);
+        ASSERT_TRUE(clients.back()->initialize("test", "1.0.0"));
+    }
+
+    // The server of this client is killed after a second
+    stdio_client exiting("sh -c 'exec 3<&0; " MCP_STDIO_SERVER_EXAMPLE " <&3 & sleep 1; kill $!; wait'");
+    exiting.set_io_reactor(reactor);
+    exiting.set_timeout(30);
+    ASSERT_TRUE(exiting.initialize("test", "1.0.0"));
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread exited([&]() {
+        EXPECT_THROW(exiting.call_tool("sleep", {{"ms", 10000}}), mcp_exception);
+    });
+    std::thread stopped([&]() {
+        EXPECT_THROW(clients[3]->call_tool("sleep", {{"ms", 10000}}), mcp_exception);
+    });
+
+    // Calls of the other clients go on meanwhile
+    std::atomic<int> matched{0};
+    std::vector<std::thread> threads;
+    for (size_t c = 0; c < 3; ++c) {
+        for (int t = 0; t < 3; ++t) {
+            threads.emplace_back([&, c, t]() {
+                for (int i = 0; i < 20; ++i) {
+                    std::string text = std::to_string(c) + "/" + std::to_string(t) + "/" + std::to_string(i);
+                    if (clients[c]->call_tool("echo", {{"text", text}})["content"][0]["text"] == text) {
+                        ++matched;
+                    }
+                }
+            });
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(matched, 180);
+
+    // Stopping a client fails its pending call
+    clients[3]->stop();
+    stopped.join();
+    EXPECT_FALSE(clients[3]->is_running());
+
+    // The exit of a server fails the pending call of its client only
+    exited.join();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    EXPECT_FALSE(exiting.is_running());
+    for (size_t c = 0; c < 3; ++c) {
+        EXPECT_TRUE(clients[c]->ping());
+    }
+}
+
+// Test warm-up, leases and the retirement of clients that cannot be reused
+TEST(StdioClientPoolTest, LeasesAndRetiresClients) {
+    stdio_client_pool::configuration conf;
+    conf.size = 1;
+    conf.max_idle = 1;
+    conf.max_uses = 2;
+    conf.health_check_interval = std::chrono::milliseconds(0);
+    stdio_client_pool pool(MCP_STDIO_SERVER_EXAMPLE, conf);
+    ASSERT_TRUE(pool.wait_ready(std::chrono::seconds(10)));
+    EXPECT_EQ(pool.idle_count(), 1u);
+
+    {
+        auto lease = pool.acquire();
+        EXPECT_EQ(lease.uses(), 1u);
+        EXPECT_EQ(pool.leased_count(), 1u);
+        EXPECT_EQ(pool.idle_count(), 0u);
+        EXPECT_EQ(lease->call_tool("echo", {{"text", "pooled"}})["content"][0]["text"], "pooled");
+    }
+    EXPECT_EQ(pool.leased_count(), 0u);
+    EXPECT_EQ(pool.idle_count(), 1u);
+
+    // The second lease is the last one of the process, the next one gets a fresh process
+    auto lease = pool.acquire();
+    EXPECT_EQ(lease.uses(), 2u);
+    lease.release();
+    EXPECT_FALSE(lease);
+    ASSERT_TRUE(pool.wait_ready(std::chrono::seconds(10)));
+    lease = pool.acquire();
+    EXPECT_EQ(lease.uses(), 1u);
+
+    // An invalidated lease is replaced as well
+    lease.invalidate();
+    lease.release();
+    ASSERT_TRUE(pool.wait_ready(std::chrono::seconds(10)));
+    lease = pool.acquire();
+    EXPECT_EQ(lease.uses(), 1u);
+    EXPECT_TRUE(lease->ping());
+}
+
+// Test that leases may outlive their pool
+TEST(StdioClientPoolTest, LeaseOutlivesPool) {
+    stdio_client_pool::configuration conf;
+    conf.size = 1;
+    conf.health_check_interval = std::chrono::milliseconds(0);
+    auto pool = std::make_unique<stdio_client_pool>(MCP_STDIO_SERVER_EXAMPLE, conf);
+    auto lease = pool->acquire();
+    auto moved = std::move(lease);
+    pool.reset();
+
+    // The client stays usable until the lease stops it
+    EXPECT_TRUE(moved->ping());
+    moved.release();
+    EXPECT_FALSE(moved);
+}
+
+// Test that acquire() gives up when no process becomes ready
+TEST(StdioClientPoolTest, TimesOutWithoutReadyProcess) {
+    stdio_client_pool::configuration conf;
+    conf.size = 1;
+    conf.acquire_timeout = std::chrono::milliseconds(200);
+    stdio_client_pool pool("false", conf);
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_THROW(pool.acquire(), mcp_exception);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(200));
+    EXPECT_FALSE(pool.wait_ready(std::chrono::milliseconds(100)));
+    EXPECT_EQ(pool.leased_count(), 0u);
+}
+
+// Test that health checks keep healthy processes and replace ones that stopped answering
+TEST(StdioClientPoolTest, ReplacesClientsFailingHealthCheck) {
+    std::string marker = "/tmp/mcp_test_pool_" + std::to_string(getpid());
+    auto spawned = [&marker](const std::string& suffix) {
+        std::ifstream file(marker + suffix);
+        std::string line;
+        size_t count = 0;
+        while (std::getline(file, line)) {
+            ++count;
+        }
+        return count;
+    };
+
+    stdio_client_pool::configuration conf;
+    conf.size = 1;
+    conf.health_check_interval = std::chrono::milliseconds(50);
+    conf.health_check_timeout = std::chrono::milliseconds(200);
+
+    {
+        // Every start of a process appends a line to the marker file
+        std::string command = "sh -c 'echo started >> " + marker + ".healthy; exec " MCP_STDIO_SERVER_EXAMPLE "'";
+        stdio_client_pool pool(command, conf);
+        ASSERT_TRUE(pool.wait_ready(std::chrono::seconds(10)));
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        EXPECT_EQ(spawned(".healthy"), 1u);
+        EXPECT_TRUE(pool.acquire()->ping());
+    }
+
+    {
+        // The server only gets the initialize handshake, then stops answering while its output stays open
+        std::string command = "sh -c 'echo started >> " + marker + ".hanging; "
+            "for i in 1 2; do read -r line && printf \"%s\\n\" \"$line\"; done | " MCP_STDIO_SERVER_EXAMPLE "; exec sleep 30'";
+        stdio_client_pool pool(command, conf);
+        ASSERT_TRUE(pool.wait_ready(std::chrono::seconds(10)));
+        for (int i = 0; i < 100 && spawned(".hanging") < 2; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        EXPECT_GE(spawned(".hanging"), 2u);
+    }
+
+    std::remove((marker + ".healthy").c_str());
+    std::remove((marker + ".hanging").c_str());
+}
+#endif
+#endif
+
 class LifecycleEnvironment : public ::testing::Environment {
 public:
     void SetUp() override {
         // Set up test environment
-        server_ = std::make_unique<server>("localhost", 8080);
+        server::configuration conf;
+        conf.port = 8080;
+        server_ = std::make_unique<server>(conf);
         server_->set_server_info("TestServer", "1.0.0");
         
         // Set server capabilities
@@ -117,7 +2033,7 @@ public:
             {"roots", {{"listChanged", true}}},
             {"sampling", json::object()}
         };
-        client_ = std::make_unique<sse_client>("localhost", 8080);
+        client_ = std::make_unique<sse_client>("http://localhost:8080");
         client_->set_capabilities(client_capabilities);
     }
 
@@ -178,7 +2094,9 @@ class VersioningEnvironment : public ::testing::Environment {
 public:
     void SetUp() override {
         // Set up test environment
-        server_ = std::make_unique<server>("localhost", 8081);
+        server::configuration conf;
+        conf.port = 8081;
+        server_ = std::make_unique<server>(conf);
         server_->set_server_info("TestServer", "1.0.0");
         
         // Set server capabilities
@@ -193,7 +2111,7 @@ public:
         // Start server (non-blocking mode)
         server_->start(false);
 
-        client_ = std::make_unique<sse_client>("localhost", 8081);
+        client_ = std::make_unique<sse_client>("http://localhost:8081");
     }
 
     void TearDown() override {
@@ -347,7 +2265,9 @@ class PingEnvironment : public ::testing::Environment {
 public:
     void SetUp() override {
         // Set up test environment
-        server_ = std::make_unique<server>("localhost", 8082);
+        server::configuration conf;
+        conf.port = 8082;
+        server_ = std::make_unique<server>(conf);
         
         // Start server (non-blocking mode)
         server_->start(false);
@@ -357,7 +2277,7 @@ public:
             {"roots", {{"listChanged", true}}},
             {"sampling", json::object()}
         };
-        client_ = std::make_unique<sse_client>("localhost", 8082);
+        client_ = std::make_unique<sse_client>("http://localhost:8082");
         client_->set_capabilities(client_capabilities);
     }
 
@@ -509,7 +2429,9 @@ class ToolsEnvironment : public ::testing::Environment {
 public:
     void SetUp() override {
         // Set up test environment
-        server_ = std::make_unique<server>("localhost", 8083);
+        server::configuration conf;
+        conf.port = 8083;
+        server_ = std::make_unique<server>(conf);
         
         // Create a test tool
         tool test_tool;
@@ -542,7 +2464,7 @@ public:
         });
         
         // Register tools list method
-        server_->register_method("tools/list", [](const json& params, const std::string& /* session_id */) -> json {
+        server_->register_method("tools/list", [](const json& /* params */, const std::string& /* session_id */) -> json {
             return {
                 {"tools", json::array({
                     {
@@ -590,7 +2512,7 @@ public:
             {"roots", {{"listChanged", true}}},
             {"sampling", json::object()}
         };
-        client_ = std::make_unique<sse_client>("localhost", 8083);
+        client_ = std::make_unique<sse_client>("http://localhost:8083");
         client_->set_capabilities(client_capabilities);
         client_->initialize("TestClient", "1.0.0");
     }